@@ -0,0 +1,469 @@
+#include "command_validator.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <lldb/API/SBCommandInterpreter.h>
+#include <lldb/API/SBCommandReturnObject.h>
+#include <lldb/API/SBStringList.h>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+// gdb commands the model tends to reach for, mapped to their LLDB equivalents.
+// Matched on whole leading words; remaining words are carried over.
+struct GdbIsm
+{
+    const char* gdb;
+    const char* lldb;
+};
+
+constexpr GdbIsm kGdbIsms[] = {
+    {"info all-registers", "register read --all"},
+    {"info registers", "register read"},
+    {"info locals", "frame variable --no-args"},
+    {"info args", "frame variable --no-locals"},
+    {"info frame", "frame info"},
+    {"info threads", "thread list"},
+    {"info breakpoints", "breakpoint list"},
+    {"info break", "breakpoint list"},
+    {"info watchpoints", "watchpoint list"},
+    {"info sharedlibrary", "image list"},
+    {"info shared", "image list"},
+    {"info symbol", "image lookup -a"},
+    {"info functions", "image lookup -r -n"},
+    {"info proc mappings", "memory region --all"},
+    {"info signals", "process handle"},
+    {"info inferiors", "process status"},
+    {"info", "help"},
+    {"thread apply all bt", "bt all"},
+    {"thread apply all backtrace", "bt all"},
+    {"bt full", "bt"},
+    {"backtrace full", "bt"},
+    {"set var", "expression"},
+    {"set variable", "expression"},
+};
+
+// Commands whose arguments are free-form (expressions, scripts, setting
+// paths); only the command word itself is validated.
+constexpr const char* kRawCommands[] = {
+    "expression", "dwim-print", "script", "command", "settings", "platform", "type",
+};
+
+// Commands that only read state, as leading words of the expanded command.
+// Expressions are not among them: they can run code in the process.
+constexpr const char* kReadOnlyCommands[] = {
+    "thread backtrace", "_regexp-bt", "thread list", "thread info", "frame variable",
+    "frame info", "register read", "memory read", "memory region", "image lookup", "image list",
+    "target modules lookup", "target modules list", "disassemble", "source list",
+    "_regexp-list", "source info", "breakpoint list", "watchpoint list", "process status",
+    "target list", "help",
+};
+
+constexpr const char* kCommandNameChars =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_";
+
+std::vector<std::string> Tokenize(const std::string& line)
+{
+    std::vector<std::string> tokens;
+    std::string current;
+    char quote = 0;
+    bool in_token = false;
+    for (char c : line)
+    {
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+            else
+                current += c;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote = c;
+            in_token = true;
+        }
+        else if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            if (in_token)
+            {
+                tokens.push_back(current);
+                current.clear();
+                in_token = false;
+            }
+        }
+        else
+        {
+            current += c;
+            in_token = true;
+        }
+    }
+    if (in_token)
+        tokens.push_back(current);
+    return tokens;
+}
+
+std::string Join(const std::vector<std::string>& tokens, size_t begin = 0)
+{
+    std::string result;
+    for (size_t i = begin; i < tokens.size(); i++)
+    {
+        if (!result.empty())
+            result += " ";
+        if (tokens[i].find_first_of(" \t") != std::string::npos)
+            result += "\"" + tokens[i] + "\"";
+        else
+            result += tokens[i];
+    }
+    return result;
+}
+
+size_t EditDistance(const std::string& a, const std::string& b)
+{
+    std::vector<size_t> prev(b.size() + 1), cur(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); j++)
+        prev[j] = j;
+    for (size_t i = 1; i <= a.size(); i++)
+    {
+        cur[0] = i;
+        for (size_t j = 1; j <= b.size(); j++)
+        {
+            size_t cost = std::tolower(static_cast<unsigned char>(a[i - 1])) ==
+                                  std::tolower(static_cast<unsigned char>(b[j - 1]))
+                              ? 0
+                              : 1;
+            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+        }
+        std::swap(prev, cur);
+    }
+    return prev[b.size()];
+}
+
+bool IsCommandWord(const std::string& s)
+{
+    if (s.empty() || !std::islower(static_cast<unsigned char>(s[0])))
+        return false;
+    return std::all_of(s.begin(), s.end(), [](unsigned char c)
+                       { return std::islower(c) || std::isdigit(c) || c == '-'; });
+}
+
+bool IsNumber(const std::string& s)
+{
+    return !s.empty() &&
+           std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+bool IsRawCommand(const std::string& name)
+{
+    return std::any_of(std::begin(kRawCommands), std::end(kRawCommands),
+                       [&](const char* raw) { return name == raw; });
+}
+
+// Resolve a word against candidates the way LLDB does: exact match, else a
+// unique prefix. Returns the candidate, or empty with *ambiguous set.
+std::string ResolvePrefix(const std::string& word, const std::vector<std::string>& candidates,
+                          std::vector<std::string>* ambiguous)
+{
+    std::vector<std::string> prefixed;
+    for (const auto& c : candidates)
+    {
+        if (c == word)
+            return c;
+        if (c.compare(0, word.size(), word) == 0)
+            prefixed.push_back(c);
+    }
+    if (prefixed.size() == 1)
+        return prefixed[0];
+    if (ambiguous)
+        *ambiguous = prefixed;
+    return "";
+}
+} // namespace
+
+std::string ValidationResult::Format() const
+{
+    std::string text = "Error: " + error;
+    if (!suggestions.empty())
+    {
+        text += "\nDid you mean:";
+        for (const auto& s : suggestions)
+            text += "\n  " + s;
+    }
+    return text;
+}
+
+std::vector<std::string> ClosestMatches(const std::string& word,
+                                        const std::vector<std::string>& candidates,
+                                        size_t max_results)
+{
+    size_t threshold = std::max<size_t>(2, word.size() / 3);
+    std::vector<std::pair<size_t, std::string>> scored;
+    for (const auto& c : candidates)
+    {
+        size_t d = EditDistance(word, c);
+        bool prefix = !word.empty() && (c.compare(0, word.size(), word) == 0 ||
+                                        word.compare(0, c.size(), c) == 0);
+        if (d <= threshold || prefix)
+            scored.emplace_back(prefix ? std::min<size_t>(d, 1) : d, c);
+    }
+    std::stable_sort(scored.begin(), scored.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<std::string> result;
+    for (const auto& [d, c] : scored)
+    {
+        if (result.size() >= max_results)
+            break;
+        if (std::find(result.begin(), result.end(), c) == result.end())
+            result.push_back(c);
+    }
+    return result;
+}
+
+CommandValidator::CommandValidator(lldb::SBCommandInterpreter interp) : interp_(interp) {}
+
+std::vector<std::string> CommandValidator::Complete(const std::string& line)
+{
+    lldb::SBStringList matches;
+    int count = interp_.HandleCompletion(line.c_str(), static_cast<uint32_t>(line.size()), 0, -1,
+                                         matches);
+    std::vector<std::string> result;
+    for (int i = 1; i <= count && i < static_cast<int>(matches.GetSize()); i++)
+    {
+        std::string m = matches.GetStringAtIndex(i);
+        while (!m.empty() && m.back() == ' ')
+            m.pop_back();
+        result.push_back(m);
+    }
+    return result;
+}
+
+std::vector<std::string> CommandValidator::Subcommands(const std::string& path)
+{
+    std::string line = path + " ";
+    lldb::SBStringList matches, descriptions;
+    int count = interp_.HandleCompletionWithDescriptions(
+        line.c_str(), static_cast<uint32_t>(line.size()), 0, -1, matches, descriptions);
+
+    // Subcommand completions are plain command words that carry help text;
+    // argument completions (files, variables, symbols) do not.
+    std::vector<std::string> result;
+    for (int i = 1; i <= count && i < static_cast<int>(matches.GetSize()); i++)
+    {
+        std::string m = matches.GetStringAtIndex(i);
+        while (!m.empty() && m.back() == ' ')
+            m.pop_back();
+        const char* desc = descriptions.GetStringAtIndex(i);
+        if (!IsCommandWord(m) || !desc || !*desc)
+            return {};
+        result.push_back(m);
+    }
+    return result;
+}
+
+bool CommandValidator::IsReadOnly(const std::string& command)
+{
+    lldb::SBCommandReturnObject resolved;
+    interp_.ResolveCommand(command.c_str(), resolved);
+    std::vector<std::string> tokens =
+        Tokenize(resolved.Succeeded() && resolved.GetOutput() ? resolved.GetOutput() : command);
+    return std::any_of(std::begin(kReadOnlyCommands), std::end(kReadOnlyCommands),
+                       [&](const char* read_only)
+                       {
+                           std::vector<std::string> words = Tokenize(read_only);
+                           return words.size() <= tokens.size() &&
+                                  std::equal(words.begin(), words.end(), tokens.begin());
+                       });
+}
+
+bool CommandValidator::IsKnownCommand(const std::string& name)
+{
+    return interp_.CommandExists(name.c_str()) || interp_.AliasExists(name.c_str()) ||
+           interp_.UserCommandExists(name.c_str());
+}
+
+ValidationResult CommandValidator::Validate(const std::string& command)
+{
+    ValidationResult result;
+    std::vector<std::string> tokens = Tokenize(command);
+    if (tokens.empty())
+    {
+        result.ok = false;
+        result.error = "empty command";
+        return result;
+    }
+
+    // gdb-isms: known translation, checked before LLDB's own prefix matching
+    // (e.g. "set var" would otherwise abbreviate to "settings").
+    for (const auto& ism : kGdbIsms)
+    {
+        std::vector<std::string> gdb_words = Tokenize(ism.gdb);
+        if (gdb_words.size() > tokens.size())
+            continue;
+        if (!std::equal(gdb_words.begin(), gdb_words.end(), tokens.begin()))
+            continue;
+        if (gdb_words.size() == 1 && IsKnownCommand(gdb_words[0]))
+            continue;
+
+        std::string rest = Join(tokens, gdb_words.size());
+        result.ok = false;
+        result.error = "'" + std::string(ism.gdb) + "' is gdb syntax, not an LLDB command";
+        result.suggestions.push_back(std::string(ism.lldb) + (rest.empty() ? "" : " " + rest));
+        return result;
+    }
+
+    // Command word: LLDB splits it at the first character that cannot appear
+    // in a command name, so "p/x" and "x/16xb" resolve to "p" and "x".
+    const std::string& first = tokens[0];
+    size_t name_end = first.find_first_not_of(kCommandNameChars);
+    if (name_end == 0)
+        return result; // Not a plain command word; leave it to LLDB
+    std::string root = first.substr(0, name_end);
+    std::string suffix = name_end == std::string::npos ? "" : first.substr(name_end);
+
+    // Exact command/alias, else a unique prefix (LLDB abbreviation)
+    bool is_alias = false;
+    if (IsKnownCommand(root))
+    {
+        is_alias = !interp_.CommandExists(root.c_str());
+    }
+    else
+    {
+        std::vector<std::string> ambiguous;
+        std::string resolved = ResolvePrefix(root, Complete(root), &ambiguous);
+        if (resolved.empty())
+        {
+            result.ok = false;
+            if (!ambiguous.empty())
+            {
+                result.error = "ambiguous command '" + root + "'";
+                for (size_t i = 0; i < ambiguous.size() && i < 5; i++)
+                {
+                    tokens[0] = ambiguous[i] + suffix;
+                    result.suggestions.push_back(Join(tokens));
+                }
+            }
+            else
+            {
+                result.error = "unknown command '" + root + "'";
+                for (const auto& match : ClosestMatches(root, Complete("")))
+                {
+                    tokens[0] = match + suffix;
+                    result.suggestions.push_back(Join(tokens));
+                }
+            }
+            return result;
+        }
+        root = resolved;
+        is_alias = !interp_.CommandExists(root.c_str());
+    }
+
+    // Aliases and raw commands expand or take free-form input; LLDB reports
+    // their argument errors precisely enough on its own.
+    if (is_alias || IsRawCommand(root))
+        return result;
+
+    // Walk multiword commands down to the leaf
+    std::string path = root;
+    size_t idx = 1;
+    while (idx < tokens.size() && !tokens[idx].empty() && tokens[idx][0] != '-')
+    {
+        std::vector<std::string> subs = Subcommands(path);
+        if (subs.empty())
+            break;
+
+        const std::string& word = tokens[idx];
+        std::vector<std::string> ambiguous;
+        std::string resolved = ResolvePrefix(word, subs, &ambiguous);
+        if (resolved.empty())
+        {
+            result.ok = false;
+            std::vector<std::string> fixed = tokens;
+            if (!ambiguous.empty())
+            {
+                result.error = "ambiguous subcommand '" + word + "' of '" + path + "'";
+            }
+            else
+            {
+                result.error = "'" + word + "' is not a subcommand of '" + path +
+                               "'. Valid: " + Join(subs);
+                // gdb-style "frame 3" / "thread 2"
+                if (IsNumber(word) && std::find(subs.begin(), subs.end(), "select") != subs.end())
+                {
+                    fixed.insert(fixed.begin() + idx, "select");
+                    result.suggestions.push_back(Join(fixed));
+                    return result;
+                }
+                ambiguous = ClosestMatches(word, subs);
+            }
+            for (const auto& match : ambiguous)
+            {
+                fixed[idx] = match;
+                result.suggestions.push_back(Join(fixed));
+            }
+            return result;
+        }
+        path += " " + resolved;
+        idx++;
+    }
+
+    // Options of the leaf command. Completing "<path> --" lists every long
+    // option; a recognised short option completes to itself.
+    std::vector<std::string> long_options;
+    bool options_loaded = false;
+    for (size_t i = idx; i < tokens.size(); i++)
+    {
+        const std::string& tok = tokens[i];
+        if (tok == "--")
+            break;
+        if (tok.size() < 2 || tok[0] != '-')
+            continue;
+
+        bool is_long = tok.size() > 2 && tok[1] == '-';
+        bool is_short = tok.size() == 2 && std::isalpha(static_cast<unsigned char>(tok[1]));
+        if (!is_long && !is_short)
+            continue;
+
+        if (!options_loaded)
+        {
+            long_options = Complete(path + " --");
+            options_loaded = true;
+        }
+        if (long_options.empty())
+            break; // Command takes no options, or completion is unavailable
+
+        if (is_long)
+        {
+            std::string name = tok.substr(0, tok.find('='));
+            std::vector<std::string> ambiguous;
+            if (!ResolvePrefix(name, long_options, &ambiguous).empty())
+                continue;
+            result.ok = false;
+            result.error = ambiguous.empty()
+                               ? "unknown option '" + name + "' for '" + path + "'"
+                               : "ambiguous option '" + name + "' for '" + path + "'";
+            if (ambiguous.empty())
+                ambiguous = ClosestMatches(name, long_options);
+            std::vector<std::string> fixed = tokens;
+            for (const auto& match : ambiguous)
+            {
+                fixed[i] = match + tok.substr(name.size());
+                result.suggestions.push_back(Join(fixed));
+            }
+            return result;
+        }
+
+        if (Complete(path + " " + tok).empty())
+        {
+            result.ok = false;
+            result.error = "unknown option '" + tok + "' for '" + path +
+                           "'. Valid options: " + Join(long_options);
+            return result;
+        }
+    }
+
+    return result;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <lldb/API/LLDB.h>
+#include <string>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Outcome of validating a command line before it is handed to HandleCommand
+struct ValidationResult
+{
+    bool ok = true;
+    std::string error;                    // Precise reason the command was rejected
+    std::vector<std::string> suggestions; // Closest valid forms, best first
+
+    // Render error + suggestions as a tool result for the model
+    std::string Format() const;
+};
+
+// Counters for dbg_exec validation and retries (shown by "agent stats")
+struct ValidationStats
+{
+    unsigned checked = 0;    // Commands validated
+    unsigned rejected = 0;   // Rejected locally without executing
+    unsigned overridden = 0; // Rejected command resent verbatim and executed anyway
+    unsigned recovered = 0;  // Valid command issued right after a rejection
+    unsigned failed = 0;     // Commands that passed validation but failed in LLDB
+
+    // Fraction of validated commands that needed a retry
+    double RetryRate() const { return checked ? static_cast<double>(rejected) / checked : 0.0; }
+};
+
+// Validates LLDB command lines locally using the command interpreter
+// (command/alias lookup and completion), so that typos, unknown subcommands,
+// unknown options and gdb-isms are caught without a model round-trip.
+class CommandValidator
+{
+  public:
+    explicit CommandValidator(lldb::SBCommandInterpreter interp);
+
+    ValidationResult Validate(const std::string& command);
+
+    // Whether command only reads state (backtraces, variables, registers,
+    // memory, symbols, lists) after abbreviations and aliases are expanded.
+    // Resuming, stepping, expressions and anything unknown are not.
+    bool IsReadOnly(const std::string& command);
+
+  private:
+    // Completion candidates for a partial line (first element is skipped)
+    std::vector<std::string> Complete(const std::string& line);
+
+    // Subcommand names of a multiword command path (empty for leaf commands)
+    std::vector<std::string> Subcommands(const std::string& path);
+
+    bool IsKnownCommand(const std::string& name);
+
+    lldb::SBCommandInterpreter interp_;
+};
+
+// Closest candidates to a misspelled word (edit distance + prefix matches)
+std::vector<std::string> ClosestMatches(const std::string& word,
+                                        const std::vector<std::string>& candidates,
+                                        size_t max_results = 3);
+
+} // namespace lldb_copilot
@@ -0,0 +1,427 @@
+#include "core_diff.hpp"
+#include "procfs.hpp"
+#include "progress.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr uint32_t kSignatureFrames = 16; // Frames in a stack signature
+constexpr size_t kShownFrames = 3;        // Differing top frames shown per side
+
+struct ThreadInfo
+{
+    uint32_t id = 0;
+    std::vector<std::string> frames; // Function names, innermost first
+    std::string stop;                // Stop description if it stopped for a reason
+    lldb::SBThread thread;
+};
+
+struct MemoryStats
+{
+    uint64_t regions = 0;
+    uint64_t mapped = 0;
+    uint64_t writable = 0;
+    uint64_t heap = 0;  // "[heap]" (brk heap)
+    uint64_t anon = 0;  // Unnamed writable mappings (mmap arenas, large allocations)
+    uint64_t stack = 0; // "[stack]" (main thread; other stacks count as anon)
+};
+
+// Unwind the threads of process; false if progress was cancelled first
+bool CollectThreads(lldb::SBProcess process, OperationProgress& progress,
+                    std::vector<ThreadInfo>& threads)
+{
+    for (uint32_t i = 0; i < process.GetNumThreads(); i++)
+    {
+        if (progress.Cancelled())
+            return false;
+        ThreadInfo info;
+        info.thread = process.GetThreadAtIndex(i);
+        info.id = info.thread.GetIndexID();
+        for (uint32_t f = 0; f < kSignatureFrames; f++)
+        {
+            lldb::SBFrame frame = info.thread.GetFrameAtIndex(f);
+            if (!frame.IsValid())
+                break;
+            const char* name = frame.GetFunctionName();
+            info.frames.push_back(name ? name : "??");
+        }
+        lldb::StopReason reason = info.thread.GetStopReason();
+        if (reason != lldb::eStopReasonNone && reason != lldb::eStopReasonInvalid)
+        {
+            char desc[128] = {};
+            info.thread.GetStopDescription(desc, sizeof(desc));
+            info.stop = desc;
+        }
+        threads.push_back(std::move(info));
+        progress.Increment();
+    }
+    return true;
+}
+
+// Frames shared counted from the outermost one (threads started by the same
+// entry point share their bottom frames)
+size_t CommonBottom(const std::vector<std::string>& a, const std::vector<std::string>& b)
+{
+    size_t n = 0;
+    while (n < a.size() && n < b.size() && a[a.size() - 1 - n] == b[b.size() - 1 - n])
+        n++;
+    return n;
+}
+
+// Hashes of the outermost 1, 2, ... frames (FNV-1a), to bucket threads by a
+// common stack bottom of a given depth
+std::vector<uint64_t> BottomHashes(const std::vector<std::string>& frames)
+{
+    std::vector<uint64_t> hashes;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+    {
+        for (unsigned char c : *frame)
+            h = (h ^ c) * 0x100000001b3ULL;
+        h = (h ^ 0) * 0x100000001b3ULL; // Separator
+        hashes.push_back(h);
+    }
+    return hashes;
+}
+
+std::string TopFrames(const std::vector<std::string>& frames, size_t common)
+{
+    std::string out;
+    size_t unique = frames.size() - common;
+    for (size_t i = 0; i < unique && i < kShownFrames; i++)
+        out += (i ? " <- " : "") + frames[i];
+    if (unique > kShownFrames)
+        out += " <- ...";
+    return out.empty() ? "(same)" : out;
+}
+
+MemoryStats CollectMemory(lldb::SBProcess process)
+{
+    MemoryStats stats;
+    RegionIndex index;
+    index.Load(process);
+    for (const RegionIndex::Region& region : index.regions())
+    {
+        uint64_t size = region.end - region.start;
+        const std::string& name = index.Name(region);
+        stats.regions++;
+        stats.mapped += size;
+        if (region.write)
+            stats.writable += size;
+        if (name == "[heap]")
+            stats.heap += size;
+        else if (name.rfind("[stack", 0) == 0)
+            stats.stack += size;
+        else if (name.empty() && region.write && !region.exec)
+            stats.anon += size;
+    }
+    return stats;
+}
+
+std::string Size(uint64_t bytes)
+{
+    char buf[32];
+    if (bytes >= 1024 * 1024)
+        std::snprintf(buf, sizeof(buf), "%.1fM", bytes / (1024.0 * 1024.0));
+    else
+        std::snprintf(buf, sizeof(buf), "%.1fK", bytes / 1024.0);
+    return buf;
+}
+
+std::string SizeDelta(const char* name, uint64_t a, uint64_t b)
+{
+    if (a == b)
+        return "";
+    double pct = a ? 100.0 * (static_cast<double>(b) - static_cast<double>(a)) / a : 100.0;
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "  %s: %s -> %s (%+.0f%%)\n", name, Size(a).c_str(),
+                  Size(b).c_str(), pct);
+    return buf;
+}
+
+// General purpose registers of frame 0, by name
+std::map<std::string, uint64_t> ReadRegisters(lldb::SBThread thread)
+{
+    std::map<std::string, uint64_t> regs;
+    lldb::SBValueList sets = thread.GetFrameAtIndex(0).GetRegisters();
+    if (sets.GetSize() == 0)
+        return regs;
+    lldb::SBValue gpr = sets.GetValueAtIndex(0);
+    for (uint32_t r = 0; r < gpr.GetNumChildren(); r++)
+    {
+        lldb::SBValue reg = gpr.GetChildAtIndex(r);
+        if (reg.GetName() && reg.GetByteSize() <= 8)
+            regs[reg.GetName()] = reg.GetValueAsUnsigned(0);
+    }
+    return regs;
+}
+
+std::string DescribeGlobal(lldb::SBTarget target, const std::string& name)
+{
+    lldb::SBValue value = target.FindFirstGlobalVariable(name.c_str());
+    if (!value.IsValid())
+        return "<not found>";
+    std::string text;
+    const char* v = value.GetValue();
+    const char* summary = value.GetSummary();
+    if (v)
+        text = v;
+    if (summary)
+        text += (text.empty() ? "" : " ") + std::string(summary);
+    if (text.empty() && value.MightHaveChildren())
+    {
+        text = "{";
+        uint32_t n = std::min<uint32_t>(value.GetNumChildren(), 8);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            lldb::SBValue child = value.GetChildAtIndex(i);
+            const char* cv = child.GetValue();
+            const char* cs = child.GetSummary();
+            text += (i ? ", " : "") + std::string(child.GetName() ? child.GetName() : "?") + "=" +
+                    (cv ? cv : cs ? cs : "{...}");
+        }
+        text += value.GetNumChildren() > n ? ", ...}" : "}";
+    }
+    return text.empty() ? "<unavailable>" : text;
+}
+
+// Index of the thread that stopped for a reason (crash), preferring the
+// selected one
+size_t CrashingThread(const std::vector<ThreadInfo>& threads, lldb::SBProcess process)
+{
+    uint32_t selected = process.GetSelectedThread().GetIndexID();
+    size_t found = threads.size();
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        if (threads[i].stop.empty())
+            continue;
+        if (threads[i].id == selected)
+            return i;
+        if (found == threads.size())
+            found = i;
+    }
+    return found;
+}
+} // namespace
+
+std::string DiffCores(lldb::SBDebugger& debugger, const std::string& core,
+                      const std::string& globals, size_t budget)
+{
+    lldb::SBTarget target_a = debugger.GetSelectedTarget();
+    lldb::SBProcess process_a = target_a.GetProcess();
+    if (!process_a.IsValid())
+        return "Error: no process (load the first core with 'target create -c')";
+
+    char exe[4096] = {};
+    target_a.GetExecutable().GetPath(exe, sizeof(exe));
+
+    // Secondary target for the other core; the user's selection is restored.
+    // Creating it and loading the core cannot be cut short, so an interrupt
+    // is checked before and after each step.
+    lldb::SBError error;
+    lldb::SBTarget target_b;
+    lldb::SBProcess process_b;
+    {
+        OperationProgress loading(debugger, "Loading core " + core, 2);
+        if (loading.Cancelled())
+            return "Error: interrupted before loading " + core;
+        target_b = debugger.CreateTarget(exe, nullptr, nullptr, true, error);
+        debugger.SetSelectedTarget(target_a);
+        if (!target_b.IsValid())
+            return std::string("Error: cannot create target for ") + exe + ": " +
+                   (error.GetCString() ? error.GetCString() : "unknown error");
+        if (loading.Increment(1, "symbols loaded"))
+            process_b = target_b.LoadCore(core.c_str(), error);
+        if (loading.Cancelled())
+        {
+            debugger.DeleteTarget(target_b);
+            return "Error: interrupted while loading " + core;
+        }
+        if (!process_b.IsValid())
+        {
+            debugger.DeleteTarget(target_b);
+            return "Error: cannot load core " + core + ": " +
+                   (error.GetCString() ? error.GetCString() : "unknown error");
+        }
+        loading.Increment(1, "core loaded");
+    }
+
+    std::vector<ThreadInfo> a;
+    std::vector<ThreadInfo> b;
+    {
+        OperationProgress unwinding(debugger, "Unwinding threads of both cores",
+                                    process_a.GetNumThreads() + process_b.GetNumThreads());
+        if (!CollectThreads(process_a, unwinding, a) || !CollectThreads(process_b, unwinding, b))
+        {
+            debugger.DeleteTarget(target_b);
+            return "Error: interrupted after unwinding " + std::to_string(unwinding.completed()) +
+                   " threads of both cores";
+        }
+    }
+    std::string out = "A = current process, B = " + core + "\n";
+
+    // Crash / stop reasons
+    size_t crash_a = CrashingThread(a, process_a);
+    size_t crash_b = CrashingThread(b, process_b);
+    std::string stop_a = crash_a < a.size() ? a[crash_a].stop : "(none)";
+    std::string stop_b = crash_b < b.size() ? b[crash_b].stop : "(none)";
+    if (stop_a == stop_b)
+        out += "stop: same (" + stop_a + ")\n";
+    else
+        out += "stop: A " + stop_a + " | B " + stop_b + "\n";
+
+    // Align threads: identical signatures first, then by longest common
+    // bottom of the stack. Threads are bucketed by signature, and by the hash
+    // of their outermost d frames from the deepest d down, so thousands of
+    // threads are not compared pairwise.
+    std::vector<int> match_a(a.size(), -1);
+    std::vector<bool> used_b(b.size(), false);
+    std::map<std::vector<std::string>, std::vector<size_t>> by_signature;
+    for (size_t j = b.size(); j-- > 0;)
+        by_signature[b[j].frames].push_back(j); // Lowest index last
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        auto it = by_signature.find(a[i].frames);
+        if (it == by_signature.end() || it->second.empty())
+            continue;
+        match_a[i] = static_cast<int>(it->second.back());
+        used_b[it->second.back()] = true;
+        it->second.pop_back();
+    }
+
+    std::vector<std::vector<uint64_t>> bottom_a, bottom_b;
+    for (const auto& t : a)
+        bottom_a.push_back(BottomHashes(t.frames));
+    for (const auto& t : b)
+        bottom_b.push_back(BottomHashes(t.frames));
+    for (size_t depth = kSignatureFrames; depth > 0; depth--)
+    {
+        std::unordered_map<uint64_t, std::vector<size_t>> bucket;
+        for (size_t j = b.size(); j-- > 0;)
+            if (!used_b[j] && bottom_b[j].size() >= depth)
+                bucket[bottom_b[j][depth - 1]].push_back(j);
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (match_a[i] >= 0 || bottom_a[i].size() < depth)
+                continue;
+            auto it = bucket.find(bottom_a[i][depth - 1]);
+            if (it == bucket.end() || it->second.empty())
+                continue;
+            size_t j = it->second.back();
+            if (CommonBottom(a[i].frames, b[j].frames) < depth)
+                continue; // Hash collision
+            match_a[i] = static_cast<int>(j);
+            used_b[j] = true;
+            it->second.pop_back();
+        }
+    }
+
+    size_t identical = 0;
+    std::string diverged;
+    std::string only_a;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (match_a[i] < 0)
+        {
+            only_a += "  A#" + std::to_string(a[i].id) + ": " + TopFrames(a[i].frames, 0) + "\n";
+            continue;
+        }
+        const ThreadInfo& tb = b[static_cast<size_t>(match_a[i])];
+        if (a[i].frames == tb.frames)
+        {
+            identical++;
+            continue;
+        }
+        size_t common = CommonBottom(a[i].frames, tb.frames);
+        diverged += "  A#" + std::to_string(a[i].id) + " ~ B#" + std::to_string(tb.id) + " (" +
+                    std::to_string(common) + " common bottom frames" +
+                    (common ? ", from " + a[i].frames[a[i].frames.size() - common] : "") +
+                    "):\n    A: " + TopFrames(a[i].frames, common) +
+                    "\n    B: " + TopFrames(tb.frames, common) + "\n";
+    }
+    std::string only_b;
+    for (size_t j = 0; j < b.size(); j++)
+        if (!used_b[j])
+            only_b += "  B#" + std::to_string(b[j].id) + ": " + TopFrames(b[j].frames, 0) + "\n";
+
+    out += "threads: A " + std::to_string(a.size()) + ", B " + std::to_string(b.size()) + "; " +
+           std::to_string(identical) + " with identical stacks\n";
+    if (!diverged.empty())
+        out += "stacks that differ:\n" + diverged;
+    if (!only_a.empty())
+        out += "only in A:\n" + only_a;
+    if (!only_b.empty())
+        out += "only in B:\n" + only_b;
+
+    // Registers of the crashing threads
+    if (crash_a < a.size() && crash_b < b.size())
+    {
+        auto regs_a = ReadRegisters(a[crash_a].thread);
+        auto regs_b = ReadRegisters(b[crash_b].thread);
+        std::string regs;
+        for (const auto& [name, value] : regs_a)
+        {
+            auto other = regs_b.find(name);
+            if (other == regs_b.end() || other->second == value)
+                continue;
+            char buf[96];
+            std::snprintf(buf, sizeof(buf), " %s 0x%" PRIx64 "->0x%" PRIx64, name.c_str(), value,
+                          other->second);
+            regs += buf;
+        }
+        out += "registers of crashing threads (A#" + std::to_string(a[crash_a].id) + " vs B#" +
+               std::to_string(b[crash_b].id) + "):" + (regs.empty() ? " same" : regs) + "\n";
+    }
+
+    // Requested globals
+    std::stringstream names(globals);
+    std::string name;
+    std::string globals_out;
+    while (std::getline(names, name, ','))
+    {
+        name.erase(0, name.find_first_not_of(' '));
+        name.erase(name.find_last_not_of(' ') + 1);
+        if (name.empty())
+            continue;
+        std::string va = DescribeGlobal(target_a, name);
+        std::string vb = DescribeGlobal(target_b, name);
+        globals_out += "  " + name + ": " + (va == vb ? "same (" + va + ")" : va + " -> " + vb) +
+                       "\n";
+    }
+    if (!globals_out.empty())
+        out += "globals:\n" + globals_out;
+
+    // Memory map and heap statistics
+    MemoryStats ma = CollectMemory(process_a);
+    MemoryStats mb = CollectMemory(process_b);
+    std::string memory = SizeDelta("mapped", ma.mapped, mb.mapped) +
+                         SizeDelta("writable", ma.writable, mb.writable) +
+                         SizeDelta("[heap]", ma.heap, mb.heap) +
+                         SizeDelta("anonymous rw", ma.anon, mb.anon) +
+                         SizeDelta("[stack]", ma.stack, mb.stack);
+    if (ma.regions != mb.regions)
+        memory += "  regions: " + std::to_string(ma.regions) + " -> " +
+                  std::to_string(mb.regions) + "\n";
+    out += memory.empty() ? "memory: same layout sizes\n" : "memory:\n" + memory;
+
+    debugger.DeleteTarget(target_b);
+
+    if (out.size() > budget)
+    {
+        out.resize(budget);
+        out += "\n(truncated)\n";
+    }
+    return out;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Compare the current process (live or core) with another core of the same
+// binary, opened in a secondary target that is deleted afterwards. Threads are
+// aligned by stack signature; the report lists stacks that differ, threads
+// present on one side only, differing registers of the crashing threads, the
+// values of the requested globals and memory-map/heap statistics.
+// core:    path of the other core file
+// globals: comma-separated global variable names to compare (may be empty)
+std::string DiffCores(lldb::SBDebugger& debugger, const std::string& core,
+                      const std::string& globals, size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
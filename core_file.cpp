@@ -0,0 +1,241 @@
+#include "core_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr uint16_t kCoreType = 4;         // ET_CORE
+constexpr uint32_t kLoadSegment = 1;      // PT_LOAD
+constexpr uint32_t kNoteSegment = 4;      // PT_NOTE
+constexpr uint16_t kExtendedNum = 0xffff; // PN_XNUM: count is in section header 0
+
+template <typename T> T Field(const char* data, size_t size, uint64_t offset)
+{
+    T value{};
+    if (offset <= size && sizeof(T) <= size - offset)
+        std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+bool HostIsLittleEndian()
+{
+    uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+} // namespace
+
+CoreFile::~CoreFile()
+{
+    Close();
+}
+
+void CoreFile::Close()
+{
+#ifndef _WIN32
+    if (data_)
+        munmap(const_cast<char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    segments_.clear();
+    notes_.clear();
+}
+
+bool CoreFile::Open(const std::string& path, std::string& error)
+{
+    Close();
+    path_ = path;
+#ifdef _WIN32
+    // Windows debuggees produce minidumps, not ELF cores
+    error = "ELF core mapping is not supported on this platform";
+    return false;
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 64)
+    {
+        close(fd);
+        error = path + " is too small for an ELF core";
+        return false;
+    }
+    void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        error = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    data_ = static_cast<const char*>(map);
+    size_ = static_cast<size_t>(st.st_size);
+    // Scanners walk segments front to back
+    madvise(map, size_, MADV_SEQUENTIAL);
+
+    const unsigned char* ident = reinterpret_cast<const unsigned char*>(data_);
+    if (std::memcmp(ident, "\x7f" "ELF", 4) != 0 || (ident[4] != 1 && ident[4] != 2))
+    {
+        Close();
+        error = path + " is not an ELF file";
+        return false;
+    }
+    if ((ident[5] == 1) != HostIsLittleEndian())
+    {
+        Close();
+        error = path + " has a foreign byte order";
+        return false;
+    }
+    is_64bit_ = ident[4] == 2;
+    if (Field<uint16_t>(data_, size_, 16) != kCoreType)
+    {
+        Close();
+        error = path + " is not a core file";
+        return false;
+    }
+
+    machine_ = Field<uint16_t>(data_, size_, 18);
+
+    uint64_t phoff = is_64bit_ ? Field<uint64_t>(data_, size_, 32)
+                               : Field<uint32_t>(data_, size_, 28);
+    uint16_t phentsize = Field<uint16_t>(data_, size_, is_64bit_ ? 54 : 42);
+    uint64_t phnum = Field<uint16_t>(data_, size_, is_64bit_ ? 56 : 44);
+    if (phnum == kExtendedNum)
+    {
+        uint64_t shoff = is_64bit_ ? Field<uint64_t>(data_, size_, 40)
+                                   : Field<uint32_t>(data_, size_, 32);
+        phnum = Field<uint32_t>(data_, size_, shoff + (is_64bit_ ? 44 : 28));
+    }
+
+    for (uint64_t i = 0; i < phnum; i++)
+    {
+        uint64_t ph = phoff + i * phentsize;
+        if (ph > size_ || phentsize > size_ - ph)
+            break;
+        uint32_t type = Field<uint32_t>(data_, size_, ph);
+        if (type != kLoadSegment && type != kNoteSegment)
+            continue;
+        Segment seg;
+        if (is_64bit_)
+        {
+            seg.flags = Field<uint32_t>(data_, size_, ph + 4);
+            seg.offset = Field<uint64_t>(data_, size_, ph + 8);
+            seg.vaddr = Field<uint64_t>(data_, size_, ph + 16);
+            seg.filesz = Field<uint64_t>(data_, size_, ph + 32);
+            seg.memsz = Field<uint64_t>(data_, size_, ph + 40);
+        }
+        else
+        {
+            seg.offset = Field<uint32_t>(data_, size_, ph + 4);
+            seg.vaddr = Field<uint32_t>(data_, size_, ph + 8);
+            seg.filesz = Field<uint32_t>(data_, size_, ph + 16);
+            seg.memsz = Field<uint32_t>(data_, size_, ph + 20);
+            seg.flags = Field<uint32_t>(data_, size_, ph + 24);
+        }
+        // Truncated cores: keep what is actually in the file
+        if (seg.offset > size_)
+            seg.filesz = 0;
+        else
+            seg.filesz = std::min<uint64_t>(seg.filesz, size_ - seg.offset);
+        if (type == kNoteSegment)
+            notes_.push_back(seg);
+        else if (seg.memsz)
+            segments_.push_back(seg);
+    }
+    std::sort(segments_.begin(), segments_.end(),
+              [](const Segment& a, const Segment& b) { return a.vaddr < b.vaddr; });
+    if (segments_.empty())
+    {
+        Close();
+        error = path + " has no memory segments";
+        return false;
+    }
+    return true;
+#endif
+}
+
+std::vector<CoreFile::Note> CoreFile::Notes() const
+{
+    // namesz, descsz, type, then name and desc, each padded to 4 bytes
+    auto pad = [](uint64_t n) { return (n + 3) & ~uint64_t(3); };
+    std::vector<Note> notes;
+    for (const Segment& seg : notes_)
+    {
+        const char* p = data_ + seg.offset;
+        uint64_t left = seg.filesz;
+        while (left >= 12)
+        {
+            uint32_t namesz = Field<uint32_t>(p, left, 0);
+            uint32_t descsz = Field<uint32_t>(p, left, 4);
+            uint64_t need = 12 + pad(namesz) + pad(descsz);
+            if (need > left)
+                break;
+            Note note;
+            note.type = Field<uint32_t>(p, left, 8);
+            note.name = std::string_view(p + 12, namesz ? namesz - 1 : 0); // Drop the NUL
+            note.desc = std::string_view(p + 12 + pad(namesz), descsz);
+            notes.push_back(note);
+            p += need;
+            left -= need;
+        }
+    }
+    return notes;
+}
+
+const CoreFile::Segment* CoreFile::Find(uint64_t address) const
+{
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), address,
+                               [](uint64_t a, const Segment& s) { return a < s.vaddr; });
+    if (it == segments_.begin())
+        return nullptr;
+    --it;
+    return address - it->vaddr < it->memsz ? &*it : nullptr;
+}
+
+std::string_view CoreFile::View(uint64_t address, size_t size) const
+{
+    const Segment* seg = Find(address);
+    if (!seg || address - seg->vaddr > seg->filesz || size > seg->filesz - (address - seg->vaddr))
+        return {};
+    return std::string_view(data_ + seg->offset + (address - seg->vaddr), size);
+}
+
+size_t CoreFile::Read(uint64_t address, void* buffer, size_t size) const
+{
+    char* out = static_cast<char*>(buffer);
+    size_t done = 0;
+    while (done < size)
+    {
+        const Segment* seg = Find(address + done);
+        if (!seg)
+            break;
+        uint64_t at = address + done - seg->vaddr;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(size - done, seg->memsz - at));
+        size_t in_file = at < seg->filesz
+                             ? static_cast<size_t>(std::min<uint64_t>(n, seg->filesz - at))
+                             : 0;
+        if (in_file)
+            std::memcpy(out + done, data_ + seg->offset + at, in_file);
+        std::memset(out + done + in_file, 0, n - in_file);
+        done += n;
+    }
+    return done;
+}
+
+} // namespace lldb_copilot
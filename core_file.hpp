@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Read-only view of an ELF core file mapped into memory. PT_LOAD segments are
+// kept in an address-sorted index, so process memory can be served as views
+// straight into the mapping without copying.
+class CoreFile
+{
+  public:
+    struct Segment
+    {
+        uint64_t vaddr = 0;
+        uint64_t memsz = 0;  // Size in the process
+        uint64_t filesz = 0; // Bytes present in the file (the rest reads as zeros)
+        uint64_t offset = 0;
+        uint32_t flags = 0; // PF_R/PF_W/PF_X
+    };
+
+    // One entry of a PT_NOTE segment; views point into the mapping
+    struct Note
+    {
+        uint32_t type = 0;
+        std::string_view name; // Owner, e.g. "CORE", "LINUX"
+        std::string_view desc;
+    };
+
+    CoreFile() = default;
+    ~CoreFile();
+    CoreFile(const CoreFile&) = delete;
+    CoreFile& operator=(const CoreFile&) = delete;
+
+    // Map path and index its segments; false with error if it is not an ELF
+    // core of this host's byte order
+    bool Open(const std::string& path, std::string& error);
+
+    // Bytes at [address, address + size) if they lie in the file part of one
+    // segment, else an empty view. Valid while this CoreFile lives.
+    std::string_view View(uint64_t address, size_t size) const;
+
+    // Copy up to size bytes at address, zero-filling segment tails that are
+    // not in the file. Returns bytes copied (short at the first unmapped byte).
+    size_t Read(uint64_t address, void* buffer, size_t size) const;
+
+    // All notes in file order (process status, signal info, mapped files, ...)
+    std::vector<Note> Notes() const;
+
+    // Segment containing address, or nullptr
+    const Segment* Find(uint64_t address) const;
+
+    const std::vector<Segment>& segments() const { return segments_; }
+    const std::string& path() const { return path_; }
+    bool is_64bit() const { return is_64bit_; }
+    uint16_t machine() const { return machine_; } // ELF e_machine
+
+  private:
+    void Close();
+
+    std::string path_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool is_64bit_ = true;
+    uint16_t machine_ = 0;
+    std::vector<Segment> segments_;
+    std::vector<Segment> notes_; // PT_NOTE segments (offset and filesz only)
+};
+
+} // namespace lldb_copilot
@@ -0,0 +1,379 @@
+#include "core_triage.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <set>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr uint32_t kNotePrstatus = 1;
+constexpr uint32_t kNotePrpsinfo = 3;
+constexpr uint32_t kNoteAuxv = 6;
+constexpr uint32_t kNoteSiginfo = 0x53494749;
+constexpr uint32_t kNoteFile = 0x46494c45;
+
+constexpr uint64_t kAuxEntry = 9;
+constexpr uint64_t kAuxBase = 7;
+constexpr uint64_t kAuxPlatform = 15;
+constexpr uint64_t kAuxExecFn = 31;
+
+constexpr size_t kShownThreads = 16;
+constexpr size_t kShownFiles = 12;
+
+// Layout of the register block in NT_PRSTATUS for one architecture
+struct RegLayout
+{
+    uint16_t machine;
+    const char* arch;
+    uint32_t pc; // Register indexes
+    uint32_t sp;
+};
+
+constexpr RegLayout kLayouts[] = {
+    {62, "x86_64", 16, 19}, // user_regs_struct: rip, rsp
+    {183, "aarch64", 32, 31},
+    {3, "i386", 12, 15}, // eip, esp
+    {40, "arm", 15, 13},
+    {243, "riscv", 0, 2},
+};
+
+template <typename T> T Get(std::string_view data, uint64_t offset)
+{
+    T value{};
+    if (offset <= data.size() && sizeof(T) <= data.size() - offset)
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+uint64_t Word(std::string_view data, uint64_t offset, bool is_64bit)
+{
+    return is_64bit ? Get<uint64_t>(data, offset) : Get<uint32_t>(data, offset);
+}
+
+// NUL-terminated string in a fixed-size field
+std::string FixedString(std::string_view data, uint64_t offset, size_t size)
+{
+    if (offset >= data.size())
+        return "";
+    std::string_view field = data.substr(offset, size);
+    return std::string(field.substr(0, field.find('\0')));
+}
+
+const char* SignalName(int signal)
+{
+    static const char* const kNames[] = {
+        "0",       "SIGHUP",  "SIGINT",    "SIGQUIT", "SIGILL",   "SIGTRAP", "SIGABRT",
+        "SIGBUS",  "SIGFPE",  "SIGKILL",   "SIGUSR1", "SIGSEGV",  "SIGUSR2", "SIGPIPE",
+        "SIGALRM", "SIGTERM", "SIGSTKFLT", "SIGCHLD", "SIGCONT",  "SIGSTOP", "SIGTSTP",
+        "SIGTTIN", "SIGTTOU", "SIGURG",    "SIGXCPU", "SIGXFSZ",  "SIGVTALRM",
+        "SIGPROF", "SIGWINCH", "SIGIO",    "SIGPWR",  "SIGSYS",
+    };
+    return signal > 0 && signal < static_cast<int>(sizeof(kNames) / sizeof(kNames[0]))
+               ? kNames[signal]
+               : "signal";
+}
+
+std::string SignalCodeName(int signal, int code)
+{
+    switch (code)
+    {
+    case 0:
+        return "SI_USER (sent by kill)";
+    case -1:
+        return "SI_QUEUE";
+    case -6:
+        return "SI_TKILL (sent by tkill/raise)";
+    case 0x80:
+        return "SI_KERNEL";
+    }
+    if (signal == 11)
+    {
+        static const char* const kSegv[] = {"", "SEGV_MAPERR (address not mapped)",
+                                            "SEGV_ACCERR (permission denied)", "SEGV_BNDERR",
+                                            "SEGV_PKUERR"};
+        if (code > 0 && code < 5)
+            return kSegv[code];
+    }
+    if (signal == 7)
+    {
+        static const char* const kBus[] = {"", "BUS_ADRALN (misaligned)",
+                                           "BUS_ADRERR (nonexistent physical address)",
+                                           "BUS_OBJERR (object error, e.g. truncated mmap file)"};
+        if (code > 0 && code < 4)
+            return kBus[code];
+    }
+    if (signal == 8 && code == 1)
+        return "FPE_INTDIV (integer divide by zero)";
+    if (signal == 4 && code == 1)
+        return "ILL_ILLOPC (illegal opcode)";
+    return "code " + std::to_string(code);
+}
+
+// "file+0xoffset" for an address inside a mapped file
+std::string Locate(const CoreFacts& facts, uint64_t address)
+{
+    for (const auto& file : facts.files)
+    {
+        if (address >= file.start && address < file.end)
+        {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "+0x%" PRIx64, address - file.start + file.offset);
+            return file.path + buf;
+        }
+    }
+    return "";
+}
+
+void ParsePrstatus(std::string_view desc, const CoreFile& core, const RegLayout* layout,
+                   CoreFacts& facts)
+{
+    bool is_64bit = core.is_64bit();
+    CoreFacts::Thread thread;
+    thread.signal = Get<int16_t>(desc, 12);
+    thread.tid = Get<uint32_t>(desc, is_64bit ? 32 : 24);
+    if (facts.threads.empty())
+    {
+        facts.pid = Get<uint32_t>(desc, is_64bit ? 32 : 24);
+        facts.ppid = Get<uint32_t>(desc, is_64bit ? 36 : 28);
+    }
+    if (layout)
+    {
+        uint64_t regs = is_64bit ? 112 : 72;
+        uint64_t word = is_64bit ? 8 : 4;
+        thread.pc = Word(desc, regs + layout->pc * word, is_64bit);
+        thread.sp = Word(desc, regs + layout->sp * word, is_64bit);
+        thread.has_regs = true;
+    }
+    facts.threads.push_back(thread);
+}
+
+void ParsePrpsinfo(std::string_view desc, bool is_64bit, CoreFacts& facts)
+{
+    facts.uid = is_64bit ? Get<uint32_t>(desc, 16) : Get<uint16_t>(desc, 8);
+    if (!facts.pid)
+        facts.pid = Get<uint32_t>(desc, is_64bit ? 24 : 12);
+    facts.command = FixedString(desc, is_64bit ? 40 : 28, 16);
+    facts.args = FixedString(desc, is_64bit ? 56 : 44, 80);
+    while (!facts.args.empty() && facts.args.back() == ' ')
+        facts.args.pop_back();
+}
+
+void ParseSiginfo(std::string_view desc, bool is_64bit, CoreFacts& facts)
+{
+    facts.has_siginfo = true;
+    facts.signal = Get<int32_t>(desc, 0);
+    facts.signal_code = Get<int32_t>(desc, 8);
+    facts.fault_address = Word(desc, is_64bit ? 16 : 12, is_64bit);
+}
+
+void ParseFileNote(std::string_view desc, bool is_64bit, CoreFacts& facts)
+{
+    uint64_t word = is_64bit ? 8 : 4;
+    uint64_t count = Word(desc, 0, is_64bit);
+    uint64_t page_size = Word(desc, word, is_64bit);
+    uint64_t names = 2 * word + count * 3 * word;
+    if (names > desc.size())
+        return;
+    std::string_view strings = desc.substr(names);
+    for (uint64_t i = 0; i < count && !strings.empty(); i++)
+    {
+        uint64_t entry = 2 * word + i * 3 * word;
+        size_t len = strings.find('\0');
+        CoreFacts::MappedFile file;
+        file.start = Word(desc, entry, is_64bit);
+        file.end = Word(desc, entry + word, is_64bit);
+        file.offset = Word(desc, entry + 2 * word, is_64bit) * page_size;
+        file.path = std::string(strings.substr(0, len));
+        facts.files.push_back(std::move(file));
+        strings.remove_prefix(len == std::string_view::npos ? strings.size() : len + 1);
+    }
+}
+
+// String in the core's memory (auxv values point into the initial stack)
+std::string MemoryString(const CoreFile& core, uint64_t address)
+{
+    char buf[256] = {};
+    size_t n = core.Read(address, buf, sizeof(buf) - 1);
+    return std::string(buf, strnlen(buf, n));
+}
+
+void ParseAuxv(std::string_view desc, const CoreFile& core, CoreFacts& facts)
+{
+    bool is_64bit = core.is_64bit();
+    uint64_t word = is_64bit ? 8 : 4;
+    for (uint64_t at = 0; at + 2 * word <= desc.size(); at += 2 * word)
+    {
+        uint64_t type = Word(desc, at, is_64bit);
+        uint64_t value = Word(desc, at + word, is_64bit);
+        if (type == 0)
+            break;
+        if (type == kAuxEntry)
+            facts.entry = value;
+        else if (type == kAuxBase)
+            facts.interpreter_base = value;
+        else if (type == kAuxPlatform)
+            facts.platform = MemoryString(core, value);
+        else if (type == kAuxExecFn)
+            facts.executable = MemoryString(core, value);
+    }
+}
+} // namespace
+
+bool ReadCoreFacts(const CoreFile& core, CoreFacts& facts, std::string& error)
+{
+    auto start = std::chrono::steady_clock::now();
+    facts = CoreFacts();
+
+    const RegLayout* layout = nullptr;
+    for (const RegLayout& l : kLayouts)
+        if (l.machine == core.machine())
+            layout = &l;
+    facts.arch = layout ? layout->arch : "machine " + std::to_string(core.machine());
+
+    std::vector<CoreFile::Note> notes = core.Notes();
+    for (const CoreFile::Note& note : notes)
+    {
+        if (note.name != "CORE")
+            continue;
+        switch (note.type)
+        {
+        case kNotePrstatus:
+            ParsePrstatus(note.desc, core, layout, facts);
+            break;
+        case kNotePrpsinfo:
+            ParsePrpsinfo(note.desc, core.is_64bit(), facts);
+            break;
+        case kNoteSiginfo:
+            ParseSiginfo(note.desc, core.is_64bit(), facts);
+            break;
+        case kNoteFile:
+            ParseFileNote(note.desc, core.is_64bit(), facts);
+            break;
+        case kNoteAuxv:
+            ParseAuxv(note.desc, core, facts);
+            break;
+        }
+    }
+    if (facts.threads.empty() && facts.files.empty())
+    {
+        error = core.path() + " has no process notes";
+        return false;
+    }
+    if (!facts.has_siginfo && !facts.threads.empty())
+        facts.signal = facts.threads.front().signal;
+    if (facts.executable.empty() && !facts.files.empty())
+        facts.executable = facts.files.front().path;
+
+    facts.segments = core.segments().size();
+    for (const auto& seg : core.segments())
+        facts.core_bytes += seg.filesz;
+    facts.parse_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    return true;
+}
+
+std::string FormatCoreFacts(const CoreFacts& facts)
+{
+    char line[512];
+    std::string out;
+
+    std::snprintf(line, sizeof(line),
+                  "process %" PRIu64 " (ppid %" PRIu64 ", uid %" PRIu64 ") %s, %s\n", facts.pid,
+                  facts.ppid, facts.uid, facts.command.c_str(), facts.arch.c_str());
+    out += line;
+    if (!facts.args.empty())
+        out += "command line: " + facts.args + "\n";
+    if (!facts.executable.empty())
+    {
+        std::snprintf(line, sizeof(line), "executable: %s (entry 0x%" PRIx64 ")\n",
+                      facts.executable.c_str(), facts.entry);
+        out += line;
+    }
+
+    if (facts.signal)
+    {
+        std::snprintf(line, sizeof(line), "signal: %s (%d)", SignalName(facts.signal),
+                      facts.signal);
+        out += line;
+        if (facts.has_siginfo)
+        {
+            out += ", " + SignalCodeName(facts.signal, facts.signal_code);
+            // Only faults carry a meaningful address
+            if (facts.signal == 4 || facts.signal == 7 || facts.signal == 8 ||
+                facts.signal == 11)
+            {
+                std::snprintf(line, sizeof(line), ", fault address 0x%" PRIx64,
+                              facts.fault_address);
+                out += line;
+                std::string where = Locate(facts, facts.fault_address);
+                if (!where.empty())
+                    out += " (" + where + ")";
+            }
+        }
+        out += "\n";
+    }
+
+    if (!facts.threads.empty())
+    {
+        const CoreFacts::Thread& crashed = facts.threads.front();
+        std::snprintf(line, sizeof(line), "signalled thread: tid %" PRIu64, crashed.tid);
+        out += line;
+        if (crashed.has_regs)
+        {
+            std::snprintf(line, sizeof(line), " pc 0x%" PRIx64 " sp 0x%" PRIx64, crashed.pc,
+                          crashed.sp);
+            out += line;
+            std::string where = Locate(facts, crashed.pc);
+            if (!where.empty())
+                out += " (" + where + ")";
+        }
+        out += "\n";
+
+        out += std::to_string(facts.threads.size()) + " threads:";
+        for (size_t i = 0; i < facts.threads.size() && i < kShownThreads; i++)
+            out += " " + std::to_string(facts.threads[i].tid);
+        if (facts.threads.size() > kShownThreads)
+            out += " ...";
+        out += "\n";
+    }
+
+    // One line per file, in mapping order
+    std::set<std::string> seen;
+    std::vector<std::string> files;
+    for (const auto& file : facts.files)
+        if (seen.insert(file.path).second)
+            files.push_back(file.path);
+    if (!files.empty())
+    {
+        out += std::to_string(files.size()) + " mapped files:\n";
+        for (size_t i = 0; i < files.size() && i < kShownFiles; i++)
+            out += "  " + files[i] + "\n";
+        if (files.size() > kShownFiles)
+            out += "  ... " + std::to_string(files.size() - kShownFiles) + " more\n";
+    }
+
+    std::snprintf(line, sizeof(line), "(%" PRIu64 " segments, %.1f MB of memory; notes parsed in "
+                  "%.2f ms)\n",
+                  facts.segments, facts.core_bytes / 1048576.0, facts.parse_ms);
+    out += line;
+    return out;
+}
+
+std::string TriageCoreFile(const std::string& path, CoreFacts* facts)
+{
+    CoreFile core;
+    CoreFacts local;
+    CoreFacts& result = facts ? *facts : local;
+    std::string error;
+    if (!core.Open(path, error) || !ReadCoreFacts(core, result, error))
+        return "Error: " + error;
+    return FormatCoreFacts(result);
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core_file.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// First facts about a crash, read from the ELF notes of a core file in
+// milliseconds, before (and without) a full target load with symbols
+struct CoreFacts
+{
+    struct Thread
+    {
+        uint64_t tid = 0;
+        int signal = 0; // pr_cursig
+        uint64_t pc = 0;
+        uint64_t sp = 0;
+        bool has_regs = false; // pc/sp known for this architecture
+    };
+
+    struct MappedFile
+    {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        uint64_t offset = 0; // File offset in bytes
+        std::string path;
+    };
+
+    std::string arch;
+    uint64_t pid = 0;
+    uint64_t ppid = 0;
+    uint64_t uid = 0;
+    std::string command; // pr_fname
+    std::string args;    // pr_psargs
+
+    bool has_siginfo = false;
+    int signal = 0;
+    int signal_code = 0;
+    uint64_t fault_address = 0;
+
+    std::vector<Thread> threads; // Crashing thread first
+    std::vector<MappedFile> files;
+
+    std::string executable; // AT_EXECFN, else the first mapped file
+    uint64_t entry = 0;     // AT_ENTRY
+    uint64_t interpreter_base = 0;
+    std::string platform; // AT_PLATFORM
+
+    uint64_t segments = 0;
+    uint64_t core_bytes = 0;
+    double parse_ms = 0;
+};
+
+// Parse the notes of an open core; false with error if it has none
+bool ReadCoreFacts(const CoreFile& core, CoreFacts& facts, std::string& error);
+
+// Human-readable summary of the facts
+std::string FormatCoreFacts(const CoreFacts& facts);
+
+// Open path, read its notes and format them; "Error: ..." on failure
+std::string TriageCoreFile(const std::string& path, CoreFacts* facts = nullptr);
+
+} // namespace lldb_copilot
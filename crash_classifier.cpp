@@ -0,0 +1,315 @@
+#include "crash_classifier.hpp"
+
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr uint32_t kScanFrames = 24;     // Frames inspected for signatures
+constexpr uint64_t kNullPage = 0x10000;  // Faults below this are null derefs
+constexpr uint64_t kGuardSlack = 0x10000; // Fault this close to SP = stack overflow
+constexpr int kRecursionRepeats = 8;
+
+// Stack signatures, checked in order against the top frames' function names
+struct FrameRule
+{
+    const char* kind;
+    const char* verdict;
+    std::vector<const char*> symbols;
+};
+
+const std::vector<FrameRule>& FrameRules()
+{
+    static const std::vector<FrameRule> rules = {
+        {"pure-virtual", "pure virtual function call (object used during construction or "
+                         "after destruction)",
+         {"__cxa_pure_virtual", "_purecall"}},
+        {"assertion", "assertion failure",
+         {"__assert_fail", "__assert_rtn", "_wassert", "__assert_perror_fail", "__assert"}},
+        {"heap-corruption", "heap corruption detected by the allocator (double free, invalid "
+                            "free or overwritten chunk metadata)",
+         {"malloc_printerr", "malloc_error_break", "_int_free", "RtlReportCriticalFailure",
+          "___BUG_IN_CLIENT_OF_LIBMALLOC", "malloc_zone_error"}},
+        {"stack-protector", "stack buffer overflow (stack protector canary smashed)",
+         {"__stack_chk_fail"}},
+        {"fortify", "buffer overflow detected by _FORTIFY_SOURCE",
+         {"__chk_fail", "__fortify_fail"}},
+        {"uncaught-exception", "uncaught C++ exception (std::terminate)",
+         {"std::terminate", "__cxa_call_terminate", "__terminate", "__verbose_terminate_handler",
+          "demangling_terminate_handler"}},
+    };
+    return rules;
+}
+
+std::string Hex(uint64_t v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "0x%" PRIx64, v);
+    return buf;
+}
+
+std::string FrameName(lldb::SBFrame frame)
+{
+    const char* name = frame.GetFunctionName();
+    if (!name)
+        name = frame.GetSymbol().GetName();
+    return name ? name : "";
+}
+
+// First frame from index 'from' that has source line info (user code)
+std::string UserFrame(lldb::SBThread& thread, uint32_t from)
+{
+    for (uint32_t i = from; i < from + kScanFrames; i++)
+    {
+        lldb::SBFrame frame = thread.GetFrameAtIndex(i);
+        if (!frame.IsValid())
+            break;
+        lldb::SBLineEntry line = frame.GetLineEntry();
+        if (line.IsValid() && line.GetFileSpec().GetFilename())
+            return "#" + std::to_string(i) + " " + FrameName(frame) + " at " +
+                   line.GetFileSpec().GetFilename() + ":" + std::to_string(line.GetLine());
+    }
+    return "";
+}
+
+// Fault address from the stop description, e.g.
+// "signal SIGSEGV: invalid address (fault address: 0x10)" or
+// "EXC_BAD_ACCESS (code=1, address=0x10)"
+bool ParseFaultAddress(const std::string& description, uint64_t* address)
+{
+    for (const char* key : {"fault address: ", "address=", "address: "})
+    {
+        size_t pos = description.find(key);
+        if (pos == std::string::npos)
+            continue;
+        const char* start = description.c_str() + pos + std::strlen(key);
+        char* end = nullptr;
+        uint64_t v = std::strtoull(start, &end, 0);
+        if (end != start)
+        {
+            *address = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsCrashStop(lldb::SBThread& thread, int* signo)
+{
+    *signo = 0;
+    switch (thread.GetStopReason())
+    {
+    case lldb::eStopReasonException:
+        return true;
+    case lldb::eStopReasonSignal:
+    {
+        *signo = static_cast<int>(thread.GetStopReasonDataAtIndex(0));
+        lldb::SBUnixSignals signals = thread.GetProcess().GetUnixSignals();
+        const char* name = signals.IsValid() ? signals.GetSignalAsCString(*signo) : nullptr;
+        std::string n = name ? name : "";
+        return n == "SIGSEGV" || n == "SIGBUS" || n == "SIGFPE" || n == "SIGILL" ||
+               n == "SIGABRT" || n == "SIGSYS";
+    }
+    default:
+        return false;
+    }
+}
+} // namespace
+
+std::string CrashVerdict::OneLine() const
+{
+    std::string line = summary;
+    if (!evidence.empty())
+    {
+        line += " [";
+        for (size_t i = 0; i < evidence.size(); i++)
+            line += (i ? "; " : "") + evidence[i];
+        line += "]";
+    }
+    return line;
+}
+
+CrashVerdict ClassifyStop(lldb::SBDebugger& debugger)
+{
+    CrashVerdict verdict;
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid())
+        return verdict;
+
+    // Crashing thread: the selected one if it crashed, else the first that did
+    lldb::SBThread thread = process.GetSelectedThread();
+    int signo = 0;
+    if (!IsCrashStop(thread, &signo))
+    {
+        bool found = false;
+        for (uint32_t i = 0; i < process.GetNumThreads() && !found; i++)
+        {
+            thread = process.GetThreadAtIndex(i);
+            found = IsCrashStop(thread, &signo);
+        }
+        if (!found)
+            return verdict;
+    }
+
+    verdict.crashed = true;
+    verdict.thread = thread.GetIndexID();
+
+    char desc_buf[256] = {};
+    thread.GetStopDescription(desc_buf, sizeof(desc_buf));
+    std::string description = desc_buf;
+    verdict.evidence.push_back("thread " + std::to_string(verdict.thread) + ": " + description);
+
+    lldb::SBUnixSignals signals = process.GetUnixSignals();
+    const char* signame = signo && signals.IsValid() ? signals.GetSignalAsCString(signo) : nullptr;
+    std::string sig = signame ? signame : "";
+
+    // 1. Stack signatures (abort paths and runtime checks)
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < kScanFrames; i++)
+    {
+        lldb::SBFrame frame = thread.GetFrameAtIndex(i);
+        if (!frame.IsValid())
+            break;
+        names.push_back(FrameName(frame));
+    }
+
+    for (const auto& rule : FrameRules())
+    {
+        for (uint32_t i = 0; i < names.size(); i++)
+        {
+            for (const char* symbol : rule.symbols)
+            {
+                if (names[i].find(symbol) == std::string::npos)
+                    continue;
+                verdict.kind = rule.kind;
+                verdict.summary = rule.verdict;
+                verdict.evidence.push_back("#" + std::to_string(i) + " " + names[i]);
+                std::string user = UserFrame(thread, i + 1);
+                if (!user.empty())
+                    verdict.evidence.push_back("from " + user);
+                return verdict;
+            }
+        }
+    }
+
+    lldb::SBFrame top = thread.GetFrameAtIndex(0);
+    uint64_t pc = top.GetPC();
+    uint64_t sp = top.GetSP();
+    uint64_t fault = 0;
+    bool have_fault = ParseFaultAddress(description, &fault);
+    bool bad_access = sig == "SIGSEGV" || sig == "SIGBUS" ||
+                      description.find("EXC_BAD_ACCESS") != std::string::npos ||
+                      description.find("Access violation") != std::string::npos;
+
+    // 2. Stack overflow: fault next to SP, or the top frames are one recursion
+    int repeats = 0;
+    for (const auto& name : names)
+        if (!name.empty() && (name == names[0] || (names.size() > 1 && name == names[1])))
+            repeats++;
+    bool near_sp = have_fault && (fault > sp ? fault - sp : sp - fault) < kGuardSlack;
+    if (bad_access && (near_sp || repeats >= kRecursionRepeats) && have_fault &&
+        fault >= kNullPage)
+    {
+        lldb::SBMemoryRegionInfo region;
+        bool mapped = process.GetMemoryRegionInfo(fault, region).Success() && region.IsMapped() &&
+                      region.IsReadable();
+        if (near_sp || !mapped)
+        {
+            verdict.kind = "stack-overflow";
+            verdict.summary = "stack overflow (fault at the stack guard page)";
+            verdict.evidence.push_back("fault " + Hex(fault) + ", sp " + Hex(sp) +
+                                       (mapped ? "" : ", fault address unmapped"));
+            if (repeats >= kRecursionRepeats)
+                verdict.evidence.push_back(names[0] + " repeats in " + std::to_string(repeats) +
+                                           " of the top " + std::to_string(names.size()) +
+                                           " frames (recursion)");
+            return verdict;
+        }
+    }
+
+    // 3. Memory access faults
+    if (bad_access)
+    {
+        std::string user = UserFrame(thread, 0);
+        if (pc < kNullPage)
+        {
+            verdict.kind = "null-call";
+            verdict.summary = "call through a null function pointer (pc " + Hex(pc) + ")";
+            lldb::SBFrame caller = thread.GetFrameAtIndex(1);
+            if (caller.IsValid())
+                verdict.evidence.push_back("called from " + FrameName(caller));
+        }
+        else if (have_fault && fault < kNullPage)
+        {
+            verdict.kind = "null-deref";
+            verdict.summary = "null pointer dereference";
+            verdict.evidence.push_back(
+                "fault address " + Hex(fault) +
+                (fault ? " (field at offset " + std::to_string(fault) + " of a null object)" : ""));
+        }
+        else if (have_fault && fault == pc)
+        {
+            verdict.kind = "bad-jump";
+            verdict.summary = "jump to an invalid or non-executable address (corrupted "
+                              "function pointer or return address)";
+            verdict.evidence.push_back("pc " + Hex(pc));
+        }
+        else
+        {
+            verdict.kind = "bad-access";
+            verdict.summary = "invalid memory access";
+            if (have_fault)
+            {
+                lldb::SBMemoryRegionInfo region;
+                bool mapped = process.GetMemoryRegionInfo(fault, region).Success() &&
+                              region.IsMapped();
+                std::string where = !mapped             ? "unmapped"
+                                    : !region.IsWritable() ? "read-only mapping (write?)"
+                                                           : "mapped";
+                if ((fault >> 48) != 0 && (fault >> 48) != 0xffff)
+                    where += ", non-canonical (garbage or poisoned pointer)";
+                verdict.evidence.push_back("fault address " + Hex(fault) + ": " + where);
+            }
+        }
+        if (!user.empty())
+            verdict.evidence.push_back("in " + user);
+        return verdict;
+    }
+
+    // 4. Other fatal signals
+    if (sig == "SIGFPE")
+    {
+        verdict.kind = "arithmetic";
+        verdict.summary = description.find("divide") != std::string::npos
+                              ? "integer division by zero"
+                              : "arithmetic exception";
+    }
+    else if (sig == "SIGILL")
+    {
+        verdict.kind = "illegal-instruction";
+        verdict.summary = "illegal instruction (__builtin_trap/unreachable reached, or a jump "
+                          "into data)";
+    }
+    else if (sig == "SIGABRT")
+    {
+        verdict.kind = "abort";
+        verdict.summary = "abort() called";
+    }
+    else
+    {
+        verdict.kind = "crash";
+        verdict.summary = description.empty() ? "fatal stop" : description;
+    }
+    std::string user = UserFrame(thread, 0);
+    if (!user.empty())
+        verdict.evidence.push_back("in " + user);
+    return verdict;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <lldb/API/LLDB.h>
+#include <string>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Result of the local crash pre-classifier
+struct CrashVerdict
+{
+    bool crashed = false;  // Stop is a crash (fatal signal or exception)
+    std::string kind;      // e.g. "null-deref", "stack-overflow", "assertion"
+    std::string summary;   // One-line human readable verdict
+    std::vector<std::string> evidence;
+    uint32_t thread = 0;   // Index ID of the crashing thread
+
+    // "<summary> [evidence; evidence]"
+    std::string OneLine() const;
+};
+
+// Classify the current stop from recognisable crash signatures (fault address
+// near 0, SP at a guard page, abort with __assert_fail in the stack, ...)
+// using only local SB API queries. Runs in milliseconds; the verdict is a
+// hint for the model, not a diagnosis.
+CrashVerdict ClassifyStop(lldb::SBDebugger& debugger);
+
+} // namespace lldb_copilot
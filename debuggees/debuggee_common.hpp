@@ -0,0 +1,36 @@
+#pragma once
+
+// Shared helpers for the synthetic stress debuggees.
+// Every debuggee builds its state and then stops with SIGTRAP, so it can be
+// examined live under LLDB or dumped to a core file (see make_cores.sh).
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace debuggee
+{
+
+// Numeric argument at argv[index], or fallback when absent
+inline long long ArgOr(int argc, char** argv, int index, long long fallback)
+{
+    return argc > index ? std::atoll(argv[index]) : fallback;
+}
+
+// String argument at argv[index], or fallback when absent
+inline const char* StrArgOr(int argc, char** argv, int index, const char* fallback)
+{
+    return argc > index ? argv[index] : fallback;
+}
+
+// Stop here: LLDB reports a SIGTRAP stop; without a debugger the process
+// dumps core (when enabled by ulimit -c).
+inline void StopForDebugger(const char* what)
+{
+    std::printf("ready: %s\n", what);
+    std::fflush(stdout);
+    std::raise(SIGTRAP);
+}
+
+} // namespace debuggee
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+# Run each stress debuggee under LLDB until its stop point and save a core.
+#
+# Usage: make_cores.sh <debuggee-dir> [output-dir] [name...]
+#
+# Environment:
+#   LLDB        lldb binary to use (default: lldb)
+#   CORE_STYLE  process save-core --style value (default: full)
+set -euo pipefail
+
+bin_dir="${1:?usage: make_cores.sh <debuggee-dir> [output-dir] [name...]}"
+out_dir="${2:-$bin_dir/cores}"
+shift $(( $# >= 2 ? 2 : 1 ))
+
+lldb="${LLDB:-lldb}"
+style="${CORE_STYLE:-full}"
+
+# name|arguments
+scenarios=(
+    "stress_threads|5000"
+    "stress_recursion|100000"
+    "stress_recursion_overflow|0 overflow"
+    "stress_heap|2048 2000000"
+    "stress_deadlock|8"
+    "stress_heap_corruption|double-free"
+    "stress_heap_corruption_overflow|overflow"
+    "stress_stl|1000000"
+    "stress_mappings|50000"
+)
+
+mkdir -p "$out_dir"
+for entry in "${scenarios[@]}"; do
+    name="${entry%%|*}"
+    args="${entry#*|}"
+    if [[ $# -gt 0 && ! " $* " =~ " $name " ]]; then
+        continue
+    fi
+
+    # Scenario variants share the executable of their base name
+    exe="$bin_dir/$name"
+    [[ -x "$exe" ]] || exe="$bin_dir/${name%_*}"
+    if [[ ! -x "$exe" ]]; then
+        echo "skip: $name (no executable)" >&2
+        continue
+    fi
+
+    core="$out_dir/$name.core"
+    rm -f "$core"
+    start=$(date +%s)
+    # shellcheck disable=SC2086
+    "$lldb" --batch \
+        -o "process launch" \
+        -o "process save-core --style $style \"$core\"" \
+        -o "process kill" \
+        -k "process save-core --style $style \"$core\"" \
+        -k "process kill" \
+        -- "$exe" $args > "$out_dir/$name.log" 2>&1 || true
+    end=$(date +%s)
+
+    if [[ -f "$core" ]]; then
+        printf '%-34s %8s MB  %4ss\n' "$name" "$(( $(stat -c %s "$core" 2>/dev/null || stat -f %z "$core") / 1048576 ))" "$(( end - start ))"
+    else
+        echo "FAILED: $name (see $out_dir/$name.log)" >&2
+    fi
+done
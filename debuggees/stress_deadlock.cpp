@@ -0,0 +1,76 @@
+// Lock-order inversion: argv[1] (default 8) pairs of threads, each pair
+// deadlocked on two mutexes, plus contended waiters on a shared mutex and a
+// thread blocked reading an empty pipe.
+#include "debuggee_common.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+struct Pair
+{
+    std::mutex first;
+    std::mutex second;
+};
+
+std::mutex g_shared;
+
+__attribute__((noinline)) void LockInOrder(std::mutex& a, std::mutex& b)
+{
+    std::lock_guard<std::mutex> hold(a);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::lock_guard<std::mutex> wait(b); // Never acquired
+}
+
+__attribute__((noinline)) void HoldShared()
+{
+    std::lock_guard<std::mutex> hold(g_shared);
+    std::this_thread::sleep_for(std::chrono::hours(24));
+}
+
+__attribute__((noinline)) void WaitShared()
+{
+    std::lock_guard<std::mutex> wait(g_shared);
+}
+
+__attribute__((noinline)) void BlockOnPipe(int fd)
+{
+    char c;
+    while (read(fd, &c, 1) != 0)
+    {
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    long long pairs = debuggee::ArgOr(argc, argv, 1, 8);
+
+    std::vector<Pair> locks(static_cast<size_t>(pairs));
+    std::vector<std::thread> threads;
+    for (auto& pair : locks)
+    {
+        threads.emplace_back(LockInOrder, std::ref(pair.first), std::ref(pair.second));
+        threads.emplace_back(LockInOrder, std::ref(pair.second), std::ref(pair.first));
+    }
+
+    threads.emplace_back(HoldShared);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int i = 0; i < 4; i++)
+        threads.emplace_back(WaitShared);
+
+    int fds[2];
+    if (pipe(fds) == 0)
+        threads.emplace_back(BlockOnPipe, fds[0]);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    debuggee::StopForDebugger("deadlocked");
+
+    for (auto& t : threads)
+        t.join(); // Never returns
+    return 0;
+}
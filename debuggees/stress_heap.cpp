@@ -0,0 +1,45 @@
+// Large heap: argv[1] MB (default 2048) spread over many chunks of mixed size
+// classes (default 2,000,000 chunks, argv[2]), with every third chunk freed
+// to fragment the free lists.
+#include "debuggee_common.hpp"
+
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    long long total_mb = debuggee::ArgOr(argc, argv, 1, 2048);
+    long long chunks = debuggee::ArgOr(argc, argv, 2, 2000000);
+
+    const size_t avg = static_cast<size_t>(total_mb * 1024 * 1024 / chunks);
+    const size_t sizes[] = {16, 48, 128, avg / 2 + 1, avg, avg * 2, 4096};
+
+    std::vector<char*> live;
+    live.reserve(static_cast<size_t>(chunks));
+    for (long long i = 0; i < chunks; i++)
+    {
+        size_t size = sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+        char* p = static_cast<char*>(std::malloc(size));
+        if (!p)
+        {
+            std::fprintf(stderr, "malloc failed after %lld chunks\n", i);
+            break;
+        }
+        // Touch every page so the memory is resident and shows up in cores
+        for (size_t off = 0; off < size; off += 4096)
+            p[off] = static_cast<char>(i);
+        std::snprintf(p, size, "chunk-%lld", i);
+        live.push_back(p);
+    }
+
+    for (size_t i = 0; i < live.size(); i += 3)
+    {
+        std::free(live[i]);
+        live[i] = nullptr;
+    }
+
+    debuggee::StopForDebugger("heap populated");
+
+    for (char* p : live)
+        std::free(p);
+    return 0;
+}
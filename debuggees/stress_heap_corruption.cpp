@@ -0,0 +1,66 @@
+// Heap corruption crashes detected by the allocator. argv[1] selects the bug:
+//   double-free (default)  free the same chunk twice
+//   overflow               write past a chunk into the next chunk's header
+//   use-after-free         write through a dangling pointer, then reallocate
+#include "debuggee_common.hpp"
+
+#include <vector>
+
+namespace
+{
+// Keeps allocations observable so the compiler cannot elide malloc/free pairs
+char* volatile g_sink;
+
+char* Allocate(size_t size)
+{
+    char* p = static_cast<char*>(std::malloc(size));
+    g_sink = p;
+    return p;
+}
+
+__attribute__((noinline)) void DoubleFree()
+{
+    char* p = Allocate(64);
+    char* guard = Allocate(64);
+    std::free(p);
+    std::free(guard);
+    std::free(p);
+}
+
+__attribute__((noinline)) void Overflow()
+{
+    std::vector<char*> chunks;
+    chunks.reserve(16); // Keep the vector's own buffer out of the chunk run
+    for (int i = 0; i < 16; i++)
+        chunks.push_back(Allocate(24));
+    std::memset(chunks[4], 'A', 64); // Clobbers the following chunk headers
+    for (char* p : chunks)
+        std::free(p);
+}
+
+__attribute__((noinline)) void UseAfterFree()
+{
+    char* q = Allocate(128);
+    char* p = Allocate(128);
+    std::free(q);
+    std::free(p);
+    std::memset(g_sink, 0x41, 32); // Overwrites the free-list link of p
+    for (int i = 0; i < 4; i++)
+        std::memset(Allocate(128), 0, 128);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const char* mode = debuggee::StrArgOr(argc, argv, 1, "double-free");
+    if (std::strcmp(mode, "overflow") == 0)
+        Overflow();
+    else if (std::strcmp(mode, "use-after-free") == 0)
+        UseAfterFree();
+    else
+        DoubleFree();
+
+    // Allocator did not catch it; stop anyway so the state can be inspected
+    debuggee::StopForDebugger("corruption not detected");
+    return 0;
+}
@@ -0,0 +1,46 @@
+// Huge address space map: argv[1] separate mappings (default 50,000; stay
+// below vm.max_map_count, 65530 by default). Neighbouring mappings alternate
+// protections so the kernel cannot merge them, and every fourth one is backed
+// by a file, so region enumeration costs one entry per mapping.
+#include "debuggee_common.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+    long long count = debuggee::ArgOr(argc, argv, 1, 50000);
+
+    // Small file mapped repeatedly, so file-backed regions carry a path
+    char path[] = "/tmp/stress_mappings.XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || ftruncate(fd, 4096) != 0)
+    {
+        std::perror("mkstemp");
+        return 1;
+    }
+    unlink(path);
+
+    const long page = sysconf(_SC_PAGESIZE);
+    long long mapped = 0;
+    for (long long i = 0; i < count; i++)
+    {
+        int prot = i % 2 ? PROT_READ : PROT_READ | PROT_WRITE;
+        void* p = i % 4 == 3 ? mmap(nullptr, page, PROT_READ, MAP_PRIVATE, fd, 0)
+                             : mmap(nullptr, page, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            std::fprintf(stderr, "mmap failed after %lld mappings\n", i);
+            break;
+        }
+        if (prot & PROT_WRITE && i % 4 != 3)
+            static_cast<char*>(p)[0] = static_cast<char>(i);
+        mapped++;
+    }
+
+    char what[64];
+    std::snprintf(what, sizeof(what), "%lld mappings", mapped);
+    debuggee::StopForDebugger(what);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Deep mutual recursion A -> B -> A ... 100,000 (or argv[1]) levels deep on a
+// large thread stack, then a stop at the bottom. With argv[2] = "overflow" the
+// recursion is unbounded on the default stack and ends in a real stack
+// overflow (SIGSEGV at the guard page).
+#include "debuggee_common.hpp"
+
+#include <pthread.h>
+
+namespace
+{
+long long g_depth = 100000;
+bool g_overflow = false;
+
+__attribute__((noinline)) void RecurseB(long long level);
+
+__attribute__((noinline)) void RecurseA(long long level)
+{
+    volatile char pad[32];
+    pad[0] = static_cast<char>(level);
+    if (!g_overflow && level >= g_depth)
+        debuggee::StopForDebugger("recursion bottom");
+    else
+        RecurseB(level + 1);
+    pad[1] = pad[0];
+}
+
+__attribute__((noinline)) void RecurseB(long long level)
+{
+    volatile char pad[16];
+    pad[0] = static_cast<char>(level);
+    RecurseA(level + 1);
+    pad[1] = pad[0];
+}
+
+void* ThreadMain(void*)
+{
+    RecurseA(0);
+    return nullptr;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    g_depth = debuggee::ArgOr(argc, argv, 1, 100000);
+    g_overflow = std::strcmp(debuggee::StrArgOr(argc, argv, 2, ""), "overflow") == 0;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (!g_overflow)
+        pthread_attr_setstacksize(&attr, static_cast<size_t>(g_depth) * 256 + (1 << 20));
+
+    pthread_t thread;
+    pthread_create(&thread, &attr, ThreadMain, nullptr);
+    pthread_attr_destroy(&attr);
+    pthread_join(thread, nullptr);
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Huge STL containers with template-heavy types, scaled by argv[1] (default
+// 1,000,000 elements per container).
+#include "debuggee_common.hpp"
+
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+struct Record
+{
+    long long id;
+    std::string name;
+    std::vector<double> samples;
+    std::shared_ptr<Record> parent;
+};
+
+__attribute__((noinline)) void Inspect(
+    std::vector<int>& ints, std::map<std::string, Record>& by_name,
+    std::unordered_map<long long, std::vector<std::string>>& tags, std::list<Record>& records,
+    std::deque<std::pair<std::string, std::map<int, std::string>>>& nested)
+{
+    debuggee::StopForDebugger("containers populated");
+    std::printf("%zu %zu %zu %zu %zu\n", ints.size(), by_name.size(), tags.size(),
+                records.size(), nested.size());
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    long long n = debuggee::ArgOr(argc, argv, 1, 1000000);
+
+    std::vector<int> ints;
+    std::map<std::string, Record> by_name;
+    std::unordered_map<long long, std::vector<std::string>> tags;
+    std::list<Record> records;
+    std::deque<std::pair<std::string, std::map<int, std::string>>> nested;
+
+    auto root = std::make_shared<Record>(Record{0, "root", {1.0}, nullptr});
+    ints.reserve(static_cast<size_t>(n) * 10);
+    for (long long i = 0; i < n * 10; i++)
+        ints.push_back(static_cast<int>(i));
+    for (long long i = 0; i < n; i++)
+    {
+        std::string name = "record-" + std::to_string(i);
+        by_name.emplace(name, Record{i, name, {double(i), double(i) / 2}, root});
+        tags[i] = {"tag-a-" + std::to_string(i % 97), "tag-b-" + std::to_string(i % 13)};
+        records.push_back(Record{i, name, {}, nullptr});
+        if (i % 100 == 0)
+            nested.emplace_back(name, std::map<int, std::string>{{1, name}, {2, "x"}});
+    }
+
+    Inspect(ints, by_name, tags, records, nested);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// 5,000 (or argv[1]) threads parked on a condition variable, spread over a
+// handful of distinct call stacks.
+#include "debuggee_common.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::mutex g_mutex;
+std::condition_variable g_cv;
+bool g_release = false;
+std::atomic<long long> g_started{0};
+
+void Park()
+{
+    std::unique_lock<std::mutex> lock(g_mutex);
+    g_started++;
+    g_cv.notify_all();
+    g_cv.wait(lock, [] { return g_release; });
+}
+
+__attribute__((noinline)) void WorkerLeaf() { Park(); }
+__attribute__((noinline)) void WorkerMiddle(int variant)
+{
+    if (variant % 2)
+        WorkerLeaf();
+    else
+        Park();
+}
+__attribute__((noinline)) void WorkerTop(int variant) { WorkerMiddle(variant); }
+
+void* ThreadMain(void* arg)
+{
+    int variant = static_cast<int>(reinterpret_cast<intptr_t>(arg));
+    if (variant % 3 == 0)
+        WorkerTop(variant);
+    else
+        WorkerMiddle(variant);
+    return nullptr;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    long long count = debuggee::ArgOr(argc, argv, 1, 5000);
+
+    // Small stacks so thousands of threads fit in the default address space
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 64 * 1024);
+
+    std::vector<pthread_t> threads(static_cast<size_t>(count));
+    for (long long i = 0; i < count; i++)
+    {
+        if (pthread_create(&threads[i], &attr, ThreadMain,
+                           reinterpret_cast<void*>(static_cast<intptr_t>(i))) != 0)
+        {
+            std::fprintf(stderr, "pthread_create failed after %lld threads\n", i);
+            count = i;
+            break;
+        }
+    }
+    pthread_attr_destroy(&attr);
+
+    {
+        std::unique_lock<std::mutex> lock(g_mutex);
+        g_cv.wait(lock, [&] { return g_started.load() == count; });
+    }
+    debuggee::StopForDebugger("threads parked");
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_release = true;
+    }
+    g_cv.notify_all();
+    for (long long i = 0; i < count; i++)
+        pthread_join(threads[i], nullptr);
+    return 0;
+}
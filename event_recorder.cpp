@@ -0,0 +1,331 @@
+#include "event_recorder.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr uint32_t kWaitSeconds = 1;
+constexpr size_t kMaxModulesNamed = 3;
+
+const char* KindName(RecordedEvent::Kind kind)
+{
+    switch (kind)
+    {
+    case RecordedEvent::Kind::Process:
+        return "process";
+    case RecordedEvent::Kind::Stop:
+        return "stop";
+    case RecordedEvent::Kind::Signal:
+        return "signal";
+    case RecordedEvent::Kind::Breakpoint:
+        return "breakpoint";
+    case RecordedEvent::Kind::Thread:
+        return "thread";
+    case RecordedEvent::Kind::Module:
+        return "module";
+    }
+    return "?";
+}
+
+std::string Counts(const std::map<std::string, unsigned>& counts)
+{
+    std::string out;
+    for (const auto& [name, n] : counts)
+        out += (out.empty() ? "" : ", ") + name + " x" + std::to_string(n);
+    return out.empty() ? "none" : out;
+}
+} // namespace
+
+EventRecorder& GetEventRecorder()
+{
+    // Never destroyed: the recorder thread may outlive static destruction
+    static EventRecorder* recorder = new EventRecorder();
+    return *recorder;
+}
+
+void EventRecorder::Start(lldb::SBDebugger& debugger)
+{
+    if (started_)
+        return;
+    started_ = true;
+    start_ = std::chrono::steady_clock::now();
+
+    listener_.StartListeningForEventClass(debugger, lldb::SBProcess::GetBroadcasterClassName(),
+                                          lldb::SBProcess::eBroadcastBitStateChanged);
+    listener_.StartListeningForEventClass(debugger, lldb::SBTarget::GetBroadcasterClassName(),
+                                          lldb::SBTarget::eBroadcastBitBreakpointChanged |
+                                              lldb::SBTarget::eBroadcastBitModulesLoaded |
+                                              lldb::SBTarget::eBroadcastBitModulesUnloaded);
+    thread_ = std::thread([this]() { Run(); });
+    thread_.detach();
+}
+
+void EventRecorder::Run()
+{
+    while (true)
+    {
+        lldb::SBEvent event;
+        if (listener_.WaitForEvent(kWaitSeconds, event) && event.IsValid())
+            Handle(event);
+    }
+}
+
+void EventRecorder::Add(RecordedEvent::Kind kind, uint32_t stop_id, const std::string& text)
+{
+    RecordedEvent e;
+    e.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    e.stop_id = stop_id;
+    e.kind = kind;
+    e.text = text;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (events_.size() >= kMaxEvents)
+    {
+        events_.pop_front();
+        dropped_++;
+    }
+    events_.push_back(std::move(e));
+}
+
+void EventRecorder::Handle(lldb::SBEvent& event)
+{
+    if (lldb::SBProcess::EventIsProcessEvent(event))
+    {
+        lldb::SBProcess process = lldb::SBProcess::GetProcessFromEvent(event);
+        lldb::StateType state = lldb::SBProcess::GetStateFromEvent(event);
+        bool restarted = lldb::SBProcess::GetRestartedFromEvent(event);
+        if (state == lldb::eStateStopped)
+        {
+            RecordStop(process, restarted);
+        }
+        else if (state != lldb::eStateRunning && state != lldb::eStateStepping)
+        {
+            std::string text = lldb::SBDebugger::StateAsCString(state);
+            if (state == lldb::eStateExited)
+            {
+                text += " status " + std::to_string(process.GetExitStatus());
+                const char* desc = process.GetExitDescription();
+                if (desc && *desc)
+                    text += std::string(" (") + desc + ")";
+            }
+            else if (state == lldb::eStateLaunching || state == lldb::eStateAttaching)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                live_threads_.clear();
+            }
+            Add(RecordedEvent::Kind::Process, process.GetStopID(),
+                "pid " + std::to_string(process.GetProcessID()) + " " + text);
+        }
+        return;
+    }
+
+    if (lldb::SBBreakpoint::EventIsBreakpointEvent(event))
+    {
+        lldb::BreakpointEventType type = lldb::SBBreakpoint::GetBreakpointEventTypeFromEvent(event);
+        lldb::SBBreakpoint bp = lldb::SBBreakpoint::GetBreakpointFromEvent(event);
+        const char* what = type == lldb::eBreakpointEventTypeAdded     ? "added"
+                           : type == lldb::eBreakpointEventTypeRemoved ? "removed"
+                           : type == lldb::eBreakpointEventTypeEnabled ? "enabled"
+                           : type == lldb::eBreakpointEventTypeDisabled ? "disabled"
+                                                                        : nullptr;
+        if (what)
+        {
+            lldb::SBTarget target = lldb::SBTarget::GetTargetFromEvent(event);
+            Add(RecordedEvent::Kind::Breakpoint, target.GetProcess().GetStopID(),
+                "breakpoint " + std::to_string(bp.GetID()) + " " + what);
+        }
+        return;
+    }
+
+    if (lldb::SBTarget::EventIsTargetEvent(event))
+    {
+        uint32_t type = event.GetType();
+        bool loaded = type & lldb::SBTarget::eBroadcastBitModulesLoaded;
+        if (!loaded && !(type & lldb::SBTarget::eBroadcastBitModulesUnloaded))
+            return;
+        uint32_t n = lldb::SBTarget::GetNumModulesFromEvent(event);
+        std::string text = std::string(loaded ? "loaded " : "unloaded ") + std::to_string(n) +
+                           (n == 1 ? " module:" : " modules:");
+        for (uint32_t i = 0; i < n && i < kMaxModulesNamed; i++)
+        {
+            const char* name =
+                lldb::SBTarget::GetModuleAtIndexFromEvent(i, event).GetFileSpec().GetFilename();
+            text += std::string(" ") + (name ? name : "?");
+        }
+        if (n > kMaxModulesNamed)
+            text += " ...";
+        lldb::SBTarget target = lldb::SBTarget::GetTargetFromEvent(event);
+        Add(RecordedEvent::Kind::Module, target.GetProcess().GetStopID(), text);
+    }
+}
+
+void EventRecorder::RecordStop(lldb::SBProcess process, bool restarted)
+{
+    uint32_t stop_id = process.GetStopID();
+    std::set<uint64_t> live;
+    std::vector<std::pair<RecordedEvent::Kind, std::string>> entries;
+    lldb::SBUnixSignals signals = process.GetUnixSignals();
+
+    for (uint32_t i = 0; i < process.GetNumThreads(); i++)
+    {
+        lldb::SBThread thread = process.GetThreadAtIndex(i);
+        live.insert(thread.GetThreadID());
+        lldb::StopReason reason = thread.GetStopReason();
+        if (reason == lldb::eStopReasonNone || reason == lldb::eStopReasonInvalid)
+            continue;
+
+        char desc[128] = {};
+        thread.GetStopDescription(desc, sizeof(desc));
+        std::string where = "thread #" + std::to_string(thread.GetIndexID());
+        const char* fn = thread.GetFrameAtIndex(0).GetFunctionName();
+        if (fn)
+            where += std::string(" in ") + fn;
+
+        RecordedEvent::Kind kind = RecordedEvent::Kind::Stop;
+        std::string text = std::string(desc) + ", " + where;
+        if (reason == lldb::eStopReasonBreakpoint)
+        {
+            kind = RecordedEvent::Kind::Breakpoint;
+            std::string id = std::to_string(thread.GetStopReasonDataAtIndex(0));
+            std::lock_guard<std::mutex> lock(mutex_);
+            breakpoint_hits_[id]++;
+        }
+        else if (reason == lldb::eStopReasonSignal || reason == lldb::eStopReasonException)
+        {
+            kind = RecordedEvent::Kind::Signal;
+            const char* name =
+                reason == lldb::eStopReasonSignal && signals.IsValid()
+                    ? signals.GetSignalAsCString(
+                          static_cast<int32_t>(thread.GetStopReasonDataAtIndex(0)))
+                    : nullptr;
+            std::lock_guard<std::mutex> lock(mutex_);
+            signal_counts_[name ? name : desc]++;
+        }
+        if (restarted)
+            text += " (auto-continued)";
+        entries.emplace_back(kind, text);
+    }
+
+    // Threads that appeared or went away since the previous stop
+    std::vector<std::string> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stops_++;
+        if (!live_threads_.empty())
+        {
+            size_t appeared = 0;
+            size_t exited = 0;
+            for (uint64_t tid : live)
+                appeared += !live_threads_.count(tid);
+            for (uint64_t tid : live_threads_)
+                exited += !live.count(tid);
+            if (appeared || exited)
+                changes.push_back(std::to_string(appeared) + " thread(s) appeared, " +
+                                  std::to_string(exited) + " exited; " +
+                                  std::to_string(live.size()) + " live");
+            threads_seen_ += appeared;
+        }
+        else
+        {
+            threads_seen_ += live.size();
+        }
+        max_live_threads_ = std::max(max_live_threads_, live.size());
+        live_threads_ = std::move(live);
+    }
+
+    for (const auto& change : changes)
+        Add(RecordedEvent::Kind::Thread, stop_id, change);
+    if (entries.empty())
+        Add(RecordedEvent::Kind::Stop, stop_id, restarted ? "stopped (auto-continued)"
+                                                          : "stopped");
+    for (const auto& [kind, text] : entries)
+        Add(kind, stop_id, text);
+}
+
+std::string EventRecorder::History(const std::string& filter, size_t budget)
+{
+    // Parse "kind,kind,last:N"
+    std::set<std::string> kinds;
+    size_t last = 0;
+    std::stringstream ss(filter);
+    std::string part;
+    while (std::getline(ss, part, ','))
+    {
+        part.erase(0, part.find_first_not_of(' '));
+        part.erase(part.find_last_not_of(' ') + 1);
+        if (part.rfind("last:", 0) == 0)
+            last = static_cast<size_t>(std::strtoul(part.c_str() + 5, nullptr, 10));
+        else if (!part.empty() && part != "all")
+        {
+            // Accept plurals ("signals", "modules")
+            if (part.back() == 's' && part != "process")
+                part.pop_back();
+            kinds.insert(part);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_)
+        return "Error: event recorder not running";
+
+    char header[160];
+    std::snprintf(header, sizeof(header),
+                  "%zu events recorded (%zu older dropped); %u stops; threads seen: %zu, max %zu "
+                  "live\n",
+                  events_.size(), dropped_, stops_, threads_seen_, max_live_threads_);
+    std::string out = header;
+    out += "signals: " + Counts(signal_counts_) + "\n";
+    out += "breakpoint hits: " + Counts(breakpoint_hits_) + "\n";
+
+    std::vector<const RecordedEvent*> selected;
+    for (const auto& e : events_)
+        if (kinds.empty() || kinds.count(KindName(e.kind)))
+            selected.push_back(&e);
+    if (last && selected.size() > last)
+        selected.erase(selected.begin(), selected.end() - static_cast<long>(last));
+
+    // Lines newest last; identical consecutive events are collapsed, and when
+    // over budget the oldest lines are dropped
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < selected.size(); i++)
+    {
+        const RecordedEvent& e = *selected[i];
+        size_t repeat = 1;
+        while (i + 1 < selected.size() && selected[i + 1]->kind == e.kind &&
+               selected[i + 1]->text == e.text)
+        {
+            repeat++;
+            i++;
+        }
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "[%.3fs stop %u] %s: ", e.seconds, e.stop_id,
+                      KindName(e.kind));
+        std::string line = prefix + e.text;
+        if (repeat > 1)
+            line += " (x" + std::to_string(repeat) + ", until stop " +
+                    std::to_string(selected[i]->stop_id) + ")";
+        lines.push_back(std::move(line));
+    }
+
+    size_t first = 0;
+    size_t size = out.size();
+    for (const auto& line : lines)
+        size += line.size() + 1;
+    while (size > budget && first < lines.size())
+        size -= lines[first++].size() + 1;
+    if (first > 0)
+        out += "(" + std::to_string(first) + " older lines omitted)\n";
+    for (size_t i = first; i < lines.size(); i++)
+        out += lines[i] + "\n";
+    return out;
+}
+
+} // namespace lldb_copilot
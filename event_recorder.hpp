@@ -0,0 +1,76 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <lldb/API/LLDB.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace lldb_copilot
+{
+
+// One recorded debugger event
+struct RecordedEvent
+{
+    enum class Kind
+    {
+        Process,    // State changes (launched, running, exited, ...)
+        Stop,       // Process stopped (one entry per thread with a stop reason)
+        Signal,     // Stop reason is a signal or exception
+        Breakpoint, // Breakpoint hit, added or removed
+        Thread,     // Thread appeared or exited between stops
+        Module,     // Shared libraries loaded or unloaded
+    };
+
+    double seconds = 0; // Since the recorder started
+    uint32_t stop_id = 0;
+    Kind kind = Kind::Process;
+    std::string text;
+};
+
+// Records process, thread, breakpoint and module events in a bounded ring
+// through its own SBListener (events are broadcast to every listener, so the
+// debugger's own event handling is unaffected). Runs a background thread.
+class EventRecorder
+{
+  public:
+    void Start(lldb::SBDebugger& debugger);
+
+    // Events matching filter, oldest first, with a summary header.
+    // filter: "" (all) or kinds ("signal,breakpoint"), optionally "last:N"
+    std::string History(const std::string& filter, size_t budget = kToolResultBudget);
+
+  private:
+    void Run();
+    void Handle(lldb::SBEvent& event);
+    void RecordStop(lldb::SBProcess process, bool restarted);
+    void Add(RecordedEvent::Kind kind, uint32_t stop_id, const std::string& text);
+
+    static constexpr size_t kMaxEvents = 4096;
+
+    lldb::SBListener listener_{"lldb_copilot.event_recorder"};
+    std::thread thread_;
+    std::chrono::steady_clock::time_point start_;
+    bool started_ = false;
+
+    std::mutex mutex_;
+    std::deque<RecordedEvent> events_;
+    size_t dropped_ = 0;
+    std::map<std::string, unsigned> signal_counts_;
+    std::map<std::string, unsigned> breakpoint_hits_;
+    unsigned stops_ = 0;
+    std::set<uint64_t> live_threads_; // Thread IDs at the previous stop
+    size_t threads_seen_ = 0;
+    size_t max_live_threads_ = 0;
+};
+
+// Global recorder, started when the plugin loads
+EventRecorder& GetEventRecorder();
+
+} // namespace lldb_copilot
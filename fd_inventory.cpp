@@ -0,0 +1,403 @@
+#include "fd_inventory.hpp"
+#include "procfs.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr double kLimitWarning = 0.8;  // Warn above this fraction of RLIMIT_NOFILE
+constexpr size_t kLeakCount = 1000;    // Warn when one type has this many descriptors
+constexpr uint64_t kUnreadBytes = 64 * 1024;
+constexpr uint64_t kWriteOnly = 01;
+constexpr uint64_t kReadWrite = 02;
+
+struct Descriptor
+{
+    int fd = -1;
+    std::string type;  // "tcp", "unix", "pipe", "file", "eventfd", ...
+    std::string group; // Alike descriptors share this description
+    std::string detail;
+    const SocketInfo* socket = nullptr;
+    bool deleted = false;
+};
+
+uint64_t BracketInode(const std::string& target)
+{
+    size_t open = target.find('[');
+    return open == std::string::npos ? 0 : std::strtoull(target.c_str() + open + 1, nullptr, 10);
+}
+
+const char* AccessMode(uint64_t flags)
+{
+    switch (flags & 03)
+    {
+    case 0:
+        return "r";
+    case kWriteOnly:
+        return "w";
+    case kReadWrite:
+        return "rw";
+    }
+    return "?";
+}
+
+Descriptor Classify(const FdEntry& entry,
+                    const std::unordered_map<uint64_t, const SocketInfo*>& sockets)
+{
+    Descriptor d;
+    d.fd = entry.fd;
+    const std::string& target = entry.target;
+    if (target.rfind("socket:[", 0) == 0)
+    {
+        uint64_t inode = BracketInode(target);
+        auto it = sockets.find(inode);
+        if (it == sockets.end())
+        {
+            d.type = "socket";
+            d.group = "socket (netlink/packet/other)";
+            d.detail = target;
+            return d;
+        }
+        const SocketInfo& s = *it->second;
+        d.socket = &s;
+        d.type = s.proto;
+        if (d.type == "tcp6")
+            d.type = "tcp";
+        else if (d.type == "udp6")
+            d.type = "udp";
+        else if (d.type.rfind("unix", 0) == 0)
+            d.type = "unix";
+        bool listening = std::strcmp(s.state, "LISTEN") == 0;
+        if (d.type == "unix")
+            d.group = std::string(s.proto) + " " + s.local + " " + s.state;
+        else if (listening)
+            d.group = std::string(s.proto) + " " + s.local + " LISTEN";
+        else
+            d.group = std::string(s.proto) + " -> " + s.remote + " " + s.state;
+        d.detail = target;
+        if (!listening && d.type == "tcp")
+            d.detail += " " + s.local;
+        return d;
+    }
+    if (target.rfind("pipe:[", 0) == 0)
+    {
+        d.type = "pipe";
+        d.group = std::string("pipe ") + ((entry.flags & 03) == kWriteOnly ? "write" : "read") +
+                  " end";
+        d.detail = target;
+        return d;
+    }
+    if (target.rfind("anon_inode:", 0) == 0)
+    {
+        std::string kind = target.substr(11);
+        kind.erase(std::remove(kind.begin(), kind.end(), '['), kind.end());
+        kind.erase(std::remove(kind.begin(), kind.end(), ']'), kind.end());
+        d.type = kind == "eventpoll" ? "epoll" : kind;
+        d.group = d.type;
+        return d;
+    }
+    if (target.rfind("/dev/", 0) == 0)
+    {
+        d.type = "device";
+        d.group = target + " (" + AccessMode(entry.flags) + ")";
+        return d;
+    }
+    if (!target.empty() && target[0] == '/')
+    {
+        d.type = "file";
+        d.deleted = target.size() > 10 && target.compare(target.size() - 10, 10, " (deleted)") == 0;
+        d.group = target + " (" + AccessMode(entry.flags) + ")";
+        d.detail = "pos " + std::to_string(entry.pos);
+        return d;
+    }
+    d.type = "other";
+    d.group = target;
+    return d;
+}
+
+// "3-5,9" for sorted fds (or thread IDs)
+template <class Id> std::string Ranges(const std::vector<Id>& ids, size_t max_ranges = 12)
+{
+    std::string out;
+    size_t ranges = 0;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        size_t j = i;
+        while (j + 1 < ids.size() && ids[j + 1] == ids[j] + 1)
+            j++;
+        if (++ranges > max_ranges)
+            return out + ",...";
+        out += (out.empty() ? "" : ",") + std::to_string(ids[i]);
+        if (j > i)
+            out += "-" + std::to_string(ids[j]);
+        i = j;
+    }
+    return out;
+}
+
+// Lines under a heading, each checked against the output budget
+void AppendList(std::string& out, const std::string& heading,
+                const std::vector<std::string>& lines, size_t budget)
+{
+    if (lines.empty())
+        return;
+    out += heading + ":\n";
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        if (out.size() + lines[i].size() + 5 > budget)
+        {
+            out += "  (truncated: " + std::to_string(lines.size() - i) + " more)\n";
+            return;
+        }
+        out += "  " + lines[i] + "\n";
+    }
+}
+
+// System calls whose first argument is a file descriptor
+bool TakesFd(const char* name)
+{
+    static const char* const kCalls[] = {
+        "read",     "write",   "readv",   "writev",      "pread64",     "pwrite64",
+        "recvfrom", "recvmsg", "sendto",  "sendmsg",     "accept",      "accept4",
+        "connect",  "fsync",   "ioctl",   "epoll_wait",  "epoll_pwait", "epoll_pwait2",
+    };
+    for (const char* call : kCalls)
+        if (name && std::strcmp(name, call) == 0)
+            return true;
+    return false;
+}
+} // namespace
+
+std::string CollectFileDescriptors(lldb::SBDebugger& debugger, const std::string& filter,
+                                   size_t budget)
+{
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+    uint64_t pid = LocalProcfsPid(process);
+    if (!pid)
+        return "Error: descriptor inventory needs a live process on this Linux host (not a core "
+               "or remote target)";
+
+    std::vector<FdEntry> fds;
+    if (!ListFds(pid, fds))
+        return "Error: cannot read /proc/" + std::to_string(pid) + "/fd";
+
+    std::vector<uint64_t> inodes;
+    for (const auto& entry : fds)
+        if (entry.target.rfind("socket:[", 0) == 0)
+            inodes.push_back(BracketInode(entry.target));
+    std::sort(inodes.begin(), inodes.end());
+    std::vector<std::pair<uint64_t, SocketInfo>> socket_list;
+    ReadSockets(pid, inodes, socket_list);
+    std::unordered_map<uint64_t, const SocketInfo*> sockets;
+    for (const auto& [inode, info] : socket_list)
+        sockets.emplace(inode, &info);
+
+    std::vector<Descriptor> descriptors;
+    for (const auto& entry : fds)
+        descriptors.push_back(Classify(entry, sockets));
+
+    // Counts by type, and by state for sockets
+    std::map<std::string, size_t> types;
+    std::map<std::string, std::map<std::string, size_t>> states;
+    for (const auto& d : descriptors)
+    {
+        types[d.type]++;
+        if (d.socket && d.type != "unix")
+            states[d.type][d.socket->state]++;
+    }
+
+    char line[256];
+    uint64_t limit = OpenFileLimit(pid);
+    std::snprintf(line, sizeof(line), "pid %" PRIu64 ": %zu open descriptors", pid, fds.size());
+    std::string out = line;
+    if (limit)
+        out += " (limit " + std::to_string(limit) + ")";
+    out += "\nby type:";
+    for (const auto& [type, count] : types)
+    {
+        out += " " + type + " " + std::to_string(count);
+        auto it = states.find(type);
+        if (it == states.end())
+            continue;
+        std::string detail;
+        for (const auto& [state, n] : it->second)
+            detail += (detail.empty() ? "" : ", ") + std::string(state) + " " + std::to_string(n);
+        out += " (" + detail + ")";
+    }
+    out += "\n";
+
+    // Anomalies
+    std::vector<std::string> anomalies;
+    if (limit && fds.size() >= limit * kLimitWarning)
+        anomalies.push_back("descriptor count at " + std::to_string(fds.size() * 100 / limit) +
+                            "% of the open-file limit; new open/accept calls will fail with "
+                            "EMFILE");
+    // Per-socket findings are grouped by protocol, with the worst one named
+    struct Stalled
+    {
+        std::vector<int> fds;
+        const Descriptor* worst = nullptr;
+    };
+    std::vector<int> close_wait;
+    std::vector<int> deleted;
+    std::map<std::string, Stalled> backlog; // Listening sockets with pending connections
+    std::map<std::string, Stalled> unread;  // Sockets with unread data
+    for (const auto& d : descriptors)
+    {
+        if (d.deleted)
+            deleted.push_back(d.fd);
+        if (!d.socket)
+            continue;
+        if (std::strcmp(d.socket->state, "CLOSE_WAIT") == 0)
+            close_wait.push_back(d.fd);
+        Stalled* stalled = nullptr;
+        if (std::strcmp(d.socket->state, "LISTEN") == 0 && d.socket->rx_queue > 0)
+            stalled = &backlog[d.socket->proto];
+        else if (d.socket->rx_queue >= kUnreadBytes)
+            stalled = &unread[d.socket->proto];
+        if (!stalled)
+            continue;
+        stalled->fds.push_back(d.fd);
+        if (!stalled->worst || d.socket->rx_queue > stalled->worst->socket->rx_queue)
+            stalled->worst = &d;
+    }
+    for (const auto& [proto, s] : backlog)
+        anomalies.push_back(
+            std::to_string(s.fds.size()) + " listening " + proto + " socket(s) with "
+            "connections waiting to be accepted, fds " + Ranges(s.fds) + "; most at " +
+            s.worst->socket->local + " (fd " + std::to_string(s.worst->fd) + "): " +
+            std::to_string(s.worst->socket->rx_queue));
+    for (const auto& [proto, s] : unread)
+        anomalies.push_back(
+            std::to_string(s.fds.size()) + " " + proto + " socket(s) with at least " +
+            std::to_string(kUnreadBytes / 1024) + " KB unread (reader stalled?), fds " +
+            Ranges(s.fds) + "; most on fd " + std::to_string(s.worst->fd) + ": " +
+            std::to_string(s.worst->socket->rx_queue) + " bytes");
+    if (!close_wait.empty())
+        anomalies.push_back(std::to_string(close_wait.size()) +
+                            " TCP sockets in CLOSE_WAIT (peer closed, the process never closed "
+                            "them: leak or stuck reader), fds " + Ranges(close_wait));
+    if (!deleted.empty())
+        anomalies.push_back(std::to_string(deleted.size()) +
+                            " deleted files still open (disk space not released), fds " +
+                            Ranges(deleted));
+    for (const auto& [type, count] : types)
+        if (count >= kLeakCount)
+            anomalies.push_back(std::to_string(count) + " " + type +
+                                " descriptors (possible leak)");
+    for (auto& a : anomalies)
+        a = "- " + a;
+    AppendList(out, "anomalies", anomalies, budget);
+
+    // Threads blocked in a call on one of these descriptors
+    std::unordered_map<uint64_t, uint32_t> index_ids;
+    if (process.GetState() == lldb::eStateStopped)
+        for (uint32_t i = 0; i < process.GetNumThreads(); i++)
+        {
+            lldb::SBThread thread = process.GetThreadAtIndex(i);
+            index_ids.emplace(thread.GetThreadID(), thread.GetIndexID());
+        }
+    std::unordered_map<int, const Descriptor*> by_fd;
+    for (const auto& d : descriptors)
+        by_fd.emplace(d.fd, &d);
+    // Threads in the same call on the same descriptor form one line
+    struct Blocked
+    {
+        std::vector<uint64_t> tids;
+        std::vector<uint32_t> index_ids;
+    };
+    std::vector<uint64_t> tids;
+    ListTasks(pid, tids);
+    std::sort(tids.begin(), tids.end());
+    std::vector<std::string> call_order;
+    std::map<std::string, Blocked> blocked;
+    for (uint64_t tid : tids)
+    {
+        TaskSyscall call;
+        if (!ReadTaskSyscall(pid, tid, call) || call.kind != TaskSyscall::Kind::Syscall)
+            continue;
+        const char* name = SyscallName(call.nr);
+        if (!TakesFd(name))
+            continue;
+        int fd = static_cast<int>(call.args[0]);
+        auto it = by_fd.find(fd);
+        std::string key = std::string(name) + "(fd " + std::to_string(fd) +
+                          "): " + (it == by_fd.end() ? "?" : it->second->group);
+        Blocked& b = blocked[key];
+        if (b.tids.empty())
+            call_order.push_back(key);
+        b.tids.push_back(tid);
+        auto idx = index_ids.find(tid);
+        if (idx != index_ids.end())
+            b.index_ids.push_back(idx->second);
+    }
+    std::stable_sort(call_order.begin(), call_order.end(),
+                     [&](const std::string& a, const std::string& b)
+                     { return blocked[a].tids.size() > blocked[b].tids.size(); });
+    std::vector<std::string> blocked_lines;
+    for (const auto& key : call_order)
+    {
+        Blocked& b = blocked[key];
+        std::sort(b.index_ids.begin(), b.index_ids.end());
+        std::string threads =
+            std::to_string(b.tids.size()) + (b.tids.size() == 1 ? " thread" : " threads");
+        blocked_lines.push_back(key + "  " + threads + ", tid " + Ranges(b.tids) +
+                                (b.index_ids.empty() ? "" : " (#" + Ranges(b.index_ids) + ")"));
+    }
+    AppendList(out, "threads blocked on descriptors", blocked_lines, budget);
+
+    // Alike descriptors as fd ranges, in fd order of their first member
+    int only_fd = -1;
+    if (!filter.empty() && std::all_of(filter.begin(), filter.end(), ::isdigit))
+        only_fd = std::atoi(filter.c_str());
+    std::vector<std::string> order;
+    std::map<std::string, std::vector<const Descriptor*>> groups;
+    for (const auto& d : descriptors)
+    {
+        if (only_fd >= 0 ? d.fd != only_fd : !filter.empty() && d.type != filter)
+            continue;
+        auto& members = groups[d.group];
+        if (members.empty())
+            order.push_back(d.group);
+        members.push_back(&d);
+    }
+    out += "descriptors" + (filter.empty() ? std::string() : " (" + filter + ")") + ":\n";
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const auto& members = groups[order[i]];
+        std::vector<int> group_fds;
+        for (const auto* d : members)
+            group_fds.push_back(d->fd);
+        std::string entry = "  " + Ranges(group_fds) + "  " + order[i];
+        if (members.size() > 1)
+            entry += " (x" + std::to_string(members.size()) + ")";
+        else if (!members[0]->detail.empty())
+            entry += "  [" + members[0]->detail + "]";
+        if (members.size() == 1 && members[0]->socket && members[0]->socket->rx_queue)
+            entry += " rx " + std::to_string(members[0]->socket->rx_queue);
+        entry += "\n";
+        if (out.size() + entry.size() > budget)
+        {
+            out += "(truncated: " + std::to_string(order.size() - i) + " more groups)\n";
+            break;
+        }
+        out += entry;
+    }
+    if (order.empty())
+        out += "  (none match)\n";
+    return out;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Open file descriptors of a local Linux process from /proc/<pid>/fd and
+// fdinfo, with sockets resolved against /proc/<pid>/net/{tcp,udp,unix}:
+// counts by type, anomalies (CLOSE_WAIT leaks, accept backlogs, unread data,
+// deleted files, nearness to the open-file limit), threads blocked on a
+// descriptor, and alike descriptors grouped into fd ranges.
+// filter: "" (all), a type ("tcp", "udp", "unix", "pipe", "file", ...) or an fd
+std::string CollectFileDescriptors(lldb::SBDebugger& debugger, const std::string& filter,
+                                   size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
@@ -0,0 +1,276 @@
+#include "hang_detector.hpp"
+#include "stack_sampler.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <unordered_map>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr int kDefaultSamples = 5;
+constexpr int kMaxSamples = 50;
+constexpr int kDefaultIntervalMs = 500;
+constexpr int kMaxIntervalMs = 10000;
+constexpr uint32_t kMaxFrames = 64;
+constexpr size_t kShownFrames = 8;
+constexpr size_t kShownThreads = 6;
+constexpr double kSpinningPercent = 50.0;
+
+// System calls a healthy idle thread waits in
+bool IsIdleCall(const char* name)
+{
+    static const char* const kCalls[] = {
+        "epoll_wait",      "epoll_pwait",    "epoll_pwait2", "poll",    "ppoll",
+        "select",          "pselect6",       "accept",       "accept4", "nanosleep",
+        "clock_nanosleep", "wait4",          "waitid",       "pause",   "rt_sigtimedwait",
+        "io_getevents",    "io_uring_enter", "recvfrom",     "recvmsg", "read",
+    };
+    for (const char* call : kCalls)
+        if (name && std::string(name) == call)
+            return true;
+    return false;
+}
+
+bool AnyFrameContains(const ThreadSample& thread, const char* text)
+{
+    for (const auto& frame : thread.frames)
+        if (frame.function.find(text) != std::string::npos)
+            return true;
+    return false;
+}
+
+// How one thread that never moved spends its time
+struct Diagnosis
+{
+    std::string kernel;  // "blocked in futex(0x...)", "on CPU", ...
+    std::string meaning; // Short interpretation
+    double cpu_ms = 0;
+};
+
+Diagnosis Diagnose(const std::vector<const ThreadSample*>& history, bool local, double span_ms)
+{
+    Diagnosis d;
+    const ThreadSample& last = *history.back();
+    if (!local || !last.kernel_known)
+    {
+        d.kernel = "kernel state unknown (not a local process)";
+        d.meaning = "stack frozen";
+        return d;
+    }
+
+    double ticks = static_cast<double>(ClockTicksPerSecond());
+    d.cpu_ms = (last.cpu_ticks - history.front()->cpu_ticks) * 1000.0 / ticks;
+
+    // Same system call in every sample
+    bool same_call = true;
+    for (const ThreadSample* s : history)
+        same_call = same_call && s->call.kind == TaskSyscall::Kind::Syscall &&
+                    s->call.nr == last.call.nr;
+    if (span_ms > 0 && 100.0 * d.cpu_ms / span_ms >= kSpinningPercent)
+    {
+        d.kernel = "on CPU";
+        d.meaning = "spinning in place (busy loop or livelock)";
+    }
+    else if (same_call)
+    {
+        const char* name = SyscallName(last.call.nr);
+        char buf[96];
+        std::snprintf(buf, sizeof(buf), "%s in %s(0x%" PRIx64 ")",
+                      last.state == 'D' ? "uninterruptible" : "blocked",
+                      name ? name : ("syscall " + std::to_string(last.call.nr)).c_str(),
+                      last.call.args[0]);
+        d.kernel = buf;
+        if (last.state == 'D')
+            d.meaning = "stuck in the kernel (I/O, file system, device)";
+        else if (AnyFrameContains(last, "cond_wait") || AnyFrameContains(last, "cond_timedwait"))
+            d.meaning = "waiting on a condition variable";
+        else if (AnyFrameContains(last, "mutex_lock") || AnyFrameContains(last, "lll_lock") ||
+                 AnyFrameContains(last, "rwlock") || AnyFrameContains(last, "mutex::lock"))
+            d.meaning = "waiting for a lock that never became free";
+        else if (IsIdleCall(name))
+            d.meaning = "waiting for I/O or events (idle)";
+        else
+            d.meaning = "blocked in the kernel";
+    }
+    else
+    {
+        d.kernel = last.state == 'D' ? "uninterruptible, not in a system call" : "in user space";
+        d.meaning = "stack frozen without a blocking call";
+    }
+    return d;
+}
+
+std::string FrameLine(const std::vector<SampledFrame>& frames)
+{
+    std::string out;
+    for (size_t i = 0; i < frames.size() && i < kShownFrames; i++)
+    {
+        out += (i ? " <- " : "") + frames[i].function;
+        if (!frames[i].location.empty())
+            out += " (" + frames[i].location + ")";
+    }
+    if (frames.size() > kShownFrames)
+        out += " <- ... (" + std::to_string(frames.size()) + " frames)";
+    return out;
+}
+
+struct Group
+{
+    std::vector<const ThreadSample*> threads; // Latest sample of each
+    Diagnosis diagnosis;
+};
+} // namespace
+
+std::string DetectHang(lldb::SBDebugger& debugger, int samples, int interval_ms, size_t budget)
+{
+    int n = samples == 0 ? kDefaultSamples : std::clamp(samples, 2, kMaxSamples);
+    int interval = interval_ms <= 0 ? kDefaultIntervalMs : std::min(interval_ms, kMaxIntervalMs);
+
+    SampleRun run;
+    std::string error;
+    if (!SampleStacks(debugger, n, interval, kMaxFrames, run, error))
+        return "Error: " + error;
+
+    // Each thread's samples, in order; threads missing from any sample came
+    // or went during the run
+    std::map<uint64_t, std::vector<const ThreadSample*>> history;
+    for (const auto& sample : run.samples)
+        for (const auto& thread : sample.threads)
+            history[thread.tid].push_back(&thread);
+
+    double span_ms = run.samples.back().ms - run.samples.front().ms;
+    std::map<std::string, Group> frozen;
+    std::vector<std::pair<const ThreadSample*, size_t>> moving; // Latest sample, distinct stacks
+    size_t transient = 0;
+    for (const auto& [tid, list] : history)
+    {
+        if (list.size() != run.samples.size())
+        {
+            transient++;
+            continue;
+        }
+        std::vector<std::vector<uint64_t>> stacks;
+        for (const ThreadSample* s : list)
+        {
+            std::vector<uint64_t> pcs;
+            for (const auto& frame : s->frames)
+                pcs.push_back(frame.pc);
+            if (std::find(stacks.begin(), stacks.end(), pcs) == stacks.end())
+                stacks.push_back(std::move(pcs));
+        }
+        if (stacks.size() > 1 || run.samples.size() < 2)
+        {
+            moving.emplace_back(list.back(), stacks.size());
+            continue;
+        }
+        Diagnosis d = Diagnose(list, run.local, span_ms);
+        std::string key = d.kernel.substr(0, d.kernel.find('(')) + "|" +
+                          FrameLine(list.back()->frames);
+        Group& group = frozen[key];
+        group.threads.push_back(list.back());
+        group.diagnosis = d;
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%zu samples over %.0f ms; process stopped %.1f ms in total for unwinding "
+                  "(longest %.1f ms)\n",
+                  run.samples.size(), run.elapsed_ms, run.stopped_ms, run.longest_stop_ms);
+    std::string out = line;
+    if (!run.note.empty())
+        out += "note: " + run.note + "\n";
+    size_t frozen_count = 0;
+    for (const auto& [key, group] : frozen)
+        frozen_count += group.threads.size();
+    std::snprintf(line, sizeof(line),
+                  "%zu threads: %zu never moved, %zu made progress, %zu came or went\n",
+                  history.size(), frozen_count, moving.size(), transient);
+    out += line;
+    if (run.samples.size() < 2)
+        out += "(one sample only: nothing to compare)\n";
+
+    // Verdict from the frozen groups
+    std::map<std::string, size_t> meanings;
+    for (const auto& [key, group] : frozen)
+        meanings[group.diagnosis.meaning] += group.threads.size();
+    size_t stuck = 0;
+    for (const auto& [meaning, count] : meanings)
+        if (meaning.find("idle") == std::string::npos &&
+            meaning.find("condition variable") == std::string::npos)
+            stuck += count;
+    if (frozen_count == 0)
+        out += "verdict: every thread made progress; slow, not hung\n";
+    else if (stuck == 0)
+        out += "verdict: only idle threads are frozen (waiting for work); not hung unless "
+               "work is pending\n";
+    else
+    {
+        out += "verdict:";
+        for (const auto& [meaning, count] : meanings)
+            out += " " + std::to_string(count) + " " + meaning + ";";
+        out.back() = '\n';
+    }
+
+    // Frozen groups, the most suspicious (non-idle, largest) first
+    std::vector<const Group*> groups;
+    for (const auto& [key, group] : frozen)
+        groups.push_back(&group);
+    std::sort(groups.begin(), groups.end(),
+              [](const Group* a, const Group* b)
+              {
+                  bool a_idle = a->diagnosis.meaning.find("idle") != std::string::npos;
+                  bool b_idle = b->diagnosis.meaning.find("idle") != std::string::npos;
+                  if (a_idle != b_idle)
+                      return b_idle;
+                  return a->threads.size() > b->threads.size();
+              });
+    std::string body;
+    if (!groups.empty())
+        body += "never moved (grouped by stack):\n";
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        const Group& group = *groups[i];
+        std::string tids;
+        for (size_t t = 0; t < group.threads.size() && t < kShownThreads; t++)
+            tids += (t ? ", " : "") + std::to_string(group.threads[t]->tid) + " #" +
+                    std::to_string(group.threads[t]->index_id);
+        if (group.threads.size() > kShownThreads)
+            tids += ", ...";
+        std::snprintf(line, sizeof(line), "  [%zu] %s | %s | %s, %.0f ms CPU\n",
+                      group.threads.size(), tids.c_str(), group.diagnosis.meaning.c_str(),
+                      group.diagnosis.kernel.c_str(), group.diagnosis.cpu_ms);
+        std::string entry = line;
+        entry += "      " + FrameLine(group.threads.front()->frames) + "\n";
+        if (out.size() + body.size() + entry.size() > budget)
+        {
+            body += "(truncated: " + std::to_string(groups.size() - i) + " more groups)\n";
+            break;
+        }
+        body += entry;
+    }
+    if (!moving.empty())
+    {
+        std::string progressing = "progressing:";
+        for (size_t i = 0; i < moving.size(); i++)
+        {
+            std::snprintf(line, sizeof(line), " %" PRIu64 " #%u (%zu stacks)%s",
+                          moving[i].first->tid, moving[i].first->index_id, moving[i].second,
+                          i + 1 < moving.size() ? "," : "");
+            if (out.size() + body.size() + progressing.size() + 40 > budget)
+            {
+                progressing += " ...";
+                break;
+            }
+            progressing += line;
+        }
+        body += progressing + "\n";
+    }
+    return out + body;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Tells a hang from slowness: samples every thread's stack several times
+// while the process runs (see SampleStacks) and reports the threads whose
+// stack never changed, grouped by stack, with whether they are blocked in the
+// kernel (local Linux processes), spinning or waiting in user space.
+// samples: 0 = 5 (2..50); interval_ms: 0 = 500 (max 10000)
+std::string DetectHang(lldb::SBDebugger& debugger, int samples, int interval_ms,
+                       size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
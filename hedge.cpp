@@ -0,0 +1,188 @@
+#include "hedge.hpp"
+#include "process_control.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr auto kPollInterval = std::chrono::milliseconds(20);
+
+using Clock = std::chrono::steady_clock;
+
+// A query running on its own thread with its own host context
+struct Racer
+{
+    libagents::HostContext host;
+    std::thread thread;
+    std::atomic<bool> done{false};
+    std::atomic<bool> active{false}; // Produced any event
+    std::atomic<bool> cancel{false};
+    std::mutex mutex;
+    bool live = true; // Forward events as they arrive instead of buffering
+    std::vector<libagents::Event> buffered;
+    std::string response;
+    std::exception_ptr error;
+    NameCompactor* names = nullptr;
+    std::atomic<bool>* lost = nullptr;
+
+    void Start(const HedgeRequest& request, libagents::HostContext& parent)
+    {
+        names = request.names;
+        if (names)
+            names->Checkpoint();
+        lost = request.lost;
+        if (lost)
+            *lost = false;
+        host.should_abort = [this, &parent]()
+        { return cancel.load() || (parent.should_abort && parent.should_abort()); };
+        host.on_event = [this, &parent](const libagents::Event& event)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active = true;
+            if (live && parent.on_event)
+                parent.on_event(event);
+            else
+                buffered.push_back(event);
+        };
+        thread = std::thread(
+            [this, request]()
+            {
+                try
+                {
+                    response = request.agent->query_hosted(request.prompt, host);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                done = true;
+            });
+    }
+
+    void Buffer()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        live = false;
+    }
+
+    void Stop()
+    {
+        cancel = true;
+        if (thread.joinable())
+            thread.join();
+    }
+};
+
+// Cancelled losers still winding down
+std::mutex g_losers_mutex;
+std::vector<std::thread> g_losers;
+} // namespace
+
+void ReapHedgeLosers()
+{
+    std::vector<std::thread> losers;
+    {
+        std::lock_guard<std::mutex> lock(g_losers_mutex);
+        losers.swap(g_losers);
+    }
+    for (auto& loser : losers)
+        loser.join();
+}
+
+std::string QueryHedged(const HedgeRequest& primary,
+                        const std::function<HedgeRequest()>& start_hedge,
+                        libagents::HostContext& host, std::chrono::milliseconds delay,
+                        HedgeStats& stats, bool* hedge_won)
+{
+    if (hedge_won)
+        *hedge_won = false;
+    ReapHedgeLosers();
+    stats.queries++;
+    auto start = Clock::now();
+
+    auto first = std::make_unique<Racer>();
+    first->Start(primary, host);
+
+    std::unique_ptr<Racer> second;
+    bool hedge_tried = false;
+    Racer* winner = nullptr;
+    while (!winner)
+    {
+        std::this_thread::sleep_for(kPollInterval);
+
+        if (first->done && (!first->error || !second))
+            winner = first.get();
+        else if (second && second->done && (!second->error || first->done))
+            winner = second->error ? first.get() : second.get();
+        if (winner)
+            break;
+
+        if (!hedge_tried && !first->active && Clock::now() - start >= delay)
+        {
+            hedge_tried = true;
+            HedgeRequest hedge = start_hedge();
+            if (hedge.agent)
+            {
+                first->Buffer();
+                second = std::make_unique<Racer>();
+                second->live = false;
+                second->Start(hedge, host);
+                stats.hedged++;
+            }
+        }
+    }
+
+    // Deliver the winner's buffered events first; the loser is cancelled and
+    // joined in the background, and results it compacted are forgotten
+    winner->Stop();
+    if (host.on_event)
+        for (const auto& event : winner->buffered)
+            host.on_event(event);
+    double latency = MsSince(start);
+
+    std::unique_ptr<Racer>& loser = winner == first.get() ? second : first;
+    if (loser)
+    {
+        loser->cancel = true;
+        if (loser->lost)
+            *loser->lost = true;
+        std::lock_guard<std::mutex> lock(g_losers_mutex);
+        g_losers.emplace_back(
+            [racer = std::move(loser)]()
+            {
+                racer->Stop();
+                if (racer->names)
+                    racer->names->Rollback();
+            });
+    }
+
+    if (second)
+    {
+        stats.hedged_ms += latency;
+        if (winner == second.get())
+        {
+            stats.hedge_wins++;
+            stats.win_ms += latency;
+            if (hedge_won)
+                *hedge_won = true;
+        }
+    }
+    else
+    {
+        stats.plain_ms += latency;
+    }
+
+    if (winner->error)
+        std::rethrow_exception(winner->error);
+    return winner->response;
+}
+
+} // namespace lldb_copilot
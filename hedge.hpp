@@ -0,0 +1,54 @@
+#pragma once
+
+#include "name_compactor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <libagents/agent.hpp>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Latency counters for hedged queries (shown by "agent stats")
+struct HedgeStats
+{
+    unsigned queries = 0;    // Queries sent while hedging was enabled
+    unsigned hedged = 0;     // Second provider was asked as well
+    unsigned hedge_wins = 0; // Second provider answered first
+    double plain_ms = 0;     // Total latency of queries that were not hedged
+    double hedged_ms = 0;    // Total latency of hedged queries
+    double win_ms = 0;       // Total latency of queries the hedge won (primary still pending)
+
+    double HedgeRate() const { return queries ? static_cast<double>(hedged) / queries : 0.0; }
+};
+
+// One side of a hedged query
+struct HedgeRequest
+{
+    libagents::IAgent* agent = nullptr;
+    std::string prompt;
+    NameCompactor* names = nullptr;    // The agent's alias dictionary, rolled back if it loses
+    std::atomic<bool>* lost = nullptr; // Set if it loses; its tools then refuse to run
+};
+
+// Runs primary.prompt and, if the primary has produced no event (first
+// token or tool call) after delay, also the hedge returned by start_hedge
+// (called on demand; may return an empty request to skip hedging). The first
+// to complete wins and is delivered at once: the other is cancelled through
+// its should_abort and lost flag and reaped in the background, its buffered
+// events are discarded and its alias dictionary is rolled back. Events of the
+// primary stream live until a hedge starts; from then on both sides are
+// buffered and the winner's events are replayed through host.on_event. Throws
+// the primary's error if both fail.
+std::string QueryHedged(const HedgeRequest& primary,
+                        const std::function<HedgeRequest()>& start_hedge,
+                        libagents::HostContext& host, std::chrono::milliseconds delay,
+                        HedgeStats& stats, bool* hedge_won = nullptr);
+
+// Wait until cancelled losers of earlier races have finished. Call before
+// querying, clearing or shutting down an agent that may have lost a race.
+void ReapHedgeLosers();
+
+} // namespace lldb_copilot
@@ -0,0 +1,300 @@
+#include "investigation.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+#if LLDB_COPILOT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace lldb_copilot
+{
+
+using json = nlohmann::json;
+
+namespace
+{
+constexpr const char* kBundleFormat = "lldb-copilot-bundle";
+constexpr int kBundleVersion = 2; // 2: result_cache holds tool_calls indexes
+constexpr size_t kMaxLogBytes = 64 * 1024 * 1024; // Tool output kept for export
+
+bool IsGzip(const std::string& data)
+{
+    return data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0x1f &&
+           static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+bool WriteFile(const std::string& path, const std::string& data, std::string* error)
+{
+#if LLDB_COPILOT_HAVE_ZLIB
+    gzFile file = gzopen(path.c_str(), "wb9");
+    if (!file)
+    {
+        *error = "cannot open " + path + " for writing";
+        return false;
+    }
+    bool ok = gzwrite(file, data.data(), static_cast<unsigned>(data.size())) ==
+              static_cast<int>(data.size());
+    ok = gzclose(file) == Z_OK && ok;
+#else
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        *error = "cannot open " + path + " for writing";
+        return false;
+    }
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    bool ok = static_cast<bool>(file);
+#endif
+    if (!ok)
+        *error = "failed writing " + path;
+    return ok;
+}
+
+bool ReadFile(const std::string& path, std::string* data, std::string* error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        *error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    *data = ss.str();
+    if (!IsGzip(*data))
+        return true;
+
+#if LLDB_COPILOT_HAVE_ZLIB
+    gzFile gz = gzopen(path.c_str(), "rb");
+    if (!gz)
+    {
+        *error = "cannot open " + path;
+        return false;
+    }
+    std::string out;
+    char buf[64 * 1024];
+    int n = 0;
+    while ((n = gzread(gz, buf, sizeof(buf))) > 0)
+        out.append(buf, static_cast<size_t>(n));
+    gzclose(gz);
+    if (n < 0)
+    {
+        *error = "corrupt compressed bundle " + path;
+        return false;
+    }
+    *data = std::move(out);
+    return true;
+#else
+    *error = path + " is compressed, but this build has no zlib support";
+    return false;
+#endif
+}
+
+std::string IsoTime()
+{
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return buf;
+}
+} // namespace
+
+void InvestigationLog::AddExchange(const std::string& question, const std::string& answer)
+{
+    exchanges.push_back({question, answer});
+}
+
+void InvestigationLog::AddToolCall(const std::string& call,
+                                   std::shared_ptr<const std::string> output,
+                                   const std::string& stop)
+{
+    if (output_bytes + output->size() > kMaxLogBytes)
+    {
+        static const auto kNotRecorded = std::make_shared<const std::string>(
+            "(output not recorded: bundle size limit reached)");
+        truncated = true;
+        calls.push_back({call, kNotRecorded, stop});
+        return;
+    }
+    output_bytes += output->size();
+    calls.push_back({call, std::move(output), stop});
+}
+
+void InvestigationLog::Clear()
+{
+    *this = InvestigationLog();
+}
+
+std::string StopFingerprint(lldb::SBDebugger& debugger)
+{
+    json fp;
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    if (!target.IsValid())
+        return fp.dump();
+
+    lldb::SBModule exe = target.GetModuleAtIndex(0);
+    const char* exe_name = exe.GetFileSpec().GetFilename();
+    const char* uuid = exe.GetUUIDString();
+    fp["executable"] = exe_name ? exe_name : "";
+    fp["uuid"] = uuid ? uuid : "";
+
+    lldb::SBProcess process = target.GetProcess();
+    if (process.IsValid())
+    {
+        fp["pid"] = process.GetProcessID();
+        fp["stop_id"] = process.GetStopID();
+        fp["state"] = lldb::SBDebugger::StateAsCString(process.GetState());
+        json threads = json::array();
+        for (uint32_t i = 0; i < process.GetNumThreads(); i++)
+        {
+            lldb::SBThread thread = process.GetThreadAtIndex(i);
+            char reason[128] = {};
+            thread.GetStopDescription(reason, sizeof(reason));
+            threads.push_back({{"id", thread.GetIndexID()},
+                               {"tid", thread.GetThreadID()},
+                               {"pc", thread.GetFrameAtIndex(0).GetPC()},
+                               {"stop", reason}});
+        }
+        fp["threads"] = std::move(threads);
+    }
+
+    // Hash of the stop state, independent of pid and stop ID, so that the
+    // same crash loaded from a core elsewhere has the same fingerprint
+    json stable = fp;
+    stable.erase("pid");
+    stable.erase("stop_id");
+    if (stable.contains("threads"))
+        for (auto& t : stable["threads"])
+            t.erase("tid");
+    // FNV-1a: std::hash differs between standard libraries and builds
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : stable.dump())
+        h = (h ^ c) * 0x100000001b3ULL;
+    char hash[20];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, h);
+    fp["hash"] = hash;
+    return fp.dump();
+}
+
+std::string FingerprintHash(const std::string& fingerprint)
+{
+    json fp = json::parse(fingerprint, nullptr, false);
+    if (!fp.is_object() || !fp.contains("hash") || !fp["hash"].is_string())
+        return "";
+    return fp["hash"].get<std::string>();
+}
+
+bool ExportBundle(const std::string& path, const InvestigationLog& log,
+                  const std::string& fingerprint, const std::string& target,
+                  const std::string& provider, std::string* error)
+{
+    json bundle;
+    bundle["format"] = kBundleFormat;
+    bundle["version"] = kBundleVersion;
+    bundle["created"] = IsoTime();
+    bundle["target"] = target;
+    bundle["provider"] = provider;
+    bundle["fingerprint"] = json::parse(fingerprint, nullptr, false);
+    if (log.truncated)
+        bundle["truncated"] = true;
+
+    json exchanges = json::array();
+    for (const auto& e : log.exchanges)
+        exchanges.push_back({{"question", e.question}, {"answer", e.answer}});
+    bundle["transcript"] = std::move(exchanges);
+
+    // Every call in order, and per call the index of its latest output
+    json calls = json::array();
+    json cache = json::object();
+    for (const auto& c : log.calls)
+    {
+        cache[c.call] = calls.size();
+        calls.push_back({{"call", c.call}, {"stop", c.stop}, {"output", *c.output}});
+    }
+    bundle["tool_calls"] = std::move(calls);
+    bundle["result_cache"] = std::move(cache);
+
+    // Invalid UTF-8 in command output is replaced rather than thrown on
+    return WriteFile(path, bundle.dump(-1, ' ', false, json::error_handler_t::replace), error);
+}
+
+bool ImportBundle(const std::string& path, ImportedBundle* bundle, std::string* error)
+{
+    std::string data;
+    if (!ReadFile(path, &data, error))
+        return false;
+
+    json j = json::parse(data, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || !j.contains("format") ||
+        j["format"] != kBundleFormat)
+    {
+        *error = path + " is not an investigation bundle";
+        return false;
+    }
+
+    // Hand-edited or truncated bundles: wrong types are reported, not thrown
+    try
+    {
+        int version = j.value("version", 0);
+        if (version > kBundleVersion)
+        {
+            *error = "bundle version " + std::to_string(version) + " is newer than this "
+                     "plugin supports";
+            return false;
+        }
+
+        ImportedBundle loaded;
+        loaded.path = path;
+        loaded.target = j.value("target", "");
+        loaded.fingerprint = j.contains("fingerprint") ? j["fingerprint"].dump() : "{}";
+        loaded.hash = FingerprintHash(loaded.fingerprint);
+        if (j.contains("transcript"))
+            for (const auto& e : j["transcript"])
+            {
+                // Entries that are not {question, answer} strings are skipped
+                if (!e.is_object())
+                    continue;
+                auto q = e.find("question");
+                auto a = e.find("answer");
+                if (q != e.end() && q->is_string() && (a == e.end() || a->is_string()))
+                    loaded.exchanges.push_back({*q, a == e.end() ? "" : a->get<std::string>()});
+            }
+        // Outputs are parsed once and shared by the calls that refer to them
+        std::vector<std::shared_ptr<const std::string>> outputs;
+        if (version >= 2 && j.contains("tool_calls") && j["tool_calls"].is_array())
+            for (const auto& c : j["tool_calls"])
+            {
+                auto output = c.find("output");
+                outputs.push_back(output != c.end() && output->is_string()
+                                      ? std::make_shared<const std::string>(
+                                            output->get<std::string>())
+                                      : nullptr);
+            }
+        if (j.contains("result_cache"))
+            for (const auto& [call, entry] : j["result_cache"].items())
+            {
+                if (entry.is_number_unsigned() && entry.get<size_t>() < outputs.size() &&
+                    outputs[entry.get<size_t>()])
+                    loaded.results[call] = outputs[entry.get<size_t>()];
+                else if (entry.is_string()) // Version 1
+                    loaded.results[call] =
+                        std::make_shared<const std::string>(entry.get<std::string>());
+            }
+
+        *bundle = std::move(loaded);
+        return true;
+    }
+    catch (const json::exception& e)
+    {
+        *error = path + " is a malformed investigation bundle: " + e.what();
+        return false;
+    }
+}
+
+} // namespace lldb_copilot
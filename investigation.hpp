@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <lldb/API/LLDB.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Everything an investigation produced, for "agent export"
+struct InvestigationLog
+{
+    struct Exchange
+    {
+        std::string question;
+        std::string answer;
+    };
+
+    struct ToolCall
+    {
+        std::string call;                           // e.g. "bt" or "dbg_stack_locals 0 0-7 1"
+        std::shared_ptr<const std::string> output; // Raw tool output, shared with the replay cache
+        std::string stop;                           // StopKey at the time of the call
+    };
+
+    std::vector<Exchange> exchanges;
+    std::vector<ToolCall> calls;
+    size_t output_bytes = 0;
+    bool truncated = false; // Output recording stopped at kMaxLogBytes
+
+    void AddExchange(const std::string& question, const std::string& answer);
+    void AddToolCall(const std::string& call, std::shared_ptr<const std::string> output,
+                     const std::string& stop);
+    void Clear();
+};
+
+// Tool results loaded by "agent import": answered when no live process exists
+struct ImportedBundle
+{
+    std::string path;
+    std::string target;
+    std::string fingerprint; // Stop-state fingerprint of the exporting session (JSON)
+    std::string hash;        // Its hash, "" if it has none
+    std::vector<InvestigationLog::Exchange> exchanges;
+    std::unordered_map<std::string, std::shared_ptr<const std::string>> results; // Latest output
+
+    bool Empty() const { return results.empty() && exchanges.empty(); }
+};
+
+// JSON description of the current stop: target, executable UUID, process,
+// stop ID and every thread's stop reason and PC, plus a short hash of it
+std::string StopFingerprint(lldb::SBDebugger& debugger);
+
+// The hash of a StopFingerprint; equal hashes mean the same stop state, even
+// from another process or a core of it. "" if the fingerprint has none.
+std::string FingerprintHash(const std::string& fingerprint);
+
+// Write log as a single bundle file (gzip-compressed when built with zlib).
+// Each output is stored once, in tool_calls; result_cache maps every call to
+// the index of its latest output there.
+bool ExportBundle(const std::string& path, const InvestigationLog& log,
+                  const std::string& fingerprint, const std::string& target,
+                  const std::string& provider, std::string* error);
+
+// Read a bundle written by ExportBundle (compressed or not). Version 1
+// bundles, whose result_cache holds the outputs themselves, are read too.
+bool ImportBundle(const std::string& path, ImportedBundle* bundle, std::string* error);
+
+} // namespace lldb_copilot
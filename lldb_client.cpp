@@ -1,5 +1,7 @@
 #include "lldb_client.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 
 namespace lldb_copilot
@@ -17,28 +19,52 @@ constexpr const char* CYAN = "\033[36m";
 constexpr const char* DIM = "\033[2m";
 } // namespace colors
 
+OutputStats& GetOutputStats()
+{
+    static OutputStats stats;
+    return stats;
+}
+
 LldbClient::LldbClient(lldb::SBDebugger& debugger)
     : debugger_(debugger), interp_(debugger.GetCommandInterpreter())
 {
 }
 
-std::string LldbClient::ExecuteCommand(const std::string& command)
+std::string LldbClient::ExecuteCommand(const std::string& command, bool* succeeded)
 {
     OutputCommand(command);
 
     lldb::SBCommandReturnObject result;
     interp_.HandleCommand(command.c_str(), result);
-
+    if (succeeded)
+        *succeeded = result.Succeeded();
+
+    // Copy output and error straight into one exactly-sized buffer; this is
+    // the only copy on the way to the model (echo and return use it in place).
+    auto start = std::chrono::steady_clock::now();
+    const size_t out_size = result.GetOutputSize();
+    const size_t err_size = result.GetErrorSize();
     std::string output;
-    if (result.GetOutputSize() > 0)
-        output = result.GetOutput();
-    if (result.GetErrorSize() > 0)
+    output.reserve(out_size + err_size + 1);
+    if (out_size > 0)
+        output.append(result.GetOutput(), out_size);
+    if (err_size > 0)
     {
         if (!output.empty())
-            output += "\n";
-        output += result.GetError();
+            output += '\n';
+        output.append(result.GetError(), err_size);
     }
 
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    OutputStats& stats = GetOutputStats();
+    stats.commands++;
+    stats.total_bytes += output.size();
+    stats.peak_bytes = std::max<uint64_t>(stats.peak_bytes, output.size());
+    stats.assemble_us += elapsed;
+    stats.peak_assemble_us = std::max<uint64_t>(stats.peak_assemble_us, elapsed);
+
     if (output.empty())
         output = "(No output)";
     else
@@ -47,6 +73,16 @@ std::string LldbClient::ExecuteCommand(const std::string& command)
     return output;
 }
 
+ValidationResult LldbClient::ValidateCommand(const std::string& command)
+{
+    return CommandValidator(interp_).Validate(command);
+}
+
+bool LldbClient::IsReadOnlyCommand(const std::string& command)
+{
+    return CommandValidator(interp_).IsReadOnly(command);
+}
+
 void LldbClient::Output(const std::string& message)
 {
     printf("%s", message.c_str());
@@ -71,9 +107,13 @@ void LldbClient::OutputCommand(const std::string& command)
     fflush(stdout);
 }
 
-void LldbClient::OutputCommandResult(const std::string& result)
+void LldbClient::OutputCommandResult(std::string_view result)
 {
-    printf("%s%s%s\n", colors::DIM, result.c_str(), colors::RESET);
+    // fwrite avoids printf's format pass over multi-megabyte results
+    fputs(colors::DIM, stdout);
+    fwrite(result.data(), 1, result.size(), stdout);
+    fputs(colors::RESET, stdout);
+    fputc('\n', stdout);
     fflush(stdout);
 }
 
@@ -89,6 +129,12 @@ void LldbClient::OutputResponse(const std::string& response)
     fflush(stdout);
 }
 
+void LldbClient::OutputVerdict(const std::string& verdict)
+{
+    printf("%s[triage] %s%s\n", colors::YELLOW, verdict.c_str(), colors::RESET);
+    fflush(stdout);
+}
+
 bool LldbClient::SupportsColor() const
 {
     // Assume terminal supports color (could check isatty)
@@ -113,8 +159,8 @@ std::string LldbClient::GetTargetName() const
 
 bool LldbClient::IsInterrupted() const
 {
-    // TODO: Check for Ctrl+C via signal handler or async interrupt
-    return false;
+    // Raised by Ctrl+C while a command (such as "copilot") is executing
+    return interp_.WasInterrupted();
 }
 
 } // namespace lldb_copilot
@@ -1,11 +1,28 @@
 #pragma once
 
+#include "command_validator.hpp"
+
+#include <cstdint>
 #include <lldb/API/LLDB.h>
 #include <string>
+#include <string_view>
 
 namespace lldb_copilot
 {
 
+// Size and assembly cost of command outputs handed to the model
+struct OutputStats
+{
+    unsigned commands = 0;
+    uint64_t total_bytes = 0;
+    uint64_t peak_bytes = 0;       // Largest single output buffer
+    uint64_t assemble_us = 0;      // Time spent copying output into the result
+    uint64_t peak_assemble_us = 0; // Slowest single assembly
+};
+
+// Process-wide command output statistics
+OutputStats& GetOutputStats();
+
 // LLDB debugger client using the SB API
 class LldbClient
 {
@@ -14,7 +31,14 @@ class LldbClient
     ~LldbClient() = default;
 
     // Execute LLDB command and return output
-    std::string ExecuteCommand(const std::string& command);
+    // If succeeded is non-null, it receives whether LLDB reported success
+    std::string ExecuteCommand(const std::string& command, bool* succeeded = nullptr);
+
+    // Validate a command line without executing it
+    ValidationResult ValidateCommand(const std::string& command);
+
+    // Whether a command line only reads state (see CommandValidator::IsReadOnly)
+    bool IsReadOnlyCommand(const std::string& command);
 
     // Output methods for displaying messages to the user
     void Output(const std::string& message);
@@ -23,13 +47,17 @@ class LldbClient
 
     // Styled output for agent interactions
     void OutputCommand(const std::string& command);
-    void OutputCommandResult(const std::string& result);
+    void OutputCommandResult(std::string_view result);
     void OutputThinking(const std::string& message);
     void OutputResponse(const std::string& response);
+    void OutputVerdict(const std::string& verdict); // Local crash pre-classification
 
     // Query capabilities
     bool SupportsColor() const;
 
+    // Underlying debugger, for native tools that use the SB API directly
+    lldb::SBDebugger& GetDebugger() const { return debugger_; }
+
     // Get target info (executable path)
     std::string GetTargetName() const;
 
@@ -1,23 +1,61 @@
+#include "core_diff.hpp"
+#include "core_triage.hpp"
+#include "crash_classifier.hpp"
+#include "event_recorder.hpp"
+#include "fd_inventory.hpp"
+#include "hang_detector.hpp"
+#include "hedge.hpp"
+#include "investigation.hpp"
 #include "lldb_client.hpp"
+#include "lock_profiler.hpp"
+#include "memory_growth.hpp"
+#include "memory_scan.hpp"
+#include "name_compactor.hpp"
+#include "native_tools.hpp"
+#include "process_control.hpp"
+#include "procfs.hpp"
+#include "progress.hpp"
+#include "retry.hpp"
 #include "session_store.hpp"
 #include "settings.hpp"
 #include "system_prompt.hpp"
+#include "thread_states.hpp"
+#include "watch.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <libagents/agent.hpp>
 #include <libagents/provider.hpp>
 #include <libagents/tool_builder.hpp>
 #include <lldb/API/SBCommandInterpreter.h>
 #include <lldb/API/SBCommandReturnObject.h>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 namespace lldb_copilot
 {
 
 namespace
 {
+// Tool state of one agent's conversation. Each conversation has its own alias
+// dictionary. A hedge loser's tools refuse to run once it is cancelled, and
+// while a hedge races, results are held back until the race is decided so
+// that only the winner's reach the investigation log.
+struct AgentTools
+{
+    NameCompactor names;
+    std::atomic<bool> lost{false}; // Lost a hedge race
+    bool holding = false;          // Racing; held and holding are guarded by tools_mutex
+    std::vector<InvestigationLog::ToolCall> held;
+};
+
 struct AgentSession
 {
     std::unique_ptr<libagents::IAgent> agent;
@@ -32,8 +70,126 @@ struct AgentSession
     std::atomic<bool> aborted{false};
     LldbClient* dbg = nullptr;
     libagents::HostContext host;
+
+    // dbg_exec pre-validation
+    ValidationStats validation;
+    std::string last_rejected; // Resending this verbatim bypasses validation
+
+    // Stop already run through the local crash pre-classifier (see StopKey)
+    std::string triaged_stop;
+
+    // C++ name shortening for tool results; aliases live as long as the
+    // conversation, so each agent's conversation has its own dictionary
+    AgentTools tools;
+    bool aliases_stale = false; // Resumed conversation may hold aliases from before
+
+    // Hedging: second provider raced against the first when it stays silent
+    std::unique_ptr<libagents::IAgent> hedge_agent;
+    std::string hedge_provider;
+    AgentTools hedge_tools;
+    std::mutex tools_mutex; // Serializes tools while two agents run at once
+    std::deque<std::pair<std::string, std::string>> transcript; // Recent Q/A, hedge context
+    HedgeStats hedge;
+
+    // Provider error recovery
+    ToolReplayCache replay; // Tool results of the current question
+    RetryStats retry;
+    std::unique_ptr<libagents::IAgent> failover_agent;
+    std::string failover;
+    AgentTools failover_tools;
+
+    // Investigation record for "agent export", and a bundle loaded by
+    // "agent import" whose results answer tool calls when there is no process
+    // or the process is at the bundle's stop (same fingerprint hash).
+    // Both survive provider switches; "agent clear" drops the record.
+    InvestigationLog log;
+    ImportedBundle imported;
+    std::string imported_stop;     // StopKey imported_matches was checked at
+    bool imported_matches = false; // The process is at the imported bundle's stop
+    bool import_context_pending = false; // Next prompt carries the imported transcript
+
+    // Core note facts from "agent triage", passed along with the next question
+    std::string core_notes;
 };
 
+constexpr size_t kImportListedCalls = 40;
+
+// Stop budget dbg_exec needs left to stop a running process in low-intrusion
+// mode; unlike native tools an LLDB command cannot be cut off at the deadline
+constexpr double kExecReserveMs = 50;
+
+constexpr size_t kTranscriptExchanges = 4;
+constexpr size_t kTranscriptAnswerChars = 2000;
+
+// Create a target for a core in the background, so symbols load while the
+// user reads the note triage. It becomes the selected target unless the user
+// selected another one in the meantime. An interrupt seen between the steps
+// (symbols, core, crashing frame) drops the half-loaded target.
+void LoadCoreInBackground(lldb::SBDebugger debugger, std::string core, std::string exe)
+{
+    lldb::SBTarget previous = debugger.GetSelectedTarget();
+    std::thread(
+        [debugger, previous, core, exe]() mutable
+        {
+            LldbClient client(debugger);
+            OperationProgress progress(debugger, "Loading core " + core, 3);
+            auto start = std::chrono::steady_clock::now();
+            lldb::SBError error;
+            lldb::SBTarget target = debugger.CreateTarget(exe.c_str(), nullptr, nullptr, true,
+                                                          error);
+            if (!target.IsValid())
+                target = debugger.CreateTarget("");
+
+            // CreateTarget selects the new target; keep the user's selection
+            // until the core is ready
+            if (previous.IsValid() && debugger.GetSelectedTarget() == target)
+                debugger.SetSelectedTarget(previous);
+
+            auto interrupted = [&]()
+            {
+                if (!progress.Cancelled())
+                    return false;
+                client.OutputWarning("[triage] Loading " + core + " interrupted");
+                debugger.DeleteTarget(target);
+                return true;
+            };
+            if (!progress.Increment(1, "symbols loaded") && interrupted())
+                return;
+
+            lldb::SBProcess process = target.LoadCore(core.c_str(), error);
+            if (interrupted())
+                return;
+            if (!process.IsValid())
+            {
+                client.OutputWarning(std::string("[triage] Loading ") + core + " failed: " +
+                                     (error.GetCString() ? error.GetCString()
+                                                         : "unknown error"));
+                debugger.DeleteTarget(target);
+                return;
+            }
+
+            // Resolve the crashing frame now rather than on the first question
+            if (!progress.Increment(1, "core loaded") && interrupted())
+                return;
+            process.GetSelectedThread().GetFrameAtIndex(0).GetFunctionName();
+            if (!progress.Increment(1, "crashing frame resolved") && interrupted())
+                return;
+            lldb::SBTarget selected = debugger.GetSelectedTarget();
+            bool unchanged = previous.IsValid() ? selected == previous : selected == target;
+            if (unchanged)
+                debugger.SetSelectedTarget(target);
+            double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            char buf[160];
+            std::snprintf(buf, sizeof(buf),
+                          "[triage] Core loaded with symbols as target %u in %.1f s%s",
+                          debugger.GetIndexOfTarget(target), seconds,
+                          unchanged ? "" : " (not selected: another target was selected)");
+            client.OutputThinking(buf);
+        })
+        .detach();
+}
+
 AgentSession& GetAgentSession()
 {
     static AgentSession session;
@@ -42,6 +198,7 @@ AgentSession& GetAgentSession()
 
 void ResetAgentSession(AgentSession& session)
 {
+    ReapHedgeLosers();
     if (session.agent)
     {
         session.agent->shutdown();
@@ -54,15 +211,164 @@ void ResetAgentSession(AgentSession& session)
     session.system_prompt.clear();
     session.primed = false;
     session.target.clear();
+    session.triaged_stop.clear();
+    session.tools.names.Reset();
+    session.aliases_stale = false;
+    session.hedge_tools.names.Reset();
+    session.failover_tools.names.Reset();
+    if (session.hedge_agent)
+    {
+        session.hedge_agent->shutdown();
+        session.hedge_agent.reset();
+    }
+    session.hedge_provider.clear();
+    session.transcript.clear();
+    if (session.failover_agent)
+    {
+        session.failover_agent->shutdown();
+        session.failover_agent.reset();
+    }
+    session.failover.clear();
+    session.replay.Clear();
+    GetResumableOperations().Clear();
+}
+
+// Whether a tool needs the process stopped. In low-intrusion mode a running
+// process is stopped around calls that do, against the question's stop budget.
+enum class ToolAccess
+{
+    Stopped,
+    Live,        // Reads /proc or a memory snapshot; works while the process runs
+    LiveIfLocal, // Procfs-backed: live on a local process, through LLDB otherwise
+};
+
+// Whether the process is at the stop the imported bundle was exported at,
+// compared by fingerprint hash once per stop
+bool ImportedStopMatches(AgentSession& session, lldb::SBDebugger& debugger)
+{
+    std::string stop = StopKey(debugger);
+    if (stop != session.imported_stop)
+    {
+        session.imported_stop = stop;
+        session.imported_matches = !session.imported.hash.empty() &&
+                                   FingerprintHash(StopFingerprint(debugger)) ==
+                                       session.imported.hash;
+    }
+    return session.imported_matches;
 }
 
-libagents::Tool BuildDebuggerTool(AgentSession& session)
+// Run a tool call, or replay its result when a retried query repeats a call
+// made before the provider failed. Results are compacted on the way out, so
+// the cache holds raw output.
+std::string RunTool(AgentSession& session, AgentTools& tools, const std::string& call,
+                    const std::function<std::string()>& run,
+                    ToolAccess access = ToolAccess::Stopped)
+{
+    NameCompactor& names = tools.names;
+    bool replays = &tools != &session.hedge_tools; // A failed hedge is dropped, not retried
+    lldb::SBDebugger& debugger = session.dbg->GetDebugger();
+    std::string before = StopKey(debugger);
+    if (const std::string* cached = replays ? session.replay.Next(call, before) : nullptr)
+    {
+        session.retry.cache_hits++;
+        session.dbg->OutputCommand(call + "  (cached)");
+        return names.Compact(*cached);
+    }
+
+    // Imported results stand in for a missing process, or for a process at the
+    // same stop; calls the bundle lacks then run live
+    bool has_process = debugger.GetSelectedTarget().GetProcess().IsValid();
+    if (!session.imported.Empty() &&
+        (!has_process || ImportedStopMatches(session, debugger)))
+    {
+        auto it = session.imported.results.find(call);
+        if (it != session.imported.results.end())
+        {
+            session.dbg->OutputCommand(call + "  (imported)");
+            return names.Compact(*it->second);
+        }
+    }
+    if (!session.imported.Empty() && !has_process)
+    {
+        session.dbg->OutputCommand(call + "  (imported)");
+
+        std::string error = "Error: no live process, and this call is not in the imported "
+                            "bundle. Calls with cached results:\n";
+        size_t listed = 0;
+        for (const auto& [cached_call, output] : session.imported.results)
+        {
+            if (listed++ == kImportListedCalls)
+            {
+                error += "  ...\n";
+                break;
+            }
+            error += "  " + cached_call + "\n";
+        }
+        return error;
+    }
+
+    std::string result;
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (access == ToolAccess::LiveIfLocal)
+        access = LocalProcfsPid(process) ? ToolAccess::Live : ToolAccess::Stopped;
+    StopBudget& stops = GetStopBudget();
+    if (access == ToolAccess::Stopped && stops.active() && IsRunning(process))
+    {
+        StopBurst burst(debugger, process, stops);
+        if (!burst.ok())
+        {
+            burst.Resume(); // Waits for a late stop and resumes it
+            if (!burst.own_stop().empty())
+                return "Error: " + burst.error() + "; the process then stopped by itself and "
+                       "was left stopped: " + burst.own_stop();
+            return "Error: " + burst.error() + ". The process is left running (low-intrusion "
+                   "mode); dbg_thread_states, dbg_memory_map, dbg_fds and dbg_memory_scan work "
+                   "without stopping it.";
+        }
+        {
+            // Native tools give up when the budget runs out, as if cancelled
+            OperationDeadline deadline(burst.deadline());
+            result = run();
+            if (OperationDeadline::Passed())
+                result += "\n(the stop budget ran out during this call; the result may be partial)";
+        }
+        char note[160];
+        std::snprintf(note, sizeof(note),
+                      "\n(process stopped %.1f ms for this call; %.0f of %.0f ms stop budget "
+                      "left)",
+                      burst.Resume(), stops.remaining_ms(), stops.cap_ms());
+        result += burst.own_stop().empty()
+                      ? std::string(note)
+                      : "\n(the process stopped by itself and was left stopped: " +
+                            burst.own_stop() + ")";
+    }
+    else
+    {
+        result = run();
+    }
+    // One buffer serves the replay cache, the log and compaction
+    auto output = std::make_shared<const std::string>(std::move(result));
+    std::string after = StopKey(debugger);
+    if (replays)
+        session.replay.Record(call, output, before, after);
+    if (tools.holding)
+        tools.held.push_back({call, output, after});
+    else
+        session.log.AddToolCall(call, output, after);
+    return names.Compact(*output);
+}
+
+// Tool body shared by every tool: refuses once the agent was aborted or has no
+// debugger client and serializes calls on tools_mutex before running handler.
+// A hedge loser is refused under the lock, so it runs nothing once cancelled.
+template <typename... Args, typename Handler>
+libagents::Tool MakeTool(AgentSession& session, AgentTools& tools, std::string name,
+                         std::string description, std::vector<std::string> params,
+                         Handler handler)
 {
     return libagents::make_tool(
-        "dbg_exec",
-        "Execute an LLDB debugger command and return its output. "
-        "Use this to inspect the target process, memory, threads, stack, registers, etc.",
-        [&session](std::string command) -> std::string
+        std::move(name), std::move(description),
+        [&session, &tools, handler](Args... args) -> std::string
         {
             if (session.aborted.load())
                 return "(Aborted)";
@@ -70,9 +376,315 @@ libagents::Tool BuildDebuggerTool(AgentSession& session)
             if (!session.dbg)
                 return "Error: No debugger client available";
 
-            return session.dbg->ExecuteCommand(command);
+            std::lock_guard<std::mutex> lock(session.tools_mutex);
+            if (tools.lost.load())
+                return "(Aborted)";
+            return handler(args...);
         },
-        {"command"});
+        std::move(params));
+}
+
+// Native tool: describe renders the call (echoed and used as the cache key),
+// collect produces the raw result; both take the tool's arguments
+template <typename... Args, typename Describe, typename Collect>
+libagents::Tool MakeNativeTool(AgentSession& session, AgentTools& tools, std::string name,
+                               std::string description, std::vector<std::string> params,
+                               ToolAccess access, Describe describe, Collect collect)
+{
+    return MakeTool<Args...>(
+        session, tools, std::move(name), std::move(description), std::move(params),
+        [&session, &tools, access, describe, collect](const Args&... args)
+        {
+            std::string call = describe(args...);
+            return RunTool(session, tools, call,
+                           [&]()
+                           {
+                               session.dbg->OutputCommand(call);
+                               return collect(args...);
+                           },
+                           access);
+        });
+}
+
+libagents::Tool BuildDebuggerTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeTool<std::string>(
+        session, tools, "dbg_exec",
+        "Execute an LLDB debugger command and return its output. "
+        "Use this to inspect the target process, memory, threads, stack, registers, etc.",
+        {"command"},
+        [&session, &tools](const std::string& command) -> std::string
+        {
+            StopBudget& stops = GetStopBudget();
+            lldb::SBProcess process =
+                session.dbg->GetDebugger().GetSelectedTarget().GetProcess();
+            if (stops.active() && IsRunning(process))
+            {
+                if (!session.dbg->IsReadOnlyCommand(command))
+                {
+                    stops.Refuse();
+                    return "Error: in low-intrusion mode dbg_exec runs only read-only commands "
+                           "(backtraces, variables, registers, memory, image lookup, "
+                           "disassemble, lists) while the process is running; resuming, "
+                           "stepping and expressions are refused.";
+                }
+                if (stops.remaining_ms() < kExecReserveMs)
+                {
+                    stops.Refuse();
+                    return "Error: stop budget too low for dbg_exec (" + stops.Summary() +
+                           "); use dbg_thread_states, dbg_memory_map, dbg_fds or "
+                           "dbg_memory_scan, which do not stop the process.";
+                }
+            }
+
+            if (command == session.last_rejected)
+            {
+                session.validation.overridden++;
+            }
+            else
+            {
+                ValidationResult check = session.dbg->ValidateCommand(command);
+                session.validation.checked++;
+                if (!check.ok)
+                {
+                    session.validation.rejected++;
+                    session.last_rejected = command;
+                    session.dbg->OutputCommand(command);
+                    session.dbg->OutputWarning("Rejected: " + check.error);
+                    return check.Format() +
+                           "\n(Not executed. Resend the identical command to run it anyway.)";
+                }
+                if (!session.last_rejected.empty())
+                    session.validation.recovered++;
+            }
+            session.last_rejected.clear();
+
+            return RunTool(session, tools, command,
+                           [&]()
+                           {
+                               bool succeeded = true;
+                               std::string output =
+                                   session.dbg->ExecuteCommand(command, &succeeded);
+                               if (!succeeded)
+                                   session.validation.failed++;
+                               return output;
+                           });
+        });
+}
+
+libagents::Tool BuildStackLocalsTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<int, std::string, int>(
+        session, tools, "dbg_stack_locals",
+        "Return arguments and locals for several frames of a thread in one call, as compact "
+        "JSON, without changing the selected frame. thread: index ID from 'thread list' (0 = "
+        "selected). frames: '0-7', '3', '0,2,5' or 'all' (empty = first 8). depth: levels of "
+        "struct/array children to expand (0-4).",
+        {"thread", "frames", "depth"}, ToolAccess::Stopped,
+        [](int thread, const std::string& frames, int depth)
+        {
+            return "dbg_stack_locals " + std::to_string(thread) + " " +
+                   (frames.empty() ? "0-7" : frames) + " " + std::to_string(depth);
+        },
+        [&session](int thread, const std::string& frames, int depth)
+        {
+            return CollectStackLocals(session.dbg->GetDebugger(),
+                                      static_cast<uint32_t>(std::max(thread, 0)), frames, depth);
+        });
+}
+
+libagents::Tool BuildBacktraceTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<int, int>(
+        session, tools, "dbg_backtrace",
+        "Backtrace of a thread with recursion collapsed: repeating function cycles become one "
+        "line like '[frames 12..98761: A -> B repeated 49375x]', and only the unique top and "
+        "bottom frames are listed. Use instead of 'bt' for deep stacks (stack overflows). "
+        "In long recursions only the outermost frames below the cycle are symbolized; if the "
+        "recursion goes on past max_frames the bottom is not shown. "
+        "thread: index ID (0 = selected). max_frames: unwind budget (0 = default 100000).",
+        {"thread", "max_frames"}, ToolAccess::Stopped,
+        [](int thread, int max_frames)
+        { return "dbg_backtrace " + std::to_string(thread) + " " + std::to_string(max_frames); },
+        [&session](int thread, int max_frames)
+        {
+            return CollectBacktrace(session.dbg->GetDebugger(),
+                                    static_cast<uint32_t>(std::max(thread, 0)),
+                                    static_cast<uint32_t>(std::max(max_frames, 0)));
+        });
+}
+
+libagents::Tool BuildCoreDiffTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string, std::string>(
+        session, tools, "dbg_core_diff",
+        "Compare the current process or core with another core of the same binary (e.g. good "
+        "vs bad) and return a compact difference report: stop reasons, threads aligned by "
+        "stack signature (differing stacks, threads on one side only), registers of the "
+        "crashing threads, globals and memory/heap statistics. core: path of the other core "
+        "file. globals: comma-separated global variable names to compare (may be empty).",
+        {"core", "globals"}, ToolAccess::Stopped,
+        [](const std::string& core, const std::string& globals)
+        { return "dbg_core_diff " + core + (globals.empty() ? "" : " " + globals); },
+        [&session](const std::string& core, const std::string& globals)
+        { return DiffCores(session.dbg->GetDebugger(), core, globals); });
+}
+
+libagents::Tool BuildMemoryMapTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string>(
+        session, tools, "dbg_memory_map",
+        "Summarize the address space in one call: region count and size by kind (code, data, "
+        "heap, stacks, anonymous, guard pages), largest mapped files and regions, RSS/PSS/swap "
+        "and thread count. Much faster than 'memory region --all' for local processes. filter: "
+        "empty for the summary, or a name substring (e.g. 'libc', '[stack') to list every "
+        "matching region.",
+        {"filter"}, ToolAccess::LiveIfLocal,
+        [](const std::string& filter)
+        { return "dbg_memory_map" + (filter.empty() ? "" : " " + filter); },
+        [&session](const std::string& filter)
+        { return CollectMemoryMap(session.dbg->GetDebugger(), filter); });
+}
+
+libagents::Tool BuildMemoryScanTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string, std::string>(
+        session, tools, "dbg_memory_scan",
+        "Search the readable memory of the process for a value and list where it occurs, with "
+        "region and symbol. Use it to find who references an object, where a string lives, or "
+        "copies of a key or magic number. pattern: '0x...' finds aligned pointer-sized "
+        "references to that address, 'hex:de ad be ef' raw bytes, anything else literal text. "
+        "regions: empty for all readable memory, 'anon' for unnamed mappings, or a region name "
+        "substring like '[heap]' or 'libfoo'.",
+        {"pattern", "regions"}, ToolAccess::LiveIfLocal,
+        [](const std::string& pattern, const std::string& regions)
+        { return "dbg_memory_scan " + pattern + (regions.empty() ? "" : " " + regions); },
+        [&session](const std::string& pattern, const std::string& regions)
+        { return ScanMemory(session.dbg->GetDebugger(), pattern, regions); });
+}
+
+libagents::Tool BuildThreadStatesTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<int>(
+        session, tools, "dbg_thread_states",
+        "For a hung or slow live process: one table of every thread's scheduler state, CPU use "
+        "over a short interval, the system call it is blocked in (futex, epoll_wait, read, ...) "
+        "and its top frames, with alike idle threads grouped. Shows which threads spin and which "
+        "wait. Local Linux processes only. interval_ms: 0 reads states without resuming the "
+        "process; a positive value (max 5000) RESUMES a stopped process for that long to "
+        "measure CPU and interrupts it again. Resuming needs the user's 'agent resume on' and "
+        "is refused at crash, signal and breakpoint stops.",
+        {"interval_ms"}, ToolAccess::Live,
+        [](int interval_ms) { return "dbg_thread_states " + std::to_string(interval_ms); },
+        [&session](int interval_ms)
+        { return CollectThreadStates(session.dbg->GetDebugger(), interval_ms); });
+}
+
+libagents::Tool BuildFdsTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string>(
+        session, tools, "dbg_fds",
+        "Open file descriptors of a live local process, resolved: sockets with addresses and TCP "
+        "state, pipes, files, eventfd/epoll/timerfd. Summarises counts by type and flags "
+        "anomalies (CLOSE_WAIT leaks, accept backlog, unread data, deleted files, near the "
+        "open-file limit) and threads blocked on a descriptor. Alike descriptors are grouped "
+        "into fd ranges. filter: empty for all, a type (tcp, udp, unix, pipe, file, device, "
+        "epoll, eventfd, ...) or a single fd number.",
+        {"filter"}, ToolAccess::Live,
+        [](const std::string& filter)
+        { return "dbg_fds" + (filter.empty() ? std::string() : " " + filter); },
+        [&session](const std::string& filter)
+        { return CollectFileDescriptors(session.dbg->GetDebugger(), filter); });
+}
+
+libagents::Tool BuildDetectHangTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<int, int>(
+        session, tools, "dbg_detect_hang",
+        "Tell a true hang from a slow operation in a live process: lets it run, interrupts it "
+        "'samples' times every 'interval' ms, unwinds every thread and compares the stacks. "
+        "Reports threads whose stack never changed, grouped by stack, with whether each is "
+        "blocked in the kernel (and in which system call), spinning, or idle, plus a verdict. "
+        "samples: 0 = 5 (2..50); interval: milliseconds between samples, 0 = 500. A stopped "
+        "process is RESUMED for the run and interrupted again afterwards, but only with the "
+        "user's 'agent resume on' and never at a crash, signal or breakpoint stop.",
+        {"samples", "interval"}, ToolAccess::Live,
+        [](int samples, int interval)
+        {
+            return "dbg_detect_hang " + std::to_string(samples) + " " +
+                   std::to_string(interval);
+        },
+        [&session](int samples, int interval)
+        { return DetectHang(session.dbg->GetDebugger(), samples, interval); });
+}
+
+libagents::Tool BuildLockContentionTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<int, int>(
+        session, tools, "dbg_lock_contention",
+        "Profile lock contention in a live process: interrupts it 'samples' times every "
+        "'interval' ms and records which threads wait on a lock (futex/pthread mutex or rwlock), "
+        "the lock address and the calling code. Returns the most-contended locks with average "
+        "and peak waiter counts, the call sites that wait, and for mutexes the holder thread "
+        "and its stack. Condition-variable waits are not counted. samples: 0 = 20 (2..200); "
+        "interval: milliseconds between samples, 0 = 50. Like dbg_detect_hang it resumes a "
+        "stopped process only with 'agent resume on' and never at a crash or breakpoint stop.",
+        {"samples", "interval"}, ToolAccess::Live,
+        [](int samples, int interval)
+        {
+            return "dbg_lock_contention " + std::to_string(samples) + " " +
+                   std::to_string(interval);
+        },
+        [&session](int samples, int interval)
+        { return ProfileLockContention(session.dbg->GetDebugger(), samples, interval); });
+}
+
+libagents::Tool BuildMemoryGrowthTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string>(
+        session, tools, "dbg_memory_growth",
+        "Memory growth trend recorded by 'copilot memwatch' while the process ran: total "
+        "RSS over time, anonymous and swap growth, and the fastest-growing regions (files, "
+        "[heap], [stack], anonymous mappings by size class) with MB/min and mapping counts. "
+        "filter: only regions whose name contains it (empty for the top growers).",
+        {"filter"}, ToolAccess::Live,
+        [](const std::string& filter)
+        { return "dbg_memory_growth" + (filter.empty() ? std::string() : " " + filter); },
+        [](const std::string& filter) { return GetMemoryGrowthTracker().Report(filter); });
+}
+
+libagents::Tool BuildEventHistoryTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string>(
+        session, tools, "dbg_event_history",
+        "Return the recorded debugger event timeline for this session, oldest first: process "
+        "state changes, stops with per-thread stop reasons, breakpoint hits/additions/"
+        "removals, signals, threads appearing/exiting between stops and modules loaded/"
+        "unloaded, plus counts of signals and breakpoint hits. Use it to see what happened "
+        "before the current stop. filter: empty for everything, or comma-separated kinds "
+        "(process, stop, signal, breakpoint, thread, module) and/or 'last:N'.",
+        {"filter"}, ToolAccess::Live,
+        [](const std::string& filter)
+        { return "dbg_event_history" + (filter.empty() ? "" : " " + filter); },
+        [](const std::string& filter) { return GetEventRecorder().History(filter); });
+}
+
+libagents::Tool BuildRegistersTool(AgentSession& session, AgentTools& tools)
+{
+    return MakeNativeTool<std::string, std::string>(
+        session, tools, "dbg_registers_all",
+        "Read registers of many threads in one call. Returns one row per register with "
+        "identical values grouped across threads (@all, @1-3) and pointer-like values annotated "
+        "with symbol or memory region. set: 'gpr' (default), 'vector', 'all', or register "
+        "names like 'rip,rsp,rax'. threads: 'all' (default) or index IDs like '1,4-6'.",
+        {"set", "threads"}, ToolAccess::Stopped,
+        [](const std::string& set, const std::string& threads)
+        {
+            return "dbg_registers_all " + (set.empty() ? "gpr" : set) + " " +
+                   (threads.empty() ? "all" : threads);
+        },
+        [&session](const std::string& set, const std::string& threads)
+        { return CollectRegisters(session.dbg->GetDebugger(), set, threads); });
 }
 
 void ConfigureHost(AgentSession& session)
@@ -117,6 +729,63 @@ void ConfigureHost(AgentSession& session)
     session.host_ready = true;
 }
 
+// Create and initialize an agent for provider with all tools registered,
+// applying that provider's BYOK and the response timeout. Tool results are
+// compacted through the dictionary of the agent's conversation in tools.
+std::unique_ptr<libagents::IAgent> CreateAgent(AgentSession& session, AgentTools& tools,
+                                               libagents::ProviderType provider,
+                                               const lldb_copilot::Settings& settings,
+                                               const std::string& session_id, std::string* error)
+{
+    auto agent = libagents::create_agent(provider);
+    if (!agent)
+    {
+        if (error)
+            *error = "Failed to create agent";
+        return nullptr;
+    }
+
+    agent->register_tool(BuildDebuggerTool(session, tools));
+    agent->register_tool(BuildStackLocalsTool(session, tools));
+    agent->register_tool(BuildRegistersTool(session, tools));
+    agent->register_tool(BuildBacktraceTool(session, tools));
+    agent->register_tool(BuildCoreDiffTool(session, tools));
+    agent->register_tool(BuildEventHistoryTool(session, tools));
+    agent->register_tool(BuildMemoryMapTool(session, tools));
+    agent->register_tool(BuildMemoryScanTool(session, tools));
+    agent->register_tool(BuildThreadStatesTool(session, tools));
+    agent->register_tool(BuildFdsTool(session, tools));
+    agent->register_tool(BuildDetectHangTool(session, tools));
+    agent->register_tool(BuildLockContentionTool(session, tools));
+    agent->register_tool(BuildMemoryGrowthTool(session, tools));
+
+    // Apply BYOK settings if enabled
+    auto byok = settings.byok.find(libagents::provider_type_name(provider));
+    if (byok != settings.byok.end() && byok->second.is_usable())
+        agent->set_byok(byok->second.to_config());
+
+    // Apply response timeout setting
+    if (settings.response_timeout_ms > 0)
+        agent->set_response_timeout(std::chrono::milliseconds(settings.response_timeout_ms));
+
+    if (!session_id.empty())
+        agent->set_session_id(session_id);
+
+    if (!agent->initialize())
+    {
+        if (error)
+        {
+            std::string detail = agent->get_last_error();
+            *error = "Failed to initialize " + agent->provider_name() + " provider";
+            if (!detail.empty())
+                *error += ": " + detail;
+        }
+        agent->shutdown();
+        return nullptr;
+    }
+    return agent;
+}
+
 bool EnsureAgent(AgentSession& session, LldbClient& dbg_client,
                  const lldb_copilot::Settings& settings, const std::string& target,
                  std::string* error, bool* created)
@@ -133,107 +802,510 @@ bool EnsureAgent(AgentSession& session, LldbClient& dbg_client,
     {
         session.provider = settings.default_provider;
         session.provider_name = libagents::provider_type_name(session.provider);
-        session.agent = libagents::create_agent(session.provider);
+
+        // Skip session resume when BYOK is enabled (not supported by BYOK providers)
+        const auto* byok = settings.get_byok();
+        if (!(byok && byok->is_usable()))
+            session.session_id =
+                lldb_copilot::GetSessionStore().GetSessionId(target, session.provider_name);
+
+        session.agent = CreateAgent(session, session.tools, session.provider, settings,
+                                    session.session_id, error);
         if (!session.agent)
         {
-            if (error)
-                *error = "Failed to create agent";
+            ResetAgentSession(session);
             return false;
         }
 
-        session.agent->register_tool(BuildDebuggerTool(session));
-
         session.system_prompt = lldb_copilot::GetFullSystemPrompt(settings.custom_prompt);
         session.primed = false; // will prepend on first user query instead of system_prompt
+        session.tools.names.Reset();
+        session.aliases_stale = !session.session_id.empty(); // Resumed conversation
 
-        // Apply BYOK settings if enabled
-        const auto* byok = settings.get_byok();
-        if (byok && byok->is_usable())
-            session.agent->set_byok(byok->to_config());
+        ConfigureHost(session);
+        session.initialized = true;
+
+        if (created)
+            *created = true;
+    }
 
-        // Apply response timeout setting
-        if (settings.response_timeout_ms > 0)
-            session.agent->set_response_timeout(
-                std::chrono::milliseconds(settings.response_timeout_ms));
+    std::string updated_prompt = lldb_copilot::GetFullSystemPrompt(settings.custom_prompt);
+    if (updated_prompt != session.system_prompt)
+    {
+        session.system_prompt = updated_prompt;
+        session.primed = false; // re-prime on next query
+    }
 
+    if (session.target != target)
+    {
+        session.target = target;
         // Skip session resume when BYOK is enabled (not supported by BYOK providers)
-        if (!(byok && byok->is_usable()))
+        const auto* byok_check = settings.get_byok();
+        if (!(byok_check && byok_check->is_usable()))
         {
-            session.session_id =
+            std::string new_session_id =
                 lldb_copilot::GetSessionStore().GetSessionId(target, session.provider_name);
-            if (!session.session_id.empty())
-                session.agent->set_session_id(session.session_id);
+            if (new_session_id != session.session_id)
+            {
+                if (session.agent)
+                {
+                    session.agent->clear_session();
+                    session.tools.names.Reset();
+                    session.session_id = new_session_id;
+                    session.aliases_stale = !session.session_id.empty();
+                    if (!session.session_id.empty())
+                        session.agent->set_session_id(session.session_id);
+                }
+            }
+        }
+        session.primed = false; // new target -> re-prime next query
+    }
+
+    session.aborted = false;
+    return true;
+}
+} // namespace
+
+// Helper to join command args into a string
+static std::string JoinArgs(char** command)
+{
+    std::string result;
+    for (int i = 0; command && command[i]; i++)
+    {
+        if (i > 0)
+            result += " ";
+        result += command[i];
+    }
+    return result;
+}
+
+// Keep the last few exchanges as context for a hedge provider
+static void RecordExchange(AgentSession& session, const std::string& question,
+                           const std::string& response)
+{
+    session.log.AddExchange(question, response);
+    session.transcript.emplace_back(question, response.substr(0, kTranscriptAnswerChars));
+    if (session.transcript.size() > kTranscriptExchanges)
+        session.transcript.pop_front();
+}
+
+// Prompt for an agent that has not seen the conversation (hedge, failover):
+// system prompt, recent exchanges, then the question
+static std::string SelfContainedPrompt(AgentSession& session, const std::string& prompt)
+{
+    std::string context;
+    for (const auto& [question, answer] : session.transcript)
+        context += "Q: " + question + "\nA: " + answer + "\n\n";
+    std::string full = session.system_prompt + "\n\n---\n\n";
+    if (!context.empty())
+        full += "Earlier in this debugging session:\n\n" + context + "---\n\n";
+    return full + prompt;
+}
+
+// Called once the primary provider has stayed silent for the hedge delay:
+// returns the hedge agent (created on first use) and a self-contained prompt
+// carrying the system prompt and recent exchanges
+static HedgeRequest StartHedge(AgentSession& session, const lldb_copilot::Settings& settings,
+                               LldbClient& client, const std::string& prompt)
+{
+    if (session.hedge_agent && session.hedge_provider != settings.hedge_provider)
+    {
+        session.hedge_agent->shutdown();
+        session.hedge_agent.reset();
+    }
+
+    client.OutputThinking("[hedge] No response after " +
+                          std::to_string(settings.hedge_delay_ms / 1000) + "s, also asking " +
+                          settings.hedge_provider + "...");
+    if (session.hedge_agent)
+    {
+        session.hedge_agent->clear_session();
+    }
+    else
+    {
+        std::string error;
+        try
+        {
+            auto provider = lldb_copilot::ParseProviderType(settings.hedge_provider);
+            session.hedge_agent =
+                CreateAgent(session, session.hedge_tools, provider, settings, "", &error);
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+        if (!session.hedge_agent)
+        {
+            client.OutputWarning("Hedge provider unavailable: " + error);
+            return {};
+        }
+        session.hedge_provider = settings.hedge_provider;
+    }
+    session.hedge_tools.names.Reset(); // Fresh conversation
+
+    return {session.hedge_agent.get(), SelfContainedPrompt(session, prompt),
+            &session.hedge_tools.names, &session.hedge_tools.lost};
+}
+
+// Failover agent for settings.failover (created on first use): another
+// provider, or "byok" for the current provider through its BYOK endpoint
+static libagents::IAgent* GetFailoverAgent(AgentSession& session,
+                                           const lldb_copilot::Settings& settings,
+                                           std::string* error)
+{
+    if (session.failover_agent && session.failover == settings.failover)
+    {
+        session.failover_agent->clear_session();
+        session.failover_tools.names.Reset();
+        return session.failover_agent.get();
+    }
+    if (session.failover_agent)
+    {
+        session.failover_agent->shutdown();
+        session.failover_agent.reset();
+    }
+
+    lldb_copilot::Settings failover_settings = settings;
+    libagents::ProviderType provider = settings.default_provider;
+    if (settings.failover == "byok")
+    {
+        auto& byok = failover_settings.get_or_create_byok();
+        if (byok.api_key.empty())
+        {
+            *error = "no BYOK key configured for " + session.provider_name;
+            return nullptr;
+        }
+        byok.enabled = true;
+    }
+    else
+    {
+        try
+        {
+            provider = lldb_copilot::ParseProviderType(settings.failover);
+        }
+        catch (const std::exception& e)
+        {
+            *error = e.what();
+            return nullptr;
         }
+    }
+
+    session.failover_tools.names.Reset();
+    session.failover_agent =
+        CreateAgent(session, session.failover_tools, provider, failover_settings, "", error);
+    if (session.failover_agent)
+        session.failover = settings.failover;
+    return session.failover_agent.get();
+}
+
+// Alias dictionary of the conversation agent holds
+static NameCompactor& NamesOf(AgentSession& session, libagents::IAgent* agent)
+{
+    if (agent == session.failover_agent.get())
+        return session.failover_tools.names;
+    if (agent == session.hedge_agent.get())
+        return session.hedge_tools.names;
+    return session.tools.names;
+}
+
+// Start or end a hedge race for the tools of both agents. While racing their
+// results are held back; at the end the winner's go to the investigation log
+// and the loser's are dropped, including one it finished after losing (it
+// held tools_mutex until then).
+static void HoldToolResults(AgentSession& session, bool racing, bool hedge_won = false)
+{
+    std::lock_guard<std::mutex> lock(session.tools_mutex);
+    if (!racing)
+        for (const auto& call : (hedge_won ? session.hedge_tools : session.tools).held)
+            session.log.AddToolCall(call.call, call.output, call.stop);
+    for (AgentTools* tools : {&session.tools, &session.hedge_tools})
+    {
+        tools->held.clear();
+        tools->holding = racing;
+    }
+}
+
+// Wait for delay unless the user interrupts; false if interrupted
+static bool BackoffWait(AgentSession& session, std::chrono::milliseconds delay)
+{
+    auto until = std::chrono::steady_clock::now() + delay;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        if (session.host.should_abort && session.host.should_abort())
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return true;
+}
+
+// Query the session's agent (hedged if enabled), retrying retryable errors
+// with jittered backoff and failing over after repeated failures. Tool
+// results gathered by a failed attempt are replayed, not re-executed.
+static std::string QueryWithRetry(AgentSession& session, const lldb_copilot::Settings& settings,
+                                  LldbClient& client, const std::string& full_prompt,
+                                  const std::string& prompt)
+{
+    ReapHedgeLosers(); // A loser may still be running on one of the agents
+    session.tools.lost = false;
+    session.replay.Clear();
+    session.tools.names.Checkpoint();
+
+    libagents::IAgent* agent = session.agent.get();
+    std::string agent_prompt = full_prompt;
+    std::string agent_name = session.provider_name;
+    bool hedging = !settings.hedge_provider.empty() && settings.hedge_provider != agent_name;
+    int failures = 0; // Consecutive failures of the current agent
+    int retries = 0;
+    auto first_error = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        try
+        {
+            std::string response;
+            if (hedging && agent == session.agent.get())
+            {
+                bool hedge_won = false;
+                HoldToolResults(session, true);
+                try
+                {
+                    response = QueryHedged(
+                        {agent, agent_prompt, &session.tools.names, &session.tools.lost},
+                        [&]() { return StartHedge(session, settings, client, prompt); },
+                        session.host, std::chrono::milliseconds(settings.hedge_delay_ms),
+                        session.hedge, &hedge_won);
+                }
+                catch (...)
+                {
+                    HoldToolResults(session, false); // Both failed: keep the primary's
+                    throw;
+                }
+                HoldToolResults(session, false, hedge_won);
+                if (hedge_won)
+                    client.OutputThinking("[hedge] Answered by " + session.hedge_provider);
+            }
+            else
+            {
+                response = agent->query_hosted(agent_prompt, session.host);
+            }
 
-        if (!session.agent->initialize())
+            if (retries > 0)
+            {
+                double ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - first_error)
+                                .count();
+                session.retry.recovered++;
+                session.retry.recovery_ms += ms;
+                session.retry.max_recovery_ms = std::max(session.retry.max_recovery_ms, ms);
+                char buf[96];
+                snprintf(buf, sizeof(buf), "[retry] Recovered via %s after %.1f s (%d %s)",
+                         agent_name.c_str(), ms / 1000.0, retries,
+                         retries == 1 ? "retry" : "retries");
+                client.OutputThinking(buf);
+            }
+            return response;
+        }
+        catch (const std::exception& e)
         {
-            if (error)
+            std::string message = e.what();
+            session.retry.failures++;
+            if (retries == 0)
+                first_error = std::chrono::steady_clock::now();
+            failures++;
+
+            bool retryable = IsRetryableError(message);
+            bool failover = !settings.failover.empty() && agent == session.agent.get() &&
+                            (!retryable || failures >= settings.failover_after);
+            if (retries >= settings.retry_max || (!retryable && !failover) ||
+                session.aborted.load())
             {
-                std::string detail = session.agent->get_last_error();
-                *error = "Failed to initialize " + session.agent->provider_name() + " provider";
-                if (!detail.empty())
-                    *error += ": " + detail;
+                session.retry.gave_up++;
+                throw;
             }
-            ResetAgentSession(session);
-            return false;
+            retries++;
+            session.retry.retries++;
+            session.replay.Rewind();
+            NamesOf(session, agent).Rollback();
+
+            if (failover)
+            {
+                std::string error;
+                if (libagents::IAgent* alternate = GetFailoverAgent(session, settings, &error))
+                {
+                    client.OutputWarning("[retry] " + agent_name + " failed: " + message +
+                                         "; failing over to " + settings.failover);
+                    agent = alternate;
+                    NamesOf(session, agent).Checkpoint();
+                    agent_prompt = SelfContainedPrompt(session, prompt);
+                    agent_name = settings.failover;
+                    failures = 0;
+                    session.retry.failovers++;
+                    continue;
+                }
+                client.OutputWarning("[retry] Failover unavailable: " + error);
+                if (!retryable)
+                {
+                    session.retry.gave_up++;
+                    throw;
+                }
+            }
+
+            auto delay = BackoffDelay(static_cast<unsigned>(retries));
+            char buf[64];
+            snprintf(buf, sizeof(buf), "; retrying in %.1f s (%d/%d)", delay.count() / 1000.0,
+                     retries, settings.retry_max);
+            client.OutputWarning("[retry] " + agent_name + " error: " + message + buf);
+            if (!BackoffWait(session, delay))
+                return "(Aborted)";
         }
+    }
+}
 
-        ConfigureHost(session);
-        session.initialized = true;
+// Send a question to the agent (creating it if needed) and stream the answer
+static bool AskAgent(lldb::SBDebugger debugger, const std::string& question,
+                     lldb::SBCommandReturnObject& result)
+{
+    LldbClient client(debugger);
+    auto settings = lldb_copilot::LoadSettings();
+    auto& session = GetAgentSession();
+    std::string target = client.GetTargetName();
+
+    std::string error;
+    bool created = false;
+    if (!EnsureAgent(session, client, settings, target, &error, &created))
+    {
+        result.SetError((error.empty() ? "Failed to initialize" : error).c_str());
+        return false;
+    }
+
+    std::string provider_name = libagents::provider_type_name(settings.default_provider);
+    client.OutputThinking("[" + provider_name + "] Asking: " + question);
+    if (created)
+        client.OutputThinking("Initializing " + provider_name + " provider...");
+
+    // Local crash pre-classification, once per stop: printed before the model
+    // answers and passed along as a hint for it to confirm or refute
+    std::string prompt = question;
+    std::string stop = StopKey(debugger);
+    if (stop != session.triaged_stop)
+    {
+        session.triaged_stop = stop;
+        CrashVerdict verdict = ClassifyStop(debugger);
+        if (verdict.crashed)
+        {
+            client.OutputVerdict(verdict.OneLine());
+            prompt = "[Local pre-classifier hint, verify before relying on it: " + verdict.kind +
+                     ": " + verdict.OneLine() + "]\n\n" + question;
+        }
+    }
 
-        if (created)
-            *created = true;
+    // A loaded process at another stop than the imported bundle's: its tools
+    // run live. Warned once per stop.
+    if (!session.imported.Empty() && debugger.GetSelectedTarget().GetProcess().IsValid())
+    {
+        std::string checked = session.imported_stop;
+        if (!ImportedStopMatches(session, debugger) && session.imported_stop != checked)
+            client.OutputWarning("[import] The loaded process is not at the stop recorded in " +
+                                 session.imported.path +
+                                 " (fingerprint differs); tool calls run live.");
     }
 
-    std::string updated_prompt = lldb_copilot::GetFullSystemPrompt(settings.custom_prompt);
-    if (updated_prompt != session.system_prompt)
+    // First question after "agent import": hand over the imported transcript
+    if (session.import_context_pending)
     {
-        session.system_prompt = updated_prompt;
-        session.primed = false; // re-prime on next query
+        std::string context = "Imported investigation of " + session.imported.target + " (" +
+                              session.imported.path + "). There may be no live process: tool "
+                              "calls made in that investigation return their recorded "
+                              "results while no process is loaded or the loaded one is at the "
+                              "same stop.\n\n";
+        for (const auto& e : session.imported.exchanges)
+            context += "Q: " + e.question + "\nA: " +
+                       e.answer.substr(0, kTranscriptAnswerChars) + "\n\n";
+        prompt = context + "---\n\n" + prompt;
     }
 
-    if (session.target != target)
+    // First question after "agent triage": facts read from the core's notes
+    if (!session.core_notes.empty())
+        prompt = "[Facts from the core file's ELF notes:\n" + session.core_notes + "]\n\n" +
+                 prompt;
+
+    // Resumed conversation: its earlier tool output may use aliases that the
+    // fresh dictionary will reuse for other types
+    if (session.aliases_stale)
+        prompt = "[Type aliases ($T1, $T2, ...) from earlier in this conversation are no longer "
+                 "valid; tool output defines every alias again where it first uses it.]\n\n" +
+                 prompt;
+
+    // Growth alert from "copilot memwatch" not yet seen by the model
+    std::string memory_alert = GetMemoryGrowthTracker().PendingAlert();
+    if (!memory_alert.empty())
+        prompt = "[Memory growth alert from copilot memwatch (dbg_memory_growth has the full "
+                 "trend):\n" + memory_alert + "]\n\n" + prompt;
+
+    // Low-intrusion mode: a running process stays running and tools stop it
+    // only in short bursts, capped for the whole question
+    SetResumeAllowed(settings.allow_resume);
+    StopBudget& stops = GetStopBudget();
+    stops.Begin(settings.low_intrusion ? settings.stop_budget_ms : 0);
+    bool live = stops.active() && IsRunning(debugger.GetSelectedTarget().GetProcess());
+    if (live)
+        prompt = "[Low-intrusion mode: the process is running in production and must stay "
+                 "responsive. Tools that need it stopped stop it briefly, within a budget of " +
+                 std::to_string(settings.stop_budget_ms) +
+                 " ms for this question; dbg_exec runs only read-only commands. Prefer "
+                 "dbg_thread_states, dbg_memory_map, dbg_fds and dbg_memory_scan, which read it "
+                 "without stopping it.]\n\n" +
+                 prompt;
+
+    try
     {
-        session.target = target;
-        // Skip session resume when BYOK is enabled (not supported by BYOK providers)
-        const auto* byok_check = settings.get_byok();
-        if (!(byok_check && byok_check->is_usable()))
+        std::string full_prompt =
+            (session.primed || session.system_prompt.empty())
+                ? prompt
+                : (session.system_prompt + "\n\n---\n\n" + prompt);
+
+        std::string response = QueryWithRetry(session, settings, client, full_prompt, prompt);
+        session.primed = true;
+        if (live || stops.bursts() || stops.refused())
+            client.OutputThinking("[low-intrusion] Process " + stops.Summary());
+        if (response == "(Aborted)")
+            client.OutputWarning("Aborted.");
+        else
+            RecordExchange(session, question, response);
+        if (response != "(Aborted)")
         {
-            std::string new_session_id =
-                lldb_copilot::GetSessionStore().GetSessionId(target, session.provider_name);
-            if (new_session_id != session.session_id)
+            session.import_context_pending = false;
+            session.aliases_stale = false;
+            session.core_notes.clear();
+            if (!memory_alert.empty())
+                GetMemoryGrowthTracker().ClearAlert();
+        }
+
+        // Skip session persistence when BYOK is enabled (not supported by BYOK providers)
+        const auto* byok_save = settings.get_byok();
+        if (!(byok_save && byok_save->is_usable()))
+        {
+            std::string new_session_id = session.agent->get_session_id();
+            if (!new_session_id.empty() && new_session_id != session.session_id)
             {
-                if (session.agent)
-                {
-                    session.agent->clear_session();
-                    session.session_id = new_session_id;
-                    if (!session.session_id.empty())
-                        session.agent->set_session_id(session.session_id);
-                }
+                lldb_copilot::GetSessionStore().SetSessionId(target, provider_name,
+                                                             new_session_id);
+                session.session_id = new_session_id;
             }
         }
-        session.primed = false; // new target -> re-prime next query
-    }
-
-    session.aborted = false;
-    return true;
-}
-} // namespace
 
-// Helper to join command args into a string
-static std::string JoinArgs(char** command)
-{
-    std::string result;
-    for (int i = 0; command && command[i]; i++)
+        result.SetStatus(lldb::eReturnStatusSuccessFinishResult);
+    }
+    catch (const std::exception& e)
     {
-        if (i > 0)
-            result += " ";
-        result += command[i];
+        result.SetError(e.what());
+        return false;
     }
-    return result;
+
+    return true;
 }
 
-// "copilot" command - purely for asking questions, no subcommands
+// "copilot" command - for asking questions (plus "copilot watch")
 class CopilotCommand : public lldb::SBCommandPluginInterface
 {
   public:
@@ -249,57 +1321,131 @@ class CopilotCommand : public lldb::SBCommandPluginInterface
             return false;
         }
 
-        LldbClient client(debugger);
-        auto settings = lldb_copilot::LoadSettings();
-        auto& session = GetAgentSession();
-        std::string target = client.GetTargetName();
+        // A question can start with "watch" too; one ending in '?' is never a
+        // watch expression, and an expression has to evaluate (WatchManager::Add)
+        if ((question == "watch" || question.rfind("watch ", 0) == 0) && question.back() != '?')
+            return HandleWatch(debugger, question.substr(5), result);
 
-        std::string error;
-        bool created = false;
-        if (!EnsureAgent(session, client, settings, target, &error, &created))
+        if (question == "memwatch" || question.rfind("memwatch ", 0) == 0)
+            return HandleMemwatch(debugger, question.substr(8), result);
+
+        return AskAgent(debugger, question, result);
+    }
+
+  private:
+    // copilot memwatch [<interval>[ms|s|m] [threshold_mb] | stop]
+    static bool HandleMemwatch(lldb::SBDebugger debugger, std::string args,
+                               lldb::SBCommandReturnObject& result)
+    {
+        constexpr int kDefaultThresholdMb = 64;
+        auto& tracker = GetMemoryGrowthTracker();
+        std::istringstream in(args);
+        std::string interval;
+        std::string threshold;
+        in >> interval >> threshold;
+
+        if (interval.empty())
         {
-            result.SetError((error.empty() ? "Failed to initialize" : error).c_str());
-            return false;
+            result.Printf("%s", tracker.Report("").c_str());
+        }
+        else if (interval == "stop")
+        {
+            tracker.Stop();
+            result.Printf("Memory growth tracking stopped.\n");
         }
+        else
+        {
+            // Seconds unless suffixed with ms or m
+            char* unit = nullptr;
+            double value = std::strtod(interval.c_str(), &unit);
+            std::string suffix = unit ? unit : "";
+            double scale = suffix == "ms" ? 1 : suffix == "m" ? 60000 : 1000;
+            int interval_ms = static_cast<int>(value * scale);
+            int threshold_mb =
+                threshold.empty() ? kDefaultThresholdMb : std::atoi(threshold.c_str());
+            if ((suffix != "" && suffix != "s" && suffix != "ms" && suffix != "m") ||
+                interval_ms < 100 || threshold_mb < 1)
+            {
+                result.SetError("Usage: copilot memwatch <interval>[ms|s|m] [threshold_mb] "
+                                "(interval at least 100 ms)");
+                return false;
+            }
 
-        std::string provider_name = libagents::provider_type_name(settings.default_provider);
-        client.OutputThinking("[" + provider_name + "] Asking: " + question);
-        if (created)
-            client.OutputThinking("Initializing " + provider_name + " provider...");
+            std::string error;
+            if (!tracker.Start(debugger, interval_ms, threshold_mb, &error))
+            {
+                result.SetError(error.c_str());
+                return false;
+            }
+            result.Printf("Sampling memory every %d ms. The model is told when the total grows "
+                          "by %d MB; 'copilot memwatch' shows the trend.\n",
+                          interval_ms, threshold_mb);
+        }
 
-        try
-        {
-            std::string full_prompt =
-                (session.primed || session.system_prompt.empty())
-                    ? question
-                    : (session.system_prompt + "\n\n---\n\n" + question);
+        result.SetStatus(lldb::eReturnStatusSuccessFinishResult);
+        return true;
+    }
 
-            std::string response = session.agent->query_hosted(full_prompt, session.host);
-            session.primed = true;
-            if (response == "(Aborted)")
-                client.OutputWarning("Aborted.");
+    // copilot watch [list | clear [id] | <expr> [--when <predicate>] [--at <bp-id|function>]]
+    static bool HandleWatch(lldb::SBDebugger debugger, std::string args,
+                            lldb::SBCommandReturnObject& result)
+    {
+        auto& watches = GetWatchManager();
+        size_t begin = args.find_first_not_of(' ');
+        args = begin == std::string::npos ? "" : args.substr(begin);
 
-            // Skip session persistence when BYOK is enabled (not supported by BYOK providers)
-            const auto* byok_save = settings.get_byok();
-            if (!(byok_save && byok_save->is_usable()))
+        if (args.empty() || args == "list")
+        {
+            result.Printf("%s", watches.List().c_str());
+        }
+        else if (args == "clear")
+        {
+            watches.Clear(debugger);
+            result.Printf("All watches cleared.\n");
+        }
+        else if (args.rfind("clear ", 0) == 0)
+        {
+            int id = std::atoi(args.c_str() + 6);
+            if (!watches.Remove(debugger, id))
             {
-                std::string new_session_id = session.agent->get_session_id();
-                if (!new_session_id.empty() && new_session_id != session.session_id)
-                {
-                    lldb_copilot::GetSessionStore().SetSessionId(target, provider_name,
-                                                                 new_session_id);
-                    session.session_id = new_session_id;
-                }
+                result.SetError(("No watch #" + std::to_string(id)).c_str());
+                return false;
             }
-
-            result.SetStatus(lldb::eReturnStatusSuccessFinishResult);
+            result.Printf("Watch #%d removed.\n", id);
         }
-        catch (const std::exception& e)
+        else
         {
-            result.SetError(e.what());
-            return false;
+            // Split off --when / --at options (in either order)
+            std::string expr = args, when, at;
+            auto take = [&](const std::string& flag, std::string& value)
+            {
+                size_t pos = expr.find(" " + flag + " ");
+                if (pos == std::string::npos)
+                    return;
+                size_t value_begin = pos + flag.size() + 2;
+                size_t value_end = expr.find(" --", value_begin);
+                value = expr.substr(value_begin, value_end == std::string::npos
+                                                     ? std::string::npos
+                                                     : value_end - value_begin);
+                expr.erase(pos, value_end == std::string::npos ? std::string::npos
+                                                               : value_end - pos);
+            };
+            take("--when", when);
+            take("--at", at);
+
+            std::string error;
+            int id = watches.Add(debugger, expr, when, at, &error);
+            if (id == 0)
+            {
+                result.SetError(error.c_str());
+                return false;
+            }
+            result.Printf("Watch #%d: %s (when %s, %s). The model is only asked when it trips.\n",
+                          id, expr.c_str(), when.empty() ? "anomaly" : when.c_str(),
+                          at.empty() ? "sampled at every stop" : ("at breakpoint " + at).c_str());
         }
 
+        result.SetStatus(lldb::eReturnStatusSuccessFinishResult);
         return true;
     }
 };
@@ -312,6 +1458,12 @@ class AgentCommand : public lldb::SBCommandPluginInterface
                    lldb::SBCommandReturnObject& result) override
     {
         std::string args = JoinArgs(command);
+
+        // Internal: run at every stop by the stop-hook "copilot watch" installs.
+        // Kept ahead of settings loading so that quiet stops cost nothing.
+        if (args == "watch-tick")
+            return WatchTick(debugger, result);
+
         auto settings = lldb_copilot::LoadSettings();
         auto& session = GetAgentSession();
         LldbClient client(debugger);
@@ -336,16 +1488,43 @@ class AgentCommand : public lldb::SBCommandPluginInterface
                 "LLDB Copilot - AI-powered debugger assistant\n\n"
                 "Commands:\n"
                 "  copilot <question>     Ask the AI a question\n"
+                "  copilot watch <expr> [--when <pred>] [--at <bp-id|function>]\n"
+                "                         Watch a value; ask the AI only when it trips\n"
+                "                         (pred: anomaly, changed, null, nonnull,\n"
+                "                         jump[>N], <op> N)\n"
+                "  copilot watch list     List watches with recent history\n"
+                "  copilot watch clear [id]  Remove watches\n"
+                "  copilot memwatch <interval> [mb]  Track memory growth; tell the AI\n"
+                "                         when it grows by mb (default 64)\n"
+                "  copilot memwatch [stop]  Show the trend / stop tracking\n"
                 "  agent help             Show this help\n"
                 "  agent version          Show version information\n"
                 "  agent provider         Show current provider\n"
                 "  agent provider <name>  Switch provider (claude, copilot)\n"
                 "  agent clear            Clear conversation history\n"
+                "  agent stats            Show tool statistics\n"
                 "  agent prompt           Show custom prompt\n"
                 "  agent prompt <text>    Set custom prompt\n"
                 "  agent prompt clear     Clear custom prompt\n"
                 "  agent timeout          Show response timeout\n"
                 "  agent timeout <ms>     Set response timeout in milliseconds\n"
+                "  agent hedge            Show hedging status\n"
+                "  agent hedge <name> [ms]  Also ask provider <name> when no response\n"
+                "                         arrives within ms (default 20000)\n"
+                "  agent hedge off        Disable hedging\n"
+                "  agent export <file>    Save transcript, tool calls and results\n"
+                "  agent import <file>    Load a bundle; answer tool calls from it\n"
+                "  agent import clear     Drop the imported bundle\n"
+                "  agent triage <core> [exe]  Instant crash facts from core notes\n"
+                "  agent resume [on|off]  Let tools resume a stopped process to sample\n"
+                "                         it (never at crash or breakpoint stops)\n"
+                "  agent live             Show low-intrusion mode status\n"
+                "  agent live on [ms]     Keep a running process running; tools stop it\n"
+                "                         in short bursts within ms per question (200)\n"
+                "  agent live off         Disable low-intrusion mode\n"
+                "  agent retry [n]        Show or set retries for provider errors\n"
+                "  agent failover <name|byok> [n]  Fail over after n errors\n"
+                "  agent failover off     Disable failover\n"
                 "  agent byok             Show BYOK status\n"
                 "  agent byok enable      Enable BYOK for current provider\n"
                 "  agent byok disable     Disable BYOK\n"
@@ -399,14 +1578,73 @@ class AgentCommand : public lldb::SBCommandPluginInterface
         {
             std::string target = client.GetTargetName();
             std::string provider_name = libagents::provider_type_name(settings.default_provider);
+            ReapHedgeLosers();
             if (session.agent)
             {
                 session.agent->clear_session();
                 session.session_id.clear();
             }
             lldb_copilot::GetSessionStore().ClearSession(target, provider_name);
+            session.tools.names.Reset();
+            session.aliases_stale = false;
+            session.log.Clear();
+            session.transcript.clear();
             result.Printf("Conversation history cleared.\n");
         }
+        else if (subcmd == "stats")
+        {
+            ReapHedgeLosers(); // Its tools may still be updating the counters
+            const auto& v = session.validation;
+            result.Printf("dbg_exec validation:\n"
+                          "  Checked:    %u\n"
+                          "  Rejected:   %u (retry rate %.1f%%)\n"
+                          "  Recovered:  %u\n"
+                          "  Overridden: %u\n"
+                          "  Failed:     %u\n",
+                          v.checked, v.rejected, v.RetryRate() * 100.0, v.recovered,
+                          v.overridden, v.failed);
+
+            const auto& o = GetOutputStats();
+            result.Printf("Command output:\n"
+                          "  Commands:   %u\n"
+                          "  Total:      %.1f KB\n"
+                          "  Peak:       %.1f KB\n"
+                          "  Assembly:   %.2f ms total, %.2f ms slowest\n",
+                          o.commands, o.total_bytes / 1024.0, o.peak_bytes / 1024.0,
+                          o.assemble_us / 1000.0, o.peak_assemble_us / 1000.0);
+
+            const auto& n = session.tools.names.stats();
+            result.Printf("Name compaction (this conversation):\n"
+                          "  Outputs:    %zu\n"
+                          "  Bytes:      %.1f KB -> %.1f KB (%.1f%% saved, ~%zu tokens)\n"
+                          "  Aliases:    %zu defined, %zu symbols demangled\n",
+                          n.outputs, n.bytes_in / 1024.0, n.bytes_out / 1024.0,
+                          n.bytes_in ? 100.0 * n.Saved() / n.bytes_in : 0.0, n.Saved() / 4,
+                          n.aliases, n.demangled);
+
+            const auto& h = session.hedge;
+            unsigned plain = h.queries - h.hedged;
+            result.Printf("Hedging (%s):\n"
+                          "  Queries:    %u\n"
+                          "  Hedged:     %u (hedge rate %.1f%%)\n"
+                          "  Hedge wins: %u (avg %.1f s, primary still pending)\n"
+                          "  Latency:    avg %.1f s unhedged, %.1f s hedged\n",
+                          settings.hedge_provider.empty() ? "off"
+                                                          : settings.hedge_provider.c_str(),
+                          h.queries, h.hedged, h.HedgeRate() * 100.0, h.hedge_wins,
+                          h.hedge_wins ? h.win_ms / h.hedge_wins / 1000.0 : 0.0,
+                          plain ? h.plain_ms / plain / 1000.0 : 0.0,
+                          h.hedged ? h.hedged_ms / h.hedged / 1000.0 : 0.0);
+
+            const auto& r = session.retry;
+            result.Printf("Provider errors:\n"
+                          "  Failures:   %u (%u retried, %u failovers, %u gave up)\n"
+                          "  Recovered:  %u (avg %.1f s, max %.1f s to recover)\n"
+                          "  Replayed:   %u tool results\n",
+                          r.failures, r.retries, r.failovers, r.gave_up, r.recovered,
+                          r.recovered ? r.recovery_ms / r.recovered / 1000.0 : 0.0,
+                          r.max_recovery_ms / 1000.0, r.cache_hits);
+        }
         else if (subcmd == "prompt")
         {
             if (rest.empty())
@@ -471,6 +1709,302 @@ class AgentCommand : public lldb::SBCommandPluginInterface
                 }
             }
         }
+        else if (subcmd == "export")
+        {
+            if (rest.empty())
+            {
+                result.SetError("Usage: agent export <file>");
+                return false;
+            }
+            ReapHedgeLosers();
+            std::string error;
+            std::lock_guard<std::mutex> lock(session.tools_mutex);
+            if (!ExportBundle(rest, session.log, StopFingerprint(debugger), client.GetTargetName(),
+                              libagents::provider_type_name(settings.default_provider), &error))
+            {
+                result.SetError(error.c_str());
+                return false;
+            }
+            result.Printf("Exported %zu exchanges and %zu tool calls to %s%s\n",
+                          session.log.exchanges.size(), session.log.calls.size(), rest.c_str(),
+                          session.log.truncated ? " (some outputs omitted: size limit)" : "");
+        }
+        else if (subcmd == "import")
+        {
+            if (rest.empty())
+            {
+                if (session.imported.Empty())
+                    result.Printf("No bundle imported.\n");
+                else
+                    result.Printf("Imported: %s (target %s, %zu exchanges, %zu cached results)\n",
+                                  session.imported.path.c_str(), session.imported.target.c_str(),
+                                  session.imported.exchanges.size(),
+                                  session.imported.results.size());
+            }
+            else if (rest == "clear")
+            {
+                session.imported = ImportedBundle();
+                session.imported_stop.clear();
+                session.import_context_pending = false;
+                result.Printf("Imported bundle cleared.\n");
+            }
+            else
+            {
+                std::string error;
+                if (!ImportBundle(rest, &session.imported, &error))
+                {
+                    result.SetError(error.c_str());
+                    return false;
+                }
+                session.import_context_pending = true;
+                session.imported_stop.clear();
+                result.Printf("Imported %zu exchanges and %zu cached tool results from %s.\n",
+                              session.imported.exchanges.size(), session.imported.results.size(),
+                              rest.c_str());
+                if (!debugger.GetSelectedTarget().GetProcess().IsValid())
+                    result.Printf("Follow-up questions use the cached results while no process "
+                                  "is loaded.\n");
+                else if (ImportedStopMatches(session, debugger))
+                    result.Printf("The loaded process is at the bundle's stop (fingerprint "
+                                  "%s): cached results answer calls the bundle has.\n",
+                                  session.imported.hash.c_str());
+                else
+                    result.AppendWarning("The loaded process is not at the stop recorded in the "
+                                         "bundle (fingerprint differs); tool calls run live.");
+            }
+        }
+        else if (subcmd == "triage")
+        {
+            // agent triage <core> [executable]
+            size_t space = rest.find(' ');
+            std::string core = rest.substr(0, space);
+            std::string exe = space == std::string::npos ? "" : rest.substr(space + 1);
+            if (core.empty())
+            {
+                result.SetError("Usage: agent triage <core> [executable]");
+                return false;
+            }
+
+            CoreFacts facts;
+            std::string report = TriageCoreFile(core, &facts);
+            if (report.rfind("Error: ", 0) == 0)
+            {
+                result.SetError(report.substr(7).c_str());
+                return false;
+            }
+            result.Printf("%s", report.c_str());
+            session.core_notes = report;
+
+            // AT_EXECFN may be relative to the crashed process's directory;
+            // the mapped file list has absolute paths
+            if (exe.empty())
+                exe = !facts.executable.empty() && facts.executable[0] == '/'
+                          ? facts.executable
+                          : (facts.files.empty() ? "" : facts.files.front().path);
+            LoadCoreInBackground(debugger, core, exe);
+            result.Printf("Loading the core with symbols in the background%s%s.\n",
+                          exe.empty() ? "" : " using ", exe.c_str());
+        }
+        else if (subcmd == "resume")
+        {
+            if (rest == "on" || rest == "off")
+            {
+                settings.allow_resume = rest == "on";
+                lldb_copilot::SaveSettings(settings);
+            }
+            else if (!rest.empty())
+            {
+                result.SetError("Usage: agent resume [on|off]");
+                return false;
+            }
+            result.Printf("Tools %s resume a stopped process.\n",
+                          settings.allow_resume ? "may" : "may not");
+        }
+        else if (subcmd == "live")
+        {
+            std::istringstream in(rest);
+            std::string mode;
+            std::string ms;
+            in >> mode >> ms;
+            if (mode.empty())
+            {
+                result.Printf("Low-intrusion mode: %s", settings.low_intrusion ? "" : "off\n");
+                if (settings.low_intrusion)
+                    result.Printf("on, stop budget %d ms per question\n",
+                                  settings.stop_budget_ms);
+                const StopBudget& stops = GetStopBudget();
+                if (stops.active())
+                    result.Printf("Last question: process %s\n", stops.Summary().c_str());
+            }
+            else if (mode == "off")
+            {
+                settings.low_intrusion = false;
+                lldb_copilot::SaveSettings(settings);
+                result.Printf("Low-intrusion mode disabled.\n");
+            }
+            else if (mode == "on")
+            {
+                try
+                {
+                    int budget = ms.empty() ? settings.stop_budget_ms : std::stoi(ms);
+                    if (budget < 1)
+                    {
+                        result.SetError("Stop budget must be at least 1 ms.");
+                        return false;
+                    }
+                    settings.low_intrusion = true;
+                    settings.stop_budget_ms = budget;
+                    lldb_copilot::SaveSettings(settings);
+                    result.Printf("Low-intrusion mode on: tools stop a running process within "
+                                  "a budget of %d ms per question; dbg_exec runs only "
+                                  "read-only commands.\n",
+                                  budget);
+                    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+                    if (process.IsValid() && process.GetState() == lldb::eStateStopped)
+                        result.Printf("The process is stopped; 'continue' it to inspect it "
+                                      "live.\n");
+                }
+                catch (...)
+                {
+                    result.SetError("Invalid stop budget. Use milliseconds.");
+                    return false;
+                }
+            }
+            else
+            {
+                result.SetError("Usage: agent live [on [ms] | off]");
+                return false;
+            }
+        }
+        else if (subcmd == "retry")
+        {
+            if (rest.empty())
+            {
+                result.Printf("Retries: up to %d with backoff\nFailover: %s", settings.retry_max,
+                              settings.failover.empty() ? "off\n" : "");
+                if (!settings.failover.empty())
+                    result.Printf("%s after %d failures\n", settings.failover.c_str(),
+                                  settings.failover_after);
+            }
+            else
+            {
+                try
+                {
+                    int n = std::stoi(rest);
+                    if (n < 0 || n > 10)
+                    {
+                        result.SetError("Retry count must be between 0 and 10.");
+                        return false;
+                    }
+                    settings.retry_max = n;
+                    lldb_copilot::SaveSettings(settings);
+                    result.Printf("Retries set to %d.\n", n);
+                }
+                catch (...)
+                {
+                    result.SetError("Invalid retry count.");
+                    return false;
+                }
+            }
+        }
+        else if (subcmd == "failover")
+        {
+            std::istringstream in(rest);
+            std::string name;
+            std::string after;
+            in >> name >> after;
+            if (name.empty())
+            {
+                result.Printf("Failover: %s\n", settings.failover.empty()
+                                                     ? "off"
+                                                     : settings.failover.c_str());
+            }
+            else if (name == "off")
+            {
+                settings.failover.clear();
+                lldb_copilot::SaveSettings(settings);
+                result.Printf("Failover disabled.\n");
+            }
+            else
+            {
+                try
+                {
+                    if (name != "byok")
+                        name = libagents::provider_type_name(lldb_copilot::ParseProviderType(name));
+                    int n = after.empty() ? settings.failover_after : std::stoi(after);
+                    if (n < 1)
+                    {
+                        result.SetError("Failover threshold must be at least 1.");
+                        return false;
+                    }
+                    settings.failover = name;
+                    settings.failover_after = n;
+                    lldb_copilot::SaveSettings(settings);
+                    result.Printf("Failover to %s after %d failures.\n", name.c_str(), n);
+                }
+                catch (const std::exception& e)
+                {
+                    result.SetError(e.what());
+                    return false;
+                }
+            }
+        }
+        else if (subcmd == "hedge")
+        {
+            if (rest.empty())
+            {
+                if (settings.hedge_provider.empty())
+                    result.Printf("Hedging: off\n");
+                else
+                    result.Printf("Hedging: ask %s if %s is silent for %d ms\n",
+                                  settings.hedge_provider.c_str(),
+                                  libagents::provider_type_name(settings.default_provider),
+                                  settings.hedge_delay_ms);
+            }
+            else if (rest == "off")
+            {
+                settings.hedge_provider.clear();
+                lldb_copilot::SaveSettings(settings);
+                if (session.hedge_agent)
+                {
+                    session.hedge_agent->shutdown();
+                    session.hedge_agent.reset();
+                }
+                result.Printf("Hedging disabled.\n");
+            }
+            else
+            {
+                std::istringstream in(rest);
+                std::string name;
+                std::string delay;
+                in >> name >> delay;
+                try
+                {
+                    auto type = lldb_copilot::ParseProviderType(name);
+                    if (type == settings.default_provider)
+                    {
+                        result.SetError("Hedge provider must differ from the current provider.");
+                        return false;
+                    }
+                    int ms = delay.empty() ? settings.hedge_delay_ms : std::stoi(delay);
+                    if (ms < 1000)
+                    {
+                        result.SetError("Hedge delay must be at least 1000 ms.");
+                        return false;
+                    }
+                    settings.hedge_provider = libagents::provider_type_name(type);
+                    settings.hedge_delay_ms = ms;
+                    lldb_copilot::SaveSettings(settings);
+                    result.Printf("Hedging enabled: ask %s after %d ms without a response.\n",
+                                  settings.hedge_provider.c_str(), ms);
+                }
+                catch (const std::exception& e)
+                {
+                    result.SetError(e.what());
+                    return false;
+                }
+            }
+        }
         else if (subcmd == "byok")
         {
             std::string provider_name = libagents::provider_type_name(settings.default_provider);
@@ -602,6 +2136,27 @@ class AgentCommand : public lldb::SBCommandPluginInterface
         result.SetStatus(lldb::eReturnStatusSuccessFinishResult);
         return true;
     }
+
+  private:
+    static bool WatchTick(lldb::SBDebugger debugger, lldb::SBCommandReturnObject& result)
+    {
+        std::vector<std::string> reports = GetWatchManager().OnStop(debugger);
+        if (reports.empty())
+        {
+            result.SetStatus(lldb::eReturnStatusSuccessFinishNoResult);
+            return true;
+        }
+
+        LldbClient client(debugger);
+        std::string question = "A value watch tripped at the current stop:\n";
+        for (const auto& report : reports)
+        {
+            client.OutputWarning(report.substr(0, report.find('\n')));
+            question += "- " + report + "\n";
+        }
+        question += "Investigate why the value changed this way and whether it is a bug.";
+        return AskAgent(debugger, question, result);
+    }
 };
 
 // Register commands with LLDB
@@ -609,6 +2164,9 @@ void RegisterCommands(lldb::SBDebugger& debugger)
 {
     lldb::SBCommandInterpreter interp = debugger.GetCommandInterpreter();
 
+    // Record events from the start so the timeline covers the whole session
+    GetEventRecorder().Start(debugger);
+
     interp.AddCommand("copilot", new CopilotCommand(),
                       "Ask Copilot a question. Usage: copilot <question>");
 
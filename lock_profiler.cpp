@@ -0,0 +1,306 @@
+#include "lock_profiler.hpp"
+#include "stack_sampler.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <unordered_map>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr int kDefaultSamples = 20;
+constexpr int kMaxSamples = 200;
+constexpr int kDefaultIntervalMs = 50;
+constexpr int kMaxIntervalMs = 5000;
+constexpr uint32_t kMaxFrames = 48;
+constexpr size_t kShownSites = 4;
+constexpr size_t kShownHolders = 3;
+constexpr size_t kShownHolderFrames = 4;
+
+// glibc pthread_mutex_t: int __lock; unsigned __count; int __owner (same on
+// every Linux ABI); the futex word is __lock
+constexpr uint64_t kMutexOwnerOffset = 8;
+
+// futex(2) operations that wait for a lock word to change
+constexpr uint64_t kFutexCmdMask = ~(128ull | 256ull); // PRIVATE_FLAG, CLOCK_REALTIME
+constexpr uint64_t kFutexWait = 0;
+constexpr uint64_t kFutexLockPi = 6;
+constexpr uint64_t kFutexWaitBitset = 9;
+constexpr uint64_t kFutexLockPi2 = 13;
+
+bool Contains(const std::string& text, const char* part)
+{
+    return text.find(part) != std::string::npos;
+}
+
+bool IsLockFunction(const std::string& fn)
+{
+    return Contains(fn, "mutex_lock") || Contains(fn, "lll_lock") || Contains(fn, "rwlock_") ||
+           Contains(fn, "mutex::lock") || Contains(fn, "lock_wait") ||
+           Contains(fn, "mutex_timedlock") || Contains(fn, "shared_mutex::lock");
+}
+
+bool IsConditionWait(const ThreadSample& thread)
+{
+    for (const auto& frame : thread.frames)
+        if (Contains(frame.function, "cond_wait") || Contains(frame.function, "cond_timedwait") ||
+            Contains(frame.function, "condition_variable::wait"))
+            return true;
+    return false;
+}
+
+bool IsSystemModule(const std::string& module)
+{
+    static const char* const kPrefixes[] = {"libc.so", "libc-",    "libpthread", "libstdc++",
+                                            "libc++",  "ld-linux", "ld-musl",    "libgcc_s"};
+    for (const char* prefix : kPrefixes)
+        if (module.rfind(prefix, 0) == 0)
+            return true;
+    return false;
+}
+
+// Innermost frame of the program's own code: skips the C library and the
+// inlined standard lock wrappers
+const SampledFrame* CallerFrame(const ThreadSample& thread)
+{
+    for (const auto& frame : thread.frames)
+    {
+        if (IsSystemModule(frame.module) || IsLockFunction(frame.function) ||
+            frame.function.rfind("std::", 0) == 0 || frame.function.rfind("__gthread", 0) == 0)
+            continue;
+        return &frame;
+    }
+    return nullptr;
+}
+
+std::string Site(const SampledFrame* frame)
+{
+    if (!frame)
+        return "??";
+    return frame->location.empty() ? frame->function
+                                   : frame->function + " (" + frame->location + ")";
+}
+
+// Lock word a thread waits on: 0 if it is not waiting for a lock, 1 if it is
+// but the address is unknown
+uint64_t WaitedLock(const ThreadSample& thread)
+{
+    if (IsConditionWait(thread))
+        return 0;
+    bool in_lock_code = false;
+    for (const auto& frame : thread.frames)
+        in_lock_code = in_lock_code || IsLockFunction(frame.function);
+    if (thread.kernel_known && thread.call.kind == TaskSyscall::Kind::Syscall)
+    {
+        const char* name = SyscallName(thread.call.nr);
+        uint64_t op = thread.call.args[1] & kFutexCmdMask;
+        if (name && std::string(name) == "futex" &&
+            (op == kFutexWait || op == kFutexWaitBitset || op == kFutexLockPi ||
+             op == kFutexLockPi2) &&
+            (in_lock_code || op == kFutexLockPi || op == kFutexLockPi2))
+            return thread.call.args[0];
+    }
+    return in_lock_code ? 1 : 0;
+}
+
+struct LockStats
+{
+    uint64_t address = 0; // 0 when only the call site is known
+    size_t waiter_samples = 0;
+    size_t max_waiters = 0;
+    size_t samples_seen = 0;
+    bool is_mutex = false; // Waiters were in pthread mutex code
+    std::map<std::string, size_t> sites;
+    std::map<std::string, size_t> holders; // Holder description -> samples
+    size_t unknown_holder = 0;
+};
+} // namespace
+
+std::string ProfileLockContention(lldb::SBDebugger& debugger, int samples, int interval_ms,
+                                  size_t budget)
+{
+    int n = samples == 0 ? kDefaultSamples : std::clamp(samples, 2, kMaxSamples);
+    int interval = interval_ms <= 0 ? kDefaultIntervalMs : std::min(interval_ms, kMaxIntervalMs);
+
+    // Owners are read while the process is stopped: index = sample, tid -> owner
+    std::vector<std::unordered_map<uint64_t, uint64_t>> owners;
+    auto read_owners = [&owners](lldb::SBProcess& process, StackSample& sample)
+    {
+        auto& sample_owners = owners.emplace_back();
+        for (const auto& thread : sample.threads)
+        {
+            uint64_t lock = WaitedLock(thread);
+            if (lock <= 1 || sample_owners.count(lock))
+                continue;
+            int32_t owner = 0;
+            lldb::SBError error;
+            if (process.ReadMemory(lock + kMutexOwnerOffset, &owner, sizeof(owner), error) ==
+                    sizeof(owner) &&
+                owner > 0)
+                sample_owners[lock] = static_cast<uint64_t>(owner);
+        }
+    };
+
+    SampleRun run;
+    std::string error;
+    if (!SampleStacks(debugger, n, interval, kMaxFrames, run, error, read_owners))
+        return "Error: " + error;
+
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    std::map<uint64_t, LockStats> locks;  // By lock word
+    std::map<std::string, LockStats> by_site; // Address unknown: by call site
+    size_t contended_samples = 0;
+    size_t condition_waits = 0;
+    for (size_t s = 0; s < run.samples.size(); s++)
+    {
+        const StackSample& sample = run.samples[s];
+        std::unordered_map<uint64_t, const ThreadSample*> threads;
+        for (const auto& thread : sample.threads)
+            threads.emplace(thread.tid, &thread);
+
+        std::map<LockStats*, size_t> waiters;
+        for (const auto& thread : sample.threads)
+        {
+            if (IsConditionWait(thread))
+                condition_waits++;
+            uint64_t lock = WaitedLock(thread);
+            if (lock == 0)
+                continue;
+            const SampledFrame* caller = CallerFrame(thread);
+            LockStats& stats = lock == 1 ? by_site[Site(caller)] : locks[lock];
+            stats.address = lock == 1 ? 0 : lock;
+            stats.sites[Site(caller)]++;
+            bool rwlock = false;
+            for (const auto& frame : thread.frames)
+            {
+                rwlock = rwlock || Contains(frame.function, "rwlock");
+                stats.is_mutex = stats.is_mutex || Contains(frame.function, "pthread_mutex") ||
+                                 Contains(frame.function, "lll_lock_wait");
+            }
+            stats.is_mutex = stats.is_mutex && !rwlock;
+            waiters[&stats]++;
+        }
+        if (!waiters.empty())
+            contended_samples++;
+
+        for (auto& [stats, count] : waiters)
+        {
+            stats->waiter_samples += count;
+            stats->max_waiters = std::max(stats->max_waiters, count);
+            stats->samples_seen++;
+
+            // Holder from the mutex owner field, if it names a thread of ours
+            uint64_t owner = 0;
+            if (stats->address && stats->is_mutex && s < owners.size())
+            {
+                auto it = owners[s].find(stats->address);
+                if (it != owners[s].end())
+                    owner = it->second;
+            }
+            auto holder = owner ? threads.find(owner) : threads.end();
+            if (holder == threads.end())
+            {
+                stats->unknown_holder++;
+                continue;
+            }
+            const auto& frames = holder->second->frames;
+            const SampledFrame* caller = CallerFrame(*holder->second);
+            std::string desc = "tid " + std::to_string(holder->first) + " #" +
+                               std::to_string(holder->second->index_id) + ": ";
+            if (!frames.empty() && caller != &frames.front())
+                desc += "in " + frames.front().function + ", ";
+            desc += Site(caller);
+            size_t outer = caller ? static_cast<size_t>(caller - frames.data()) + 1 : 0;
+            for (size_t f = outer; f < frames.size() && f < outer + kShownHolderFrames; f++)
+                desc += " <- " + frames[f].function;
+            stats->holders[desc]++;
+        }
+    }
+
+    std::vector<const LockStats*> ranked;
+    for (const auto& [address, stats] : locks)
+        ranked.push_back(&stats);
+    for (const auto& [site, stats] : by_site)
+        ranked.push_back(&stats);
+    std::sort(ranked.begin(), ranked.end(),
+              [](const LockStats* a, const LockStats* b)
+              { return a->waiter_samples > b->waiter_samples; });
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%zu samples over %.0f ms; process stopped %.1f ms in total (longest %.1f ms)\n",
+                  run.samples.size(), run.elapsed_ms, run.stopped_ms, run.longest_stop_ms);
+    std::string out = line;
+    if (!run.note.empty())
+        out += "note: " + run.note + "\n";
+    if (!run.local)
+        out += "(not a local process: locks identified by call site only, holders unknown)\n";
+    std::snprintf(line, sizeof(line),
+                  "lock waits in %zu of %zu samples; %zu locks contended; %zu condition-variable "
+                  "waits not counted\n",
+                  contended_samples, run.samples.size(), ranked.size(), condition_waits);
+    out += line;
+    if (ranked.empty())
+        return out + "no thread was waiting for a lock in any sample\n";
+
+    out += "most-contended locks:\n";
+    double total = static_cast<double>(run.samples.size());
+    for (size_t i = 0; i < ranked.size(); i++)
+    {
+        const LockStats& stats = *ranked[i];
+        std::string entry;
+        if (stats.address)
+        {
+            std::snprintf(line, sizeof(line), "%2zu. 0x%" PRIx64, i + 1, stats.address);
+            entry = line;
+            lldb::SBSymbol symbol = target.ResolveLoadAddress(stats.address).GetSymbol();
+            if (symbol.IsValid() && symbol.GetName())
+                entry += std::string(" <") + symbol.GetName() + ">";
+        }
+        else
+        {
+            std::snprintf(line, sizeof(line), "%2zu. lock at", i + 1);
+            entry = line;
+        }
+        std::snprintf(line, sizeof(line),
+                      "  waiters: %.2f avg, %zu max, %zu waiter-samples, in %zu/%zu samples\n",
+                      stats.waiter_samples / total, stats.max_waiters, stats.waiter_samples,
+                      stats.samples_seen, run.samples.size());
+        entry += line;
+
+        std::vector<std::pair<std::string, size_t>> sites(stats.sites.begin(), stats.sites.end());
+        std::sort(sites.begin(), sites.end(),
+                  [](const auto& a, const auto& b) { return a.second > b.second; });
+        entry += "    waiting at:";
+        for (size_t s = 0; s < sites.size() && s < kShownSites; s++)
+            entry += (s ? ", " : " ") + sites[s].first + " x" + std::to_string(sites[s].second);
+        if (sites.size() > kShownSites)
+            entry += ", ... (" + std::to_string(sites.size()) + " sites)";
+        entry += "\n";
+
+        std::vector<std::pair<std::string, size_t>> holders(stats.holders.begin(),
+                                                            stats.holders.end());
+        std::sort(holders.begin(), holders.end(),
+                  [](const auto& a, const auto& b) { return a.second > b.second; });
+        for (size_t h = 0; h < holders.size() && h < kShownHolders; h++)
+            entry += "    holder in " + std::to_string(holders[h].second) + " samples: " +
+                     holders[h].first + "\n";
+        if (stats.unknown_holder && stats.address)
+            entry += "    holder unknown in " + std::to_string(stats.unknown_holder) +
+                     " samples" + (stats.is_mutex ? "" : " (not a pthread mutex)") + "\n";
+
+        if (out.size() + entry.size() > budget)
+        {
+            out += "(truncated: " + std::to_string(ranked.size() - i) + " more locks)\n";
+            break;
+        }
+        out += entry;
+    }
+    return out;
+}
+
+} // namespace lldb_copilot
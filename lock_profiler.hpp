@@ -0,0 +1,23 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Lock contention by sampling: interrupts a live process repeatedly (see
+// SampleStacks) and records which threads wait on a lock, the lock's address
+// (the futex word from /proc on a local Linux process) and the user-code
+// frame that asked for it. For glibc mutexes the holder is read from the
+// mutex's __owner field while stopped, and its stack is taken from the same
+// sample. Returns a "most-contended locks" table with waiter counts, call
+// sites and holder stacks. A stopped process is resumed only where
+// ResumeScope allows it; otherwise the refusal is returned as the error.
+// samples: 0 = 20 (2..200); interval_ms: 0 = 50 (max 5000)
+std::string ProfileLockContention(lldb::SBDebugger& debugger, int samples, int interval_ms,
+                                  size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
@@ -0,0 +1,383 @@
+#include "memory_growth.hpp"
+#include "procfs.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr size_t kMaxKeys = 1024;
+constexpr size_t kAlertRegions = 5;
+constexpr size_t kReportRegions = 12;
+constexpr size_t kTrendPoints = 12;
+constexpr size_t kTrendRegions = 3;
+
+double Mb(double bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+// "64K", "2M", "1G"
+std::string ShortSize(uint64_t bytes)
+{
+    static const char* const kUnits[] = {"", "K", "M", "G", "T"};
+    size_t unit = 0;
+    while (bytes >= 1024 && unit + 1 < std::size(kUnits))
+    {
+        bytes /= 1024;
+        unit++;
+    }
+    return std::to_string(bytes) + kUnits[unit];
+}
+
+// File path or [name]; anonymous mappings by power-of-two size class
+std::string RegionKey(std::string_view name, uint64_t size)
+{
+    if (!name.empty())
+        return std::string(name);
+    uint64_t low = 1;
+    while (low <= size / 2)
+        low *= 2;
+    return "anon " + ShortSize(low) + "-" + ShortSize(low * 2);
+}
+
+bool Skipped(std::string_view name)
+{
+    return name == "[vvar]" || name == "[vsyscall]" || name == "[vdso]";
+}
+
+bool IsGone(lldb::SBProcess& process)
+{
+    lldb::StateType state = process.GetState();
+    return !process.IsValid() || state == lldb::eStateExited ||
+           state == lldb::eStateDetached || state == lldb::eStateInvalid;
+}
+
+// Signed difference in MB
+double DeltaMb(uint64_t from, uint64_t to)
+{
+    return Mb(static_cast<double>(to) - static_cast<double>(from));
+}
+} // namespace
+
+MemoryGrowthTracker::~MemoryGrowthTracker()
+{
+    Stop();
+}
+
+bool MemoryGrowthTracker::Start(lldb::SBDebugger debugger, int interval_ms, int threshold_mb,
+                                std::string* error)
+{
+    Stop();
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid() || IsGone(process))
+    {
+        *error = "no live process";
+        return false;
+    }
+    const char* plugin = process.GetPluginName();
+    if (plugin && std::string(plugin) == "elf-core")
+    {
+        *error = "a core file does not change; memwatch needs a live process";
+        return false;
+    }
+
+    uint64_t pid = LocalProcfsPid(process);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        interval_ms_ = interval_ms;
+        threshold_ = static_cast<uint64_t>(threshold_mb) * 1024 * 1024;
+        resident_ = pid != 0;
+        pid_ = process.GetProcessID();
+        start_ = std::chrono::steady_clock::now();
+        samples_.clear();
+        have_baseline_ = false;
+        names_.clear();
+        ids_.clear();
+        skipped_ = 0;
+        alerts_ = 0;
+        alert_.clear();
+        note_.clear();
+    }
+    running_ = true;
+    thread_ = std::thread(&MemoryGrowthTracker::Run, this, process, pid);
+    return true;
+}
+
+void MemoryGrowthTracker::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+uint32_t MemoryGrowthTracker::KeyId(const std::string& name)
+{
+    auto it = ids_.find(name);
+    if (it != ids_.end())
+        return it->second;
+    if (names_.size() + 1 >= kMaxKeys && name != "(other)")
+        return KeyId("(other)"); // The last ID is kept for it
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(name, id);
+    return id;
+}
+
+bool MemoryGrowthTracker::Collect(lldb::SBProcess& process, uint64_t pid, Regions& regions,
+                                  Sample& sample)
+{
+    if (pid)
+    {
+        // Resident sizes, readable while the process runs
+        bool ok = ForEachSmapsRss(pid,
+                                  [&](const MapEntry& entry, uint64_t rss)
+                                  {
+                                      if (Skipped(entry.path))
+                                          return true;
+                                      auto& region =
+                                          regions[RegionKey(entry.path, entry.end - entry.start)];
+                                      region.first += rss;
+                                      region.second++;
+                                      sample.total += rss;
+                                      if (entry.path.empty())
+                                          sample.anonymous += rss;
+                                      return true;
+                                  });
+        MemoryRollup rollup;
+        if (ReadMemoryRollup(pid, rollup))
+        {
+            sample.total = rollup.rss;
+            sample.anonymous = rollup.anonymous;
+            sample.swap = rollup.swap;
+        }
+        return ok;
+    }
+
+    // Mapped sizes through LLDB, which needs the process stopped
+    if (process.GetState() != lldb::eStateStopped)
+        return false;
+    lldb::SBMemoryRegionInfoList list = process.GetMemoryRegions();
+    for (uint32_t i = 0; i < list.GetSize(); i++)
+    {
+        lldb::SBMemoryRegionInfo info;
+        if (!list.GetMemoryRegionAtIndex(i, info) || !info.IsMapped())
+            continue;
+        const char* name = info.GetName();
+        std::string_view view = name ? name : "";
+        if (Skipped(view))
+            continue;
+        uint64_t size = info.GetRegionEnd() - info.GetRegionBase();
+        auto& region = regions[RegionKey(view, size)];
+        region.first += size;
+        region.second++;
+        sample.total += size;
+        if (view.empty())
+            sample.anonymous += size;
+    }
+    return list.GetSize() > 0;
+}
+
+void MemoryGrowthTracker::Run(lldb::SBProcess process, uint64_t pid)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_)
+    {
+        lock.unlock();
+        bool gone = IsGone(process);
+        Regions regions;
+        Sample sample;
+        bool ok = !gone && Collect(process, pid, regions, sample);
+        lock.lock();
+
+        if (gone)
+        {
+            note_ = "process exited";
+            break;
+        }
+        if (ok)
+        {
+            sample.seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+            for (const auto& [name, region] : regions)
+            {
+                uint32_t id = KeyId(name);
+                if (sample.bytes.size() <= id)
+                {
+                    sample.bytes.resize(id + 1);
+                    sample.counts.resize(id + 1);
+                }
+                sample.bytes[id] += region.first;
+                sample.counts[id] += region.second;
+            }
+            samples_.push_back(std::move(sample));
+            if (samples_.size() > kMaxSamples)
+                samples_.pop_front();
+
+            const Sample& latest = samples_.back();
+            if (!have_baseline_)
+            {
+                baseline_ = latest;
+                have_baseline_ = true;
+            }
+            else if (latest.total >= baseline_.total + threshold_)
+            {
+                alert_ = DescribeGrowth(baseline_, latest, kAlertRegions, "");
+                alerts_++;
+                baseline_ = latest;
+                std::printf("[memwatch] %s", alert_.c_str());
+                std::fflush(stdout);
+            }
+        }
+        else
+        {
+            skipped_++;
+        }
+        wake_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return stop_; });
+    }
+    running_ = false;
+}
+
+std::string MemoryGrowthTracker::DescribeGrowth(const Sample& from, const Sample& to, size_t top,
+                                                const std::string& filter) const
+{
+    double minutes = (to.seconds - from.seconds) / 60.0;
+    double grown = DeltaMb(from.total, to.total);
+    char line[512];
+    std::snprintf(line, sizeof(line),
+                  "%s %.1f -> %.1f MB (%+.1f MB, %+.0f%%) in %.1f min (%.2f MB/min); anonymous "
+                  "%+.1f MB, swap %+.1f MB\n",
+                  resident_ ? "RSS" : "mapped", Mb(from.total), Mb(to.total), grown,
+                  from.total ? 100.0 * grown / Mb(from.total) : 0.0, minutes,
+                  minutes > 0 ? grown / minutes : 0.0, DeltaMb(from.anonymous, to.anonymous),
+                  DeltaMb(from.swap, to.swap));
+    std::string out = line;
+
+    std::vector<std::pair<double, uint32_t>> deltas;
+    for (uint32_t id = 0; id < to.bytes.size() || id < from.bytes.size(); id++)
+    {
+        if (!filter.empty() && names_[id].find(filter) == std::string::npos)
+            continue;
+        uint64_t before = id < from.bytes.size() ? from.bytes[id] : 0;
+        uint64_t after = id < to.bytes.size() ? to.bytes[id] : 0;
+        if (before != after || !filter.empty())
+            deltas.emplace_back(DeltaMb(before, after), id);
+    }
+    std::sort(deltas.begin(), deltas.end(), [](const auto& a, const auto& b)
+              { return a.first > b.first; });
+    size_t shown = 0;
+    for (const auto& [delta, id] : deltas)
+    {
+        if (shown == top || (delta <= 0 && filter.empty()))
+            break;
+        uint64_t before = id < from.bytes.size() ? from.bytes[id] : 0;
+        uint64_t after = id < to.bytes.size() ? to.bytes[id] : 0;
+        uint32_t count_before = id < from.counts.size() ? from.counts[id] : 0;
+        uint32_t count_after = id < to.counts.size() ? to.counts[id] : 0;
+        std::snprintf(line, sizeof(line),
+                      "  %+9.1f MB  %s (%.1f -> %.1f MB, %u -> %u mappings, %.2f MB/min)\n", delta,
+                      names_[id].c_str(), Mb(before), Mb(after), count_before, count_after,
+                      minutes > 0 ? delta / minutes : 0.0);
+        out += line;
+        shown++;
+    }
+    if (shown == 0)
+        out += filter.empty() ? "  no region grew\n" : "  no region matches\n";
+    return out;
+}
+
+std::string MemoryGrowthTracker::Report(const std::string& filter, size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (samples_.empty())
+        return running_ ? "memwatch: waiting for the first sample\n"
+                        : "memwatch is not running (start it with: copilot memwatch <interval>)\n";
+
+    const Sample& first = samples_.front();
+    const Sample& last = samples_.back();
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "memwatch: pid %llu every %d ms, %zu samples over %.1f min (%s), alert at "
+                  "+%.0f MB, %u alerts%s%s\n",
+                  static_cast<unsigned long long>(pid_), interval_ms_, samples_.size(),
+                  (last.seconds - first.seconds) / 60.0,
+                  resident_ ? "RSS from /proc smaps" : "mapped sizes via LLDB while stopped",
+                  Mb(threshold_), alerts_, running_ ? "" : "; stopped",
+                  note_.empty() ? "" : (": " + note_).c_str());
+    std::string out = line;
+    if (skipped_)
+        out += "(" + std::to_string(skipped_) +
+               " samples skipped: process running or unreadable)\n";
+
+    // Evenly spaced points of the series
+    auto trend = [&](const std::function<uint64_t(const Sample&)>& value)
+    {
+        std::string points;
+        size_t n = std::min(kTrendPoints, samples_.size());
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t index = n == 1 ? 0 : i * (samples_.size() - 1) / (n - 1);
+            std::snprintf(line, sizeof(line), " %.1f", Mb(value(samples_[index])));
+            points += line;
+        }
+        return points;
+    };
+    out += "total MB:" + trend([](const Sample& s) { return s.total; }) + "\n";
+    out += DescribeGrowth(first, last, kReportRegions, filter);
+
+    // Trends of the fastest growers
+    std::vector<std::pair<double, uint32_t>> growers;
+    for (uint32_t id = 0; id < last.bytes.size(); id++)
+    {
+        if (!filter.empty() && names_[id].find(filter) == std::string::npos)
+            continue;
+        uint64_t before = id < first.bytes.size() ? first.bytes[id] : 0;
+        if (last.bytes[id] > before)
+            growers.emplace_back(DeltaMb(before, last.bytes[id]), id);
+    }
+    std::sort(growers.begin(), growers.end(), [](const auto& a, const auto& b)
+              { return a.first > b.first; });
+    for (size_t i = 0; i < growers.size() && i < kTrendRegions; i++)
+    {
+        uint32_t id = growers[i].second;
+        std::string entry = "trend MB " + names_[id] + ":" +
+                            trend([id](const Sample& s)
+                                  { return id < s.bytes.size() ? s.bytes[id] : 0; }) +
+                            "\n";
+        if (out.size() + entry.size() > budget)
+            break;
+        out += entry;
+    }
+    return out;
+}
+
+std::string MemoryGrowthTracker::PendingAlert()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return alert_;
+}
+
+void MemoryGrowthTracker::ClearAlert()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    alert_.clear();
+}
+
+MemoryGrowthTracker& GetMemoryGrowthTracker()
+{
+    // Leaked: the sampling thread may outlive static destruction order
+    static MemoryGrowthTracker* tracker = new MemoryGrowthTracker();
+    return *tracker;
+}
+
+} // namespace lldb_copilot
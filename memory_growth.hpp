@@ -0,0 +1,92 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <lldb/API/LLDB.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Memory growth of a long-running process over time ("copilot memwatch").
+// A background thread samples resident size per mapping from
+// /proc/<pid>/smaps (local Linux processes, while running) or mapped region
+// sizes through LLDB (other processes, while stopped). Mappings are keyed by
+// file, [heap] and [stack], and anonymous mappings by size class, so leaks of
+// large malloc blocks show up as a growing class. The model only hears about
+// it when total growth since the last alert crosses a threshold.
+class MemoryGrowthTracker
+{
+  public:
+    static constexpr size_t kMaxSamples = 720;
+
+    ~MemoryGrowthTracker();
+
+    // Start sampling the selected process every interval_ms, replacing any
+    // earlier tracking. threshold_mb: growth that raises an alert.
+    bool Start(lldb::SBDebugger debugger, int interval_ms, int threshold_mb, std::string* error);
+    void Stop();
+    bool Running() const { return running_.load(); }
+
+    // Totals over time and the fastest-growing regions (names containing
+    // filter, or all)
+    std::string Report(const std::string& filter, size_t budget = kToolResultBudget);
+
+    // Growth alert not yet passed to the model ("" if none)
+    std::string PendingAlert();
+    void ClearAlert();
+
+  private:
+    struct Sample
+    {
+        double seconds = 0; // Since tracking started
+        uint64_t total = 0;
+        uint64_t anonymous = 0;
+        uint64_t swap = 0;
+        std::vector<uint64_t> bytes; // By key ID
+        std::vector<uint32_t> counts;
+    };
+
+    // Sizes and mapping counts by region key, before key IDs are assigned
+    using Regions = std::unordered_map<std::string, std::pair<uint64_t, uint32_t>>;
+
+    void Run(lldb::SBProcess process, uint64_t pid);
+    bool Collect(lldb::SBProcess& process, uint64_t pid, Regions& regions, Sample& sample);
+    uint32_t KeyId(const std::string& name);
+    std::string DescribeGrowth(const Sample& from, const Sample& to, size_t top,
+                               const std::string& filter) const;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex mutex_; // Guards everything below
+    std::condition_variable wake_;
+    bool stop_ = false;
+    int interval_ms_ = 0;
+    uint64_t threshold_ = 0;
+    bool resident_ = true; // Sizes are RSS (smaps) rather than mapped sizes
+    uint64_t pid_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::deque<Sample> samples_;
+    Sample baseline_; // Start, or the last alert
+    bool have_baseline_ = false;
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    unsigned skipped_ = 0;
+    unsigned alerts_ = 0;
+    std::string alert_;
+    std::string note_; // Why tracking ended
+};
+
+// Global tracker
+MemoryGrowthTracker& GetMemoryGrowthTracker();
+
+} // namespace lldb_copilot
@@ -0,0 +1,283 @@
+#include "memory_scan.hpp"
+#include "memory_source.hpp"
+#include "process_control.hpp"
+#include "procfs.hpp"
+#include "progress.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr size_t kMaxMatches = 256;
+constexpr size_t kContextBytes = 24;
+constexpr uint64_t kPageSize = 4096;
+
+struct Pattern
+{
+    std::string bytes;
+    size_t align = 1; // Matches must start at a multiple of this
+    std::string description;
+};
+
+struct Match
+{
+    uint64_t address = 0;
+    const RegionIndex::Region* region = nullptr;
+    std::string context; // Printable bytes at the match (text patterns)
+};
+
+bool ParsePattern(const std::string& spec, lldb::SBTarget& target, Pattern& pattern,
+                  std::string& error)
+{
+    if (spec.rfind("0x", 0) == 0 && spec.size() > 2)
+    {
+        char* end = nullptr;
+        uint64_t value = std::strtoull(spec.c_str() + 2, &end, 16);
+        if (*end)
+        {
+            error = "invalid address '" + spec + "'";
+            return false;
+        }
+        uint32_t size = target.GetAddressByteSize();
+        size = size == 4 ? 4 : 8;
+        bool little = target.GetByteOrder() != lldb::eByteOrderBig;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            uint32_t shift = 8 * (little ? i : size - 1 - i);
+            pattern.bytes += static_cast<char>((value >> shift) & 0xff);
+        }
+        pattern.align = size;
+        pattern.description = "pointer " + spec;
+        return true;
+    }
+
+    if (spec.rfind("hex:", 0) == 0)
+    {
+        std::string digits;
+        for (char c : spec.substr(4))
+            if (c != ' ')
+                digits += c;
+        if (digits.empty() || digits.size() % 2 ||
+            digits.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+        {
+            error = "invalid hex bytes '" + spec.substr(4) + "'";
+            return false;
+        }
+        for (size_t i = 0; i < digits.size(); i += 2)
+            pattern.bytes += static_cast<char>(std::strtoul(digits.substr(i, 2).c_str(), nullptr,
+                                                            16));
+        pattern.description = std::to_string(pattern.bytes.size()) + " bytes";
+        return true;
+    }
+
+    if (spec.empty())
+    {
+        error = "empty pattern";
+        return false;
+    }
+    pattern.bytes = spec;
+    pattern.description = "text \"" + spec + "\"";
+    return true;
+}
+
+bool RegionSelected(const RegionIndex& index, const RegionIndex::Region& region,
+                    const std::string& filter)
+{
+    if (!region.read)
+        return false;
+    const std::string& name = index.Name(region);
+    // Device and kernel-provided mappings can block or fault on read
+    if (name == "[vvar]" || name == "[vsyscall]" || name.rfind("/dev/", 0) == 0)
+        return false;
+    if (filter.empty())
+        return true;
+    if (filter == "anon")
+        return name.empty();
+    return name.find(filter) != std::string::npos;
+}
+
+std::string Printable(const char* data, size_t size)
+{
+    std::string out;
+    for (size_t i = 0; i < size; i++)
+        out += data[i] >= 0x20 && data[i] < 0x7f ? data[i] : '.';
+    return out;
+}
+} // namespace
+
+std::string ScanMemory(lldb::SBDebugger& debugger, const std::string& spec,
+                       const std::string& filter, size_t budget)
+{
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    lldb::SBProcess process = target.GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+
+    Pattern pattern;
+    std::string error;
+    if (!ParsePattern(spec, target, pattern, error))
+        return "Error: " + error;
+
+    RegionIndex index;
+    if (!index.Load(process))
+        return "Error: memory regions unavailable";
+    std::vector<const RegionIndex::Region*> regions;
+    uint64_t total = 0;
+    uint64_t chunks = 0;
+    for (const auto& region : index.regions())
+    {
+        if (!RegionSelected(index, region, filter))
+            continue;
+        regions.push_back(&region);
+        total += region.end - region.start;
+        chunks += (region.end - region.start + kMemoryChunkSize - 1) / kMemoryChunkSize;
+    }
+    if (regions.empty())
+        return "Error: no readable regions match '" + filter + "'";
+
+    auto start = std::chrono::steady_clock::now();
+    bool live = GetStopBudget().active() && IsRunning(process);
+    std::unique_ptr<MemorySource> source = OpenMemorySource(process, live);
+    OperationProgress progress(debugger, "Scanning memory", chunks);
+    std::boyer_moore_horspool_searcher searcher(pattern.bytes.begin(), pattern.bytes.end());
+    const size_t keep_max = pattern.bytes.size() - 1;
+    std::vector<char> buffer(kMemoryChunkSize + keep_max);
+
+    std::vector<Match> matches;
+    size_t more = 0; // Matches beyond kMaxMatches
+    uint64_t scanned = 0;
+    bool cancelled = false;
+
+    // Record matches in data[0, size) that start before limit; data[0] is at base
+    auto search = [&](const char* data, size_t size, size_t limit, uint64_t base,
+                      const RegionIndex::Region* region)
+    {
+        const char* end = data + size;
+        for (const char* it = std::search(data, end, searcher); it != end;
+             it = std::search(it + 1, end, searcher))
+        {
+            size_t offset = static_cast<size_t>(it - data);
+            if (offset >= limit)
+                break;
+            uint64_t address = base + offset;
+            if (address % pattern.align)
+                continue;
+            if (matches.size() == kMaxMatches)
+            {
+                more++;
+                continue;
+            }
+            Match match{address, region, ""};
+            if (pattern.align == 1)
+                match.context = Printable(it, std::min(kContextBytes, size - offset));
+            matches.push_back(std::move(match));
+        }
+    };
+
+    for (const RegionIndex::Region* region : regions)
+    {
+        // Sources holding the bytes in memory are searched in place
+        uint64_t length = region->end - region->start;
+        std::string_view view = source->View(region->start, static_cast<size_t>(length));
+        if (!view.empty())
+        {
+            for (size_t at = 0; at < view.size() && !cancelled; at += kMemoryChunkSize)
+            {
+                size_t chunk = std::min(kMemoryChunkSize, view.size() - at);
+                size_t window = std::min(chunk + keep_max, view.size() - at);
+                search(view.data() + at, window, chunk, region->start + at, region);
+                scanned += chunk;
+                if (!progress.Increment())
+                    cancelled = true;
+            }
+            if (cancelled)
+                break;
+            continue;
+        }
+
+        size_t carry = 0;              // Bytes kept from the previous chunk
+        uint64_t base = region->start; // Address of buffer[0]
+        for (uint64_t at = region->start; at < region->end && !cancelled;)
+        {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(kMemoryChunkSize,
+                                                                 region->end - at));
+            size_t got = source->Read(at, buffer.data() + carry, want);
+            size_t avail = carry + got;
+            scanned += got;
+            search(buffer.data(), avail, avail, base, region);
+
+            if (!progress.Increment())
+                cancelled = true;
+            if (got < want)
+            {
+                // Unreadable page: resume on the next one
+                at = (at + got) / kPageSize * kPageSize + kPageSize;
+                carry = 0;
+                base = at;
+                continue;
+            }
+            at += got;
+            carry = std::min(avail, keep_max);
+            std::memmove(buffer.data(), buffer.data() + avail - carry, carry);
+            base = at - carry;
+        }
+        if (cancelled)
+            break;
+    }
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%s: %zu matches%s; scanned %.1f of %.1f MB in %zu regions via %s in %.0f ms "
+                  "(%.0f MB/s)\n",
+                  pattern.description.c_str(), matches.size() + more,
+                  more ? " (first shown)" : "", scanned / 1048576.0, total / 1048576.0,
+                  regions.size(), source->name(), ms, ms > 0 ? scanned / 1048576.0 / ms * 1000 : 0);
+    std::string out = line;
+    if (cancelled)
+        out += "(interrupted; results are partial)\n";
+    if (live)
+        out += "(read while the process runs: each chunk is a snapshot, values may have moved)\n";
+
+    for (size_t i = 0; i < matches.size(); i++)
+    {
+        const Match& match = matches[i];
+        const std::string& name = index.Name(*match.region);
+        std::snprintf(line, sizeof(line), "0x%" PRIx64 " [%s+0x%" PRIx64 "]", match.address,
+                      name.empty() ? "anon" : name.c_str(), match.address - match.region->start);
+        std::string entry = line;
+        lldb::SBSymbol symbol = target.ResolveLoadAddress(match.address).GetSymbol();
+        if (symbol.IsValid() && symbol.GetName())
+        {
+            uint64_t sym_start = symbol.GetStartAddress().GetLoadAddress(target);
+            entry += std::string(" <") + symbol.GetName();
+            if (sym_start != LLDB_INVALID_ADDRESS && match.address > sym_start)
+                entry += "+" + std::to_string(match.address - sym_start);
+            entry += ">";
+        }
+        if (!match.context.empty())
+            entry += " \"" + match.context + "\"";
+        if (out.size() + entry.size() + 1 > budget)
+        {
+            out += "(truncated: " + std::to_string(matches.size() - i) + " more matches)\n";
+            break;
+        }
+        out += entry + "\n";
+    }
+    return out;
+}
+
+} // namespace lldb_copilot
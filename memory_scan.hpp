@@ -0,0 +1,19 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Scan the readable memory of the selected process for a pattern and list
+// the matches with their region and symbol.
+// pattern: "0x7f12345678" (pointer-sized value, aligned: finds references),
+//          "hex:de ad be ef" (raw bytes), or any other text (literal string)
+// regions: "" (all readable), "anon" (unnamed), or a region name substring
+std::string ScanMemory(lldb::SBDebugger& debugger, const std::string& pattern,
+                       const std::string& regions, size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
@@ -0,0 +1,284 @@
+#include "memory_source.hpp"
+#include "core_file.hpp"
+#include "procfs.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace lldb_copilot
+{
+
+namespace
+{
+class SBMemorySource : public MemorySource
+{
+  public:
+    explicit SBMemorySource(lldb::SBProcess process) : process_(process) {}
+
+    size_t Read(uint64_t address, void* buffer, size_t size) override
+    {
+        lldb::SBError error;
+        size_t n = process_.ReadMemory(address, buffer, size, error);
+        if (n > 0)
+            return n;
+
+        // Failed as a whole: salvage the readable prefix page by page
+        size_t done = 0;
+        char* out = static_cast<char*>(buffer);
+        while (done < size)
+        {
+            size_t page = std::min<size_t>(kPageSize - (address + done) % kPageSize, size - done);
+            lldb::SBError page_error;
+            size_t got = process_.ReadMemory(address + done, out + done, page, page_error);
+            done += got;
+            if (got < page)
+                break;
+        }
+        return done;
+    }
+
+    const char* name() const override { return "SB API"; }
+
+  private:
+    static constexpr uint64_t kPageSize = 4096;
+    lldb::SBProcess process_;
+};
+
+class CoreMemorySource : public MemorySource
+{
+  public:
+    size_t Read(uint64_t address, void* buffer, size_t size) override
+    {
+        return core_.Read(address, buffer, size);
+    }
+
+    std::string_view View(uint64_t address, size_t size) override
+    {
+        return core_.View(address, size);
+    }
+
+    const char* name() const override { return name_.c_str(); }
+
+    bool Open(const std::string& path)
+    {
+        std::string error;
+        name_ = "mapped " + path;
+        return core_.Open(path, error);
+    }
+
+  private:
+    CoreFile core_;
+    std::string name_;
+};
+
+#ifdef __linux__
+class ProcMemSource : public MemorySource
+{
+  public:
+    ProcMemSource(int fd, uint64_t pid) : fd_(fd), name_("/proc/" + std::to_string(pid) + "/mem")
+    {
+    }
+    ~ProcMemSource() override { close(fd_); }
+
+    size_t Read(uint64_t address, void* buffer, size_t size) override
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t n = pread(fd_, static_cast<char*>(buffer) + done, size - done,
+                              static_cast<off_t>(address + done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += static_cast<size_t>(n);
+        }
+        return done;
+    }
+
+    const char* name() const override { return name_.c_str(); }
+
+  private:
+    int fd_;
+    std::string name_;
+};
+
+// process_vm_readv fails a transfer at iovec granularity, so remote ranges are
+// split into pages and a chunk is read in one batched call
+class VmReadvSource : public MemorySource
+{
+  public:
+    explicit VmReadvSource(uint64_t pid)
+        : pid_(static_cast<pid_t>(pid)), name_("process_vm_readv(" + std::to_string(pid) + ")")
+    {
+    }
+
+    size_t Read(uint64_t address, void* buffer, size_t size) override
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            iovec local = {static_cast<char*>(buffer) + done, 0};
+            iovec remote[kMaxIov];
+            size_t count = 0;
+            uint64_t at = address + done;
+            while (count < kMaxIov && local.iov_len < size - done)
+            {
+                size_t page = std::min<size_t>(kPageSize - at % kPageSize,
+                                               size - done - local.iov_len);
+                remote[count++] = {reinterpret_cast<void*>(at), page};
+                local.iov_len += page;
+                at += page;
+            }
+            ssize_t n = process_vm_readv(pid_, &local, 1, remote, count, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += static_cast<size_t>(n);
+            if (static_cast<size_t>(n) < local.iov_len)
+                break;
+        }
+        return done;
+    }
+
+    const char* name() const override { return name_.c_str(); }
+
+  private:
+    static constexpr size_t kMaxIov = 256; // 1 MB of pages per call
+    static constexpr uint64_t kPageSize = 4096;
+    pid_t pid_;
+    std::string name_;
+};
+
+// Direct reads see the trap opcodes of enabled software breakpoints, LLDB's
+// internal ones included. Executable mappings, the only place they can be,
+// are therefore read through the SB API, which restores the original bytes
+// (and fails while the process runs, so code is then skipped, not misread).
+class CodeThroughSBSource : public MemorySource
+{
+  public:
+    CodeThroughSBSource(std::unique_ptr<MemorySource> direct, lldb::SBProcess process,
+                        uint64_t pid)
+        : direct_(std::move(direct)), sb_(process)
+    {
+        ForEachMapping(pid,
+                       [&](const MapEntry& entry)
+                       {
+                           if (entry.exec)
+                               code_.emplace_back(entry.start, entry.end);
+                           return true;
+                       });
+    }
+
+    size_t Read(uint64_t address, void* buffer, size_t size) override
+    {
+        size_t done = 0;
+        char* out = static_cast<char*>(buffer);
+        while (done < size)
+        {
+            uint64_t at = address + done;
+            size_t want = size - done;
+            // First code mapping ending after at (maps are sorted)
+            auto code = std::upper_bound(code_.begin(), code_.end(), at,
+                                         [](uint64_t a, const auto& range)
+                                         { return a < range.second; });
+            bool in_code = code != code_.end() && code->first <= at;
+            if (in_code)
+                want = std::min<uint64_t>(want, code->second - at);
+            else if (code != code_.end())
+                want = std::min<uint64_t>(want, code->first - at);
+
+            size_t got = in_code ? sb_.Read(at, out + done, want)
+                                 : direct_->Read(at, out + done, want);
+            done += got;
+            if (got < want)
+                break;
+        }
+        return done;
+    }
+
+    const char* name() const override { return direct_->name(); }
+
+  private:
+    std::unique_ptr<MemorySource> direct_;
+    SBMemorySource sb_;
+    std::vector<std::pair<uint64_t, uint64_t>> code_; // Executable [start, end)
+};
+
+// Whether source can read the page holding the selected thread's PC, or
+// while running (no PC) the first readable mapping
+bool Probe(MemorySource& source, lldb::SBProcess process, uint64_t pid)
+{
+    uint64_t address = process.GetSelectedThread().GetFrameAtIndex(0).GetPC();
+    if (address == LLDB_INVALID_ADDRESS || address == 0)
+    {
+        address = 0;
+        ForEachMapping(pid,
+                       [&](const MapEntry& entry)
+                       {
+                           if (entry.read && entry.path.rfind("[v", 0) != 0)
+                               address = entry.start;
+                           return address == 0;
+                       });
+        if (address == 0)
+            return false;
+    }
+    char byte = 0;
+    return source.Read(address, &byte, 1) == 1;
+}
+#endif
+} // namespace
+
+std::unique_ptr<MemorySource> OpenMemorySource(lldb::SBProcess process, bool live)
+{
+    const char* plugin = process.GetPluginName();
+    if (plugin && std::string(plugin) == "elf-core")
+    {
+        char path[4096] = {};
+        lldb::SBFileSpec core = process.GetCoreFile();
+        if (core.IsValid() && core.GetPath(path, sizeof(path)))
+        {
+            auto source = std::make_unique<CoreMemorySource>();
+            if (source->Open(path))
+                return source;
+        }
+    }
+
+#ifdef __linux__
+    // Direct reads only while stopped, unless torn reads of a running process
+    // are acceptable
+    lldb::StateType state = process.GetState();
+    bool readable = state == lldb::eStateStopped ||
+                    (live && (state == lldb::eStateRunning || state == lldb::eStateStepping));
+    uint64_t pid = readable ? LocalProcfsPid(process) : 0;
+    if (pid)
+    {
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/%llu/mem", static_cast<unsigned long long>(pid));
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            auto source = std::make_unique<ProcMemSource>(fd, pid);
+            if (Probe(*source, process, pid))
+                return std::make_unique<CodeThroughSBSource>(std::move(source), process, pid);
+        }
+        auto source = std::make_unique<VmReadvSource>(pid);
+        if (Probe(*source, process, pid))
+            return std::make_unique<CodeThroughSBSource>(std::move(source), process, pid);
+    }
+#endif
+    return std::make_unique<SBMemorySource>(process);
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <lldb/API/LLDB.h>
+#include <memory>
+#include <string_view>
+
+namespace lldb_copilot
+{
+
+// Bulk reads of debuggee memory for scanning tools. Local stopped Linux
+// processes are read directly (pread on /proc/<pid>/mem, or process_vm_readv)
+// instead of through lldb-server's small memory packets, and ELF core files are
+// mapped and served in place; everything else goes through
+// SBProcess::ReadMemory. Executable mappings of a live process are always
+// read through the SB API, so breakpoint opcodes never show up in the data.
+class MemorySource
+{
+  public:
+    virtual ~MemorySource() = default;
+
+    // Read up to size bytes at address. Returns the number of bytes read,
+    // which is short when an unreadable page is reached (0 = none readable).
+    virtual size_t Read(uint64_t address, void* buffer, size_t size) = 0;
+
+    // Bytes at [address, address + size) without copying, if the source holds
+    // them in memory (mapped core files); empty otherwise
+    virtual std::string_view View(uint64_t, size_t) { return {}; }
+
+    // Short description for tool output, e.g. "/proc/1234/mem"
+    virtual const char* name() const = 0;
+};
+
+// Chunk size scanners should read at a time
+constexpr size_t kMemoryChunkSize = 1024 * 1024;
+
+// Fastest source usable for process (never null for a valid process). With
+// live, a running local process is read directly too (low-intrusion mode):
+// each read is a snapshot that may change while the process runs.
+std::unique_ptr<MemorySource> OpenMemorySource(lldb::SBProcess process, bool live = false);
+
+} // namespace lldb_copilot
@@ -0,0 +1,395 @@
+#include "name_compactor.hpp"
+
+#include <cstdlib>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define LLDB_COPILOT_HAVE_CXXABI 1
+#endif
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr size_t kMinAliasLength = 32; // Shorter types are left as is
+constexpr size_t kMaxTemplateLength = 8192;
+
+bool IsNameChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_';
+}
+
+std::string_view Trim(std::string_view s)
+{
+    while (!s.empty() && s.front() == ' ')
+        s.remove_prefix(1);
+    while (!s.empty() && s.back() == ' ')
+        s.remove_suffix(1);
+    return s;
+}
+
+// Index of the '>' closing the '<' at open, or npos. Templates never span
+// lines or string quotes; "->" is not a closing bracket.
+size_t MatchClose(std::string_view text, size_t open)
+{
+    int depth = 0;
+    size_t end = std::min(text.size(), open + kMaxTemplateLength);
+    for (size_t j = open; j < end; j++)
+    {
+        char c = text[j];
+        if (c == '<')
+            depth++;
+        else if (c == '>' && !(j > 0 && text[j - 1] == '-') && --depth == 0)
+            return j;
+        else if (c == '\n' || c == '"')
+            return std::string_view::npos;
+    }
+    return std::string_view::npos;
+}
+
+// Split template arguments at top-level commas
+std::vector<std::string_view> SplitArgs(std::string_view args)
+{
+    std::vector<std::string_view> parts;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        char c = args[i];
+        if (c == '<' || c == '(' || c == '[')
+            depth++;
+        else if ((c == '>' && !(i > 0 && args[i - 1] == '-')) || c == ')' || c == ']')
+            depth--;
+        else if (c == ',' && depth == 0)
+        {
+            parts.push_back(Trim(args.substr(start, i - start)));
+            start = i + 1;
+        }
+    }
+    parts.push_back(Trim(args.substr(start)));
+    return parts;
+}
+
+// True if arg is the default for its position given the preceding arguments
+bool IsDefaultArg(std::string_view name, const std::string& arg,
+                  const std::vector<std::string>& args)
+{
+    const std::string& a0 = args[0];
+    if (arg == "std::allocator<" + a0 + ">" || arg == "std::char_traits<" + a0 + ">" ||
+        arg == "std::less<" + a0 + ">" || arg == "std::hash<" + a0 + ">" ||
+        arg == "std::equal_to<" + a0 + ">" || arg == "std::default_delete<" + a0 + ">")
+        return true;
+    if (args.size() > 1)
+    {
+        const std::string& a1 = args[1];
+        if (arg == "std::allocator<std::pair<const " + a0 + ", " + a1 + ">>" ||
+            arg == "std::allocator<std::pair<" + a0 + " const, " + a1 + ">>")
+            return true;
+    }
+    return (name == "std::stack" || name == "std::queue") && arg == "std::deque<" + a0 + ">";
+}
+
+// Position of alias in text as a whole token ("$T1" but not "$T12"), or npos
+size_t FindAlias(const std::string& text, const std::string& alias, size_t from = 0)
+{
+    for (size_t pos = text.find(alias, from); pos != std::string::npos;
+         pos = text.find(alias, pos + 1))
+    {
+        size_t end = pos + alias.size();
+        if (end == text.size() || !(text[end] >= '0' && text[end] <= '9'))
+            return pos;
+    }
+    return std::string::npos;
+}
+
+void RenameAlias(std::string& text, const std::string& alias, const std::string& renamed)
+{
+    for (size_t pos = FindAlias(text, alias); pos != std::string::npos;
+         pos = FindAlias(text, alias, pos + renamed.size()))
+        text.replace(pos, alias.size(), renamed);
+}
+
+// Length of the standard library's inline namespace at pos ("std::__1::" in
+// libc++, "std::__cxx11::" in libstdc++), or 0; it is written as "std::"
+size_t InlineStdLength(std::string_view text, size_t pos)
+{
+    if (text[pos] != 's')
+        return 0;
+    for (std::string_view ns : {std::string_view("std::__1::"), std::string_view("std::__cxx11::")})
+        if (text.compare(pos, ns.size(), ns) == 0)
+            return ns.size();
+    return 0;
+}
+
+void AppendWithoutInlineStd(std::string& out, std::string_view text)
+{
+    for (size_t i = 0; i < text.size();)
+    {
+        if (size_t n = InlineStdLength(text, i))
+        {
+            out += "std::";
+            i += n;
+        }
+        else
+        {
+            out += text[i++];
+        }
+    }
+}
+} // namespace
+
+void NameCompactor::Reset()
+{
+    stats_ = CompactionStats();
+    demangled_.clear();
+    aliases_.clear();
+    seen_.clear();
+    pending_.clear();
+    new_definitions_.clear();
+    next_alias_ = 1;
+    checkpoint_ = Saved();
+}
+
+void NameCompactor::Checkpoint()
+{
+    checkpoint_ = {aliases_, seen_, next_alias_};
+}
+
+void NameCompactor::Rollback()
+{
+    aliases_ = checkpoint_.aliases;
+    seen_ = checkpoint_.seen;
+    next_alias_ = checkpoint_.next_alias;
+}
+
+std::string NameCompactor::Demangle(std::string_view text)
+{
+    std::string out;
+    out.reserve(text.size());
+    size_t i = 0;
+    while (i < text.size())
+    {
+        if (size_t n = InlineStdLength(text, i))
+        {
+            out += "std::";
+            i += n;
+            continue;
+        }
+
+        bool boundary = i == 0 || !IsNameChar(text[i - 1]);
+        size_t skip = text.compare(i, 3, "__Z") == 0 ? 1 : 0; // Darwin extra underscore
+        if (!boundary || text.compare(i + skip, 2, "_Z") != 0)
+        {
+            out += text[i++];
+            continue;
+        }
+
+        size_t end = i + skip + 2;
+        while (end < text.size() && (IsNameChar(text[end]) || text[end] == '.'))
+            end++;
+        std::string symbol(text.substr(i + skip, end - i - skip));
+        auto it = demangled_.find(symbol);
+        if (it == demangled_.end())
+        {
+            std::string name = symbol;
+#if LLDB_COPILOT_HAVE_CXXABI
+            int status = 0;
+            char* buf = abi::__cxa_demangle(symbol.c_str(), nullptr, nullptr, &status);
+            if (status == 0 && buf)
+            {
+                name.clear();
+                AppendWithoutInlineStd(name, buf);
+                stats_.demangled++;
+            }
+            std::free(buf);
+#endif
+            it = demangled_.emplace(symbol, name).first;
+        }
+        out += it->second == symbol ? std::string(text.substr(i, end - i)) : it->second;
+        i = end;
+    }
+    return out;
+}
+
+NameCompactor::Span NameCompactor::RewriteText(std::string_view text)
+{
+    Span out;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        size_t close = std::string_view::npos;
+        size_t start = i;
+        if (text[i] == '<' && i > 0 && IsNameChar(text[i - 1]))
+        {
+            // Qualified name before '<' (already copied to the output)
+            while (start > 0)
+            {
+                if (IsNameChar(text[start - 1]))
+                    start--;
+                else if (start >= 2 && text[start - 1] == ':' && text[start - 2] == ':')
+                    start -= 2;
+                else
+                    break;
+            }
+            std::string_view name = text.substr(start, i - start);
+            bool is_operator = name.size() >= 8 && name.substr(name.size() - 8) == "operator";
+            if (!is_operator)
+                close = MatchClose(text, i);
+        }
+        if (close == std::string_view::npos)
+        {
+            out.expanded += text[i];
+            out.rendered += text[i++];
+            continue;
+        }
+
+        size_t name_size = i - start;
+        Span t = RewriteTemplate(text.substr(start, name_size), text.substr(i + 1, close - i - 1));
+        out.expanded.resize(out.expanded.size() - name_size);
+        out.rendered.resize(out.rendered.size() - name_size);
+        out.expanded += t.expanded;
+        out.rendered += t.rendered;
+        i = close + 1;
+    }
+    return out;
+}
+
+NameCompactor::Span NameCompactor::RewriteTemplate(std::string_view name, std::string_view args)
+{
+    std::vector<std::string> expanded;
+    std::vector<std::string> rendered;
+    for (std::string_view arg : SplitArgs(args))
+    {
+        Span a = RewriteText(arg);
+        expanded.push_back(std::move(a.expanded));
+        rendered.push_back(std::move(a.rendered));
+    }
+    while (expanded.size() > 1 && IsDefaultArg(name, expanded.back(), expanded))
+    {
+        expanded.pop_back();
+        rendered.pop_back();
+    }
+
+    Span out;
+    if (name == "std::basic_string" && expanded.size() == 1 &&
+        (expanded[0] == "char" || expanded[0] == "wchar_t"))
+    {
+        out.expanded = expanded[0] == "char" ? "std::string" : "std::wstring";
+        out.rendered = out.expanded;
+        return out;
+    }
+    if (name == "std::basic_string_view" && expanded.size() == 1 && expanded[0] == "char")
+    {
+        out.expanded = out.rendered = "std::string_view";
+        return out;
+    }
+
+    out.expanded = std::string(name) + "<";
+    out.rendered = out.expanded;
+    for (size_t i = 0; i < expanded.size(); i++)
+    {
+        out.expanded += (i ? ", " : "") + expanded[i];
+        out.rendered += (i ? ", " : "") + rendered[i];
+    }
+    out.expanded += ">";
+    out.rendered += ">";
+
+    if (counting_)
+    {
+        pending_[out.expanded]++;
+        return out;
+    }
+
+    auto alias = aliases_.find(out.expanded);
+    if (alias == aliases_.end() && out.expanded.size() >= kMinAliasLength &&
+        seen_[out.expanded] + pending_[out.expanded] >= 2)
+    {
+        std::string name_alias = "$T" + std::to_string(next_alias_++);
+        new_definitions_.push_back(name_alias + " = " + out.rendered);
+        alias = aliases_.emplace(out.expanded, name_alias).first;
+    }
+    if (alias != aliases_.end())
+        out.rendered = alias->second;
+    return out;
+}
+
+std::string NameCompactor::Compact(std::string_view text)
+{
+    stats_.outputs++;
+    stats_.bytes_in += text.size();
+
+    std::string out = Demangle(text);
+    if (out.find('<') == std::string::npos)
+    {
+        stats_.bytes_out += out.size();
+        return out;
+    }
+
+    // Count first so that a type recurring within this output is aliased
+    // from its first occurrence
+    counting_ = true;
+    pending_.clear();
+    RewriteText(out);
+    counting_ = false;
+    new_definitions_.clear();
+    size_t first_alias = next_alias_;
+    out = RewriteText(out).rendered;
+    for (auto& [type, count] : pending_)
+        seen_[type] += count;
+    pending_.clear();
+
+    // Keep definitions referenced by the output or by a kept later definition;
+    // drop aliases of types only seen inside an aliased outer type
+    std::vector<std::pair<std::string, std::string>> kept; // Alias, definition
+    std::string referenced = out;
+    for (size_t i = new_definitions_.size(); i-- > 0;)
+    {
+        const std::string& def = new_definitions_[i];
+        std::string alias = def.substr(0, def.find(' '));
+        if (FindAlias(referenced, alias) != std::string::npos)
+        {
+            kept.insert(kept.begin(), {alias, def});
+            referenced += "\n" + def;
+            continue;
+        }
+        for (auto it = aliases_.begin(); it != aliases_.end(); ++it)
+            if (it->second == alias)
+            {
+                aliases_.erase(it);
+                break;
+            }
+    }
+    new_definitions_.clear();
+
+    // Renumber kept aliases so that numbering has no gaps. A kept alias is
+    // never renamed to a number still held by a later one.
+    next_alias_ = first_alias;
+    for (auto& [alias, def] : kept)
+    {
+        std::string renamed = "$T" + std::to_string(next_alias_++);
+        if (renamed == alias)
+            continue;
+        RenameAlias(out, alias, renamed);
+        for (auto& entry : kept)
+            RenameAlias(entry.second, alias, renamed);
+        for (auto& entry : aliases_)
+            if (entry.second == alias)
+                entry.second = renamed;
+        alias = renamed;
+    }
+
+    if (!kept.empty())
+    {
+        std::string header = "Type aliases (valid for the rest of this conversation):\n";
+        for (const auto& [alias, def] : kept)
+            header += "  " + def + "\n";
+        out = header + "\n" + out;
+        stats_.aliases += kept.size();
+    }
+    stats_.bytes_out += out.size();
+    return out;
+}
+
+} // namespace lldb_copilot
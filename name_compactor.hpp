@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Byte counters for name compaction (shown by "agent stats")
+struct CompactionStats
+{
+    size_t outputs = 0;
+    size_t bytes_in = 0;
+    size_t bytes_out = 0; // Including alias definitions
+    size_t demangled = 0; // Mangled symbols expanded (cache misses)
+    size_t aliases = 0;   // Aliases defined this session
+
+    size_t Saved() const { return bytes_in > bytes_out ? bytes_in - bytes_out : 0; }
+};
+
+// Shortens C++ names in tool output for the rest of a conversation:
+//  - mangled symbols (_Z...) are demangled, through a per-session cache
+//  - std::__1:: / std::__cxx11:: become std::, default template arguments
+//    (allocators, comparators, hashers, char_traits, deleters) are dropped
+//    and std::basic_string<char> becomes std::string
+//  - long template types that recur are replaced by aliases ($T1, $T2, ...)
+//    whose expansion is prepended to the output that first uses them
+class NameCompactor
+{
+  public:
+    std::string Compact(std::string_view text);
+
+    // Forget aliases and caches (new conversation)
+    void Reset();
+
+    // Save alias state, and restore it when results produced since then were
+    // never seen by the model (failed query), so their aliases get redefined
+    void Checkpoint();
+    void Rollback();
+
+    const CompactionStats& stats() const { return stats_; }
+
+  private:
+    struct Span
+    {
+        std::string expanded; // Simplified without aliases (identifies a type)
+        std::string rendered; // As emitted, with aliases substituted
+    };
+
+    // Copy text with _Z symbols demangled and the standard library's inline
+    // namespaces dropped, in a single pass
+    std::string Demangle(std::string_view text);
+
+    // Rewrite every template-id in text. In counting mode occurrences are
+    // only counted and no alias is created.
+    Span RewriteText(std::string_view text);
+    Span RewriteTemplate(std::string_view name, std::string_view args);
+
+    bool counting_ = false;
+    size_t next_alias_ = 1;
+    std::unordered_map<std::string, std::string> demangled_;
+    std::unordered_map<std::string, std::string> aliases_; // Expansion -> alias
+    std::unordered_map<std::string, size_t> seen_;         // Expansion -> occurrences
+    std::unordered_map<std::string, size_t> pending_;      // Counts of the current output
+    std::vector<std::string> new_definitions_;
+    CompactionStats stats_;
+
+    struct Saved
+    {
+        std::unordered_map<std::string, std::string> aliases;
+        std::unordered_map<std::string, size_t> seen;
+        size_t next_alias = 1;
+    } checkpoint_;
+};
+
+} // namespace lldb_copilot
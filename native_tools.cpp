@@ -0,0 +1,910 @@
+#include "native_tools.hpp"
+#include "procfs.hpp"
+#include "progress.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+using json = nlohmann::json;
+
+namespace
+{
+constexpr uint32_t kDefaultFrameCount = 8;
+constexpr uint32_t kMaxFrameIndex = 4096;
+constexpr uint32_t kMaxThreadIndex = 1 << 20; // Highest thread index ID in a list
+constexpr uint32_t kMaxChildren = 16;
+constexpr int kMaxDepth = 4;
+constexpr uint32_t kDefaultUnwindBudget = 100000;
+constexpr uint32_t kMaxCyclePeriod = 8;  // Longest A->B->... cycle detected
+constexpr uint32_t kMinCycleRepeats = 3; // Repeats before a cycle is collapsed
+constexpr uint32_t kSkipCycleRepeats = 256; // Repeats before the rest of a cycle is skipped
+constexpr uint32_t kBottomWindow = 128;     // Outermost frames listed after a skip
+constexpr uint32_t kProbeStride = 4096;     // Frames unwound per probe for the bottom
+constexpr uint32_t kProgressStride = 256;
+
+lldb::SBThread ResolveThread(lldb::SBProcess& process, uint32_t index_id)
+{
+    if (index_id == 0)
+        return process.GetSelectedThread();
+    return process.GetThreadByIndexID(index_id);
+}
+
+// Parse "0-7", "3" or "0,2,5" into numbers below limit, in the order given.
+// Malformed parts are ignored.
+std::vector<uint32_t> ParseRanges(const std::string& spec, uint32_t limit)
+{
+    std::vector<uint32_t> result;
+    size_t pos = 0;
+    while (pos < spec.size())
+    {
+        size_t comma = spec.find(',', pos);
+        std::string part = spec.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                       : comma - pos);
+        pos = comma == std::string::npos ? spec.size() : comma + 1;
+        try
+        {
+            size_t dash = part.find('-');
+            uint32_t lo = static_cast<uint32_t>(std::stoul(part.substr(0, dash)));
+            uint32_t hi = dash == std::string::npos
+                              ? lo
+                              : static_cast<uint32_t>(std::stoul(part.substr(dash + 1)));
+            for (uint32_t i = lo; i <= hi && i < limit; i++)
+                result.push_back(i);
+        }
+        catch (...)
+        {
+            // Ignore malformed parts
+        }
+    }
+    return result;
+}
+
+// Parse "0-7", "3", "0,2,5" or "all" into frame indexes. Only "all" needs
+// the frame count, which forces a full unwind.
+std::vector<uint32_t> ParseFrameSpec(const std::string& spec, lldb::SBThread& thread)
+{
+    std::vector<uint32_t> result;
+    if (spec == "all")
+    {
+        uint32_t num_frames = std::min(thread.GetNumFrames(), kMaxFrameIndex);
+        for (uint32_t i = 0; i < num_frames; i++)
+            result.push_back(i);
+        return result;
+    }
+    if (spec.empty())
+    {
+        for (uint32_t i = 0; i < kDefaultFrameCount; i++)
+            result.push_back(i);
+        return result;
+    }
+    return ParseRanges(spec, kMaxFrameIndex);
+}
+
+json DescribeValue(lldb::SBValue value, int depth)
+{
+    const char* v = value.GetValue();
+    const char* summary = value.GetSummary();
+    std::string text = v ? v : "";
+    if (summary && *summary)
+        text += text.empty() ? summary : std::string(" ") + summary;
+
+    if (depth <= 0 || !value.MightHaveChildren())
+    {
+        if (text.empty())
+        {
+            lldb::SBError error = value.GetError();
+            if (error.Fail() && error.GetCString())
+                return std::string("<") + error.GetCString() + ">";
+            return value.MightHaveChildren() ? "{...}" : "";
+        }
+        return text;
+    }
+
+    json children = json::object();
+    uint32_t n = value.GetNumChildren();
+    for (uint32_t i = 0; i < n && i < kMaxChildren; i++)
+    {
+        lldb::SBValue child = value.GetChildAtIndex(i);
+        const char* name = child.GetName();
+        children[name ? name : "[" + std::to_string(i) + "]"] = DescribeValue(child, depth - 1);
+    }
+    if (n > kMaxChildren)
+        children["..."] = std::to_string(n - kMaxChildren) + " more";
+    if (!text.empty())
+        children["="] = text;
+    return children;
+}
+
+// Format sorted numbers as ranges: 1-3,7,9-10
+std::string FormatRanges(const std::vector<uint32_t>& ids)
+{
+    std::string text;
+    for (size_t i = 0; i < ids.size();)
+    {
+        size_t j = i;
+        while (j + 1 < ids.size() && ids[j + 1] == ids[j] + 1)
+            j++;
+        if (!text.empty())
+            text += ",";
+        text += std::to_string(ids[i]);
+        if (j > i)
+            text += "-" + std::to_string(ids[j]);
+        i = j + 1;
+    }
+    return text;
+}
+
+// Annotates pointer-like values with their symbol or memory region. Each
+// distinct value is resolved once.
+class AddressAnnotator
+{
+  public:
+    AddressAnnotator(lldb::SBTarget target, lldb::SBProcess process)
+        : target_(target), process_(process)
+    {
+    }
+
+    std::string Annotate(uint64_t value)
+    {
+        if (value < 0x10000)
+            return "";
+        auto it = cache_.find(value);
+        if (it != cache_.end())
+            return it->second;
+
+        std::string note;
+        lldb::SBAddress addr = target_.ResolveLoadAddress(value);
+        lldb::SBSymbol symbol = addr.GetSymbol();
+        if (symbol.IsValid() && symbol.GetName())
+        {
+            uint64_t start = symbol.GetStartAddress().GetLoadAddress(target_);
+            note = std::string("<") + symbol.GetName();
+            if (start != LLDB_INVALID_ADDRESS && value > start)
+                note += "+" + std::to_string(value - start);
+            note += ">";
+        }
+        else if (LocalRegions())
+        {
+            const RegionIndex::Region* region = regions_.Find(value);
+            if (region && region->read)
+            {
+                const std::string& name = regions_.Name(*region);
+                note = "[" + name + (name.empty() ? "" : " ") + "r" + (region->write ? "w" : "-") +
+                       (region->exec ? "x" : "-") + "]";
+            }
+        }
+        else
+        {
+            lldb::SBMemoryRegionInfo region;
+            if (process_.GetMemoryRegionInfo(value, region).Success() && region.IsMapped() &&
+                region.IsReadable())
+            {
+                const char* name = region.GetName();
+                note = std::string("[") + (name && *name ? name : "") +
+                       (name && *name ? " " : "") + (region.IsReadable() ? "r" : "-") +
+                       (region.IsWritable() ? "w" : "-") + (region.IsExecutable() ? "x" : "-") +
+                       "]";
+            }
+        }
+        cache_.emplace(value, note);
+        return note;
+    }
+
+  private:
+    // Regions from /proc, loaded on first use; false for remote processes and
+    // cores, which are queried one address at a time instead
+    bool LocalRegions()
+    {
+        if (!regions_tried_)
+        {
+            regions_tried_ = true;
+            regions_.Load(process_, false);
+        }
+        return regions_.loaded();
+    }
+
+    lldb::SBTarget target_;
+    lldb::SBProcess process_;
+    std::unordered_map<uint64_t, std::string> cache_;
+    RegionIndex regions_;
+    bool regions_tried_ = false;
+};
+
+bool RegisterSetSelected(const std::string& set, const std::string& set_name, uint32_t index)
+{
+    if (set == "all")
+        return true;
+    if (set.empty() || set == "gpr")
+        return index == 0 || set_name.find("General") != std::string::npos;
+    if (set == "vector" || set == "fp")
+        return set_name.find("Vector") != std::string::npos ||
+               set_name.find("Floating") != std::string::npos ||
+               set_name.find("AVX") != std::string::npos ||
+               set_name.find("SVE") != std::string::npos;
+    return true; // Explicit register names: search every set
+}
+
+// Register value as a compact hex string (leading zero bytes dropped)
+std::string RegisterHex(lldb::SBValue reg, uint64_t* scalar)
+{
+    lldb::SBData data = reg.GetData();
+    lldb::SBError error;
+    size_t size = data.GetByteSize();
+    std::vector<uint8_t> bytes(size);
+    if (size == 0 || data.ReadRawData(error, 0, bytes.data(), size) != size || error.Fail())
+    {
+        const char* v = reg.GetValue();
+        return v ? v : "?";
+    }
+
+    // Register data is target byte order; print most significant byte first
+    if (data.GetByteOrder() != lldb::eByteOrderBig)
+        std::reverse(bytes.begin(), bytes.end());
+    size_t first = 0;
+    while (first + 1 < bytes.size() && bytes[first] == 0)
+        first++;
+
+    std::string hex = "0x";
+    char buf[3];
+    for (size_t i = first; i < bytes.size(); i++)
+    {
+        std::snprintf(buf, sizeof(buf), i == first ? "%x" : "%02x", bytes[i]);
+        hex += buf;
+    }
+
+    if (scalar)
+        *scalar = size <= 8 ? reg.GetValueAsUnsigned(0) : 0;
+    return hex;
+}
+
+// Resumable state of dbg_stack_locals: frames collected so far
+struct StackLocalsState
+{
+    json frames = json::array();
+    size_t next = 0; // Next position in the frame spec
+    size_t used = 0; // Bytes of budget consumed
+};
+
+// Resumable state of dbg_registers_all: one row per register (in first-seen
+// order) mapping each distinct value to the thread index IDs holding it
+struct RegistersState
+{
+    std::vector<std::string> row_order;
+    std::unordered_map<std::string, std::map<std::string, std::vector<uint32_t>>> rows;
+    std::unordered_map<std::string, uint64_t> scalars;
+    std::vector<uint32_t> thread_ids;
+    uint32_t next = 0; // Next thread index to read
+};
+
+// Resumable state of dbg_backtrace: one function key (symbol start address,
+// or PC without a symbol) per frame unwound so far
+struct BacktraceState
+{
+    std::vector<uint64_t> functions;
+    std::unordered_map<uint64_t, uint64_t> function_of_pc; // Each PC symbolized once
+    uint32_t cycle_period = 0; // Period of the cycle the unwind is currently in
+    uint32_t cycle_since = 0;  // Frame the current cycle was detected at
+    // Frames [skipped_from, skipped_to) inside a long cycle were not
+    // symbolized; functions holds the frames above them followed by the ones
+    // below
+    uint32_t skipped_from = 0;
+    uint32_t skipped_to = 0;
+    bool bottom = false; // Reached the outermost frame
+};
+
+// Shortest period p such that keys[i..limit) repeats with period p at least
+// kMinCycleRepeats times, or 0
+uint32_t CyclePeriodAt(const std::vector<uint64_t>& keys, size_t i,
+                       size_t limit = std::numeric_limits<size_t>::max())
+{
+    limit = std::min(limit, keys.size());
+    for (uint32_t p = 1; p <= kMaxCyclePeriod; p++)
+    {
+        size_t needed = static_cast<size_t>(p) * kMinCycleRepeats;
+        if (i + needed > limit)
+            break;
+        bool periodic = true;
+        for (size_t j = i + p; j < i + needed && periodic; j++)
+            periodic = keys[j] == keys[j - p];
+        if (periodic)
+            return p;
+    }
+    return 0;
+}
+
+std::string FormatFrame(lldb::SBFrame frame)
+{
+    char pc[32];
+    std::snprintf(pc, sizeof(pc), "0x%" PRIx64, frame.GetPC());
+    std::string line = "#" + std::to_string(frame.GetFrameID()) + " " + pc + " ";
+    const char* module = frame.GetModule().GetFileSpec().GetFilename();
+    if (module)
+        line += std::string(module) + "`";
+    const char* fn = frame.GetDisplayFunctionName();
+    line += fn ? fn : "??";
+    lldb::SBLineEntry entry = frame.GetLineEntry();
+    if (entry.IsValid() && entry.GetFileSpec().GetFilename())
+        line += std::string(" at ") + entry.GetFileSpec().GetFilename() + ":" +
+                std::to_string(entry.GetLine());
+    return line;
+}
+
+json CollectValues(const lldb::SBValueList& list, int depth)
+{
+    json values = json::object();
+    for (uint32_t i = 0; i < list.GetSize(); i++)
+    {
+        lldb::SBValue value = list.GetValueAtIndex(i);
+        const char* name = value.GetName();
+        const char* type = value.GetTypeName();
+        std::string key = name ? name : "?";
+        if (type)
+            key += std::string(":") + type;
+        values[key] = DescribeValue(value, depth);
+    }
+    return values;
+}
+
+std::string FormatBytes(uint64_t bytes)
+{
+    char buf[32];
+    if (bytes >= 1024ull * 1024 * 1024)
+        std::snprintf(buf, sizeof(buf), "%.1fG", bytes / (1024.0 * 1024.0 * 1024.0));
+    else if (bytes >= 1024 * 1024)
+        std::snprintf(buf, sizeof(buf), "%.1fM", bytes / (1024.0 * 1024.0));
+    else
+        std::snprintf(buf, sizeof(buf), "%.1fK", bytes / 1024.0);
+    return buf;
+}
+
+std::string FormatRegion(const RegionIndex& index, const RegionIndex::Region& region)
+{
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "0x%" PRIx64 "-0x%" PRIx64 " %c%c%c %8s ", region.start,
+                  region.end, region.read ? 'r' : '-', region.write ? 'w' : '-',
+                  region.exec ? 'x' : '-', FormatBytes(region.end - region.start).c_str());
+    return buf + index.Name(region);
+}
+
+const char* RegionKind(const std::string& name, const RegionIndex::Region& region)
+{
+    if (!region.read && !region.write && !region.exec)
+        return "no-access (guard)";
+    if (name == "[heap]")
+        return "heap";
+    if (name.rfind("[stack", 0) == 0)
+        return "stack";
+    if (!name.empty() && name[0] == '[')
+        return "special";
+    if (name.empty())
+        return region.exec ? "anon exec (JIT)" : region.write ? "anon rw" : "anon ro";
+    if (region.exec)
+        return "file code";
+    return region.write ? "file data rw" : "file data ro";
+}
+
+} // namespace
+
+std::string CollectStackLocals(lldb::SBDebugger& debugger, uint32_t thread_id,
+                               const std::string& frames, int depth, size_t budget)
+{
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    lldb::SBProcess process = target.GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+
+    lldb::SBThread thread = ResolveThread(process, thread_id);
+    if (!thread.IsValid())
+        return "Error: no thread with index " + std::to_string(thread_id);
+
+    depth = std::clamp(depth, 0, kMaxDepth);
+    std::vector<uint32_t> indexes = ParseFrameSpec(frames, thread);
+
+    json out;
+    out["thread"] = thread.GetIndexID();
+    out["tid"] = thread.GetThreadID();
+
+    std::string key = StopKey(debugger) + "stack_locals|" + std::to_string(thread.GetIndexID()) +
+                      "|" + frames + "|" + std::to_string(depth);
+    auto state = GetResumableOperations().Acquire<StackLocalsState>(key);
+    json& frame_list = state->frames;
+    OperationProgress progress(debugger, "Collecting stack locals", indexes.size());
+    progress.Increment(state->next);
+
+    for (size_t n = state->next; n < indexes.size(); n++)
+    {
+        lldb::SBFrame frame = thread.GetFrameAtIndex(indexes[n]);
+        if (!frame.IsValid())
+            continue; // Past the bottom of the stack
+
+        json f;
+        f["#"] = indexes[n];
+        const char* fn = frame.GetDisplayFunctionName();
+        f["fn"] = fn ? fn : "??";
+        lldb::SBLineEntry line = frame.GetLineEntry();
+        if (line.IsValid() && line.GetFileSpec().GetFilename())
+            f["at"] = std::string(line.GetFileSpec().GetFilename()) + ":" +
+                      std::to_string(line.GetLine());
+        f["args"] = CollectValues(frame.GetVariables(true, false, false, true), depth);
+        f["locals"] = CollectValues(frame.GetVariables(false, true, false, true), depth);
+
+        size_t size = f.dump().size();
+        if (state->used + size > budget && !frame_list.empty())
+        {
+            out["truncated"] = "budget reached; " + std::to_string(indexes.size() - n) +
+                               " frame(s) omitted starting at #" + std::to_string(indexes[n]);
+            break;
+        }
+        state->used += size;
+        frame_list.push_back(std::move(f));
+        state->next = n + 1;
+
+        if (!progress.Increment(1, fn ? fn : "") && state->next < indexes.size())
+        {
+            out["cancelled"] = "interrupted after " + std::to_string(state->next) + " of " +
+                               std::to_string(indexes.size()) +
+                               " frames; call again with the same arguments to resume";
+            out["frames"] = frame_list;
+            return out.dump();
+        }
+    }
+
+    out["frames"] = std::move(frame_list);
+    GetResumableOperations().Complete(key);
+    return out.dump();
+}
+
+std::string CollectBacktrace(lldb::SBDebugger& debugger, uint32_t thread_id, uint32_t max_frames,
+                             size_t budget)
+{
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    lldb::SBProcess process = target.GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+
+    lldb::SBThread thread = ResolveThread(process, thread_id);
+    if (!thread.IsValid())
+        return "Error: no thread with index " + std::to_string(thread_id);
+    if (max_frames == 0)
+        max_frames = kDefaultUnwindBudget;
+
+    std::string key = StopKey(debugger) + "backtrace|" + std::to_string(thread.GetIndexID()) +
+                      "|" + std::to_string(max_frames);
+    auto state = GetResumableOperations().Acquire<BacktraceState>(key);
+    auto& functions = state->functions;
+
+    auto function_key = [&](lldb::SBFrame frame)
+    {
+        uint64_t pc = frame.GetPC();
+        auto it = state->function_of_pc.find(pc);
+        if (it == state->function_of_pc.end())
+        {
+            uint64_t start = frame.GetSymbol().GetStartAddress().GetLoadAddress(target);
+            it = state->function_of_pc.emplace(pc, start == LLDB_INVALID_ADDRESS ? pc : start)
+                     .first;
+        }
+        return it->second;
+    };
+
+    // Unwind frame by frame (GetNumFrames would force a full unwind), tracking
+    // whether the tail is inside a cycle. Once a cycle has held for
+    // kSkipCycleRepeats repeats the rest of it is not symbolized: probes
+    // kProbeStride frames apart find the bottom within max_frames (LLDB
+    // unwinds up to each probe), the last stride is bisected and only the
+    // outermost kBottomWindow frames are symbolized.
+    OperationProgress progress(debugger, "Unwinding", max_frames);
+    progress.Increment(functions.size());
+    bool cancelled = false;
+    bool past_budget = false; // The cycle goes on beyond max_frames
+    while (!state->bottom && functions.size() < max_frames)
+    {
+        uint32_t i = static_cast<uint32_t>(functions.size());
+        if (i % kProgressStride == 0 && i > 0 && !progress.Increment(kProgressStride))
+        {
+            cancelled = true;
+            break;
+        }
+
+        lldb::SBFrame frame = thread.GetFrameAtIndex(i);
+        if (!frame.IsValid())
+        {
+            state->bottom = true;
+            break;
+        }
+        functions.push_back(function_key(frame));
+
+        uint32_t p = state->cycle_period;
+        if (p && functions[i] != functions[i - p])
+            state->cycle_period = 0;
+        if (!state->cycle_period && i + 1 >= kMaxCyclePeriod * kMinCycleRepeats)
+        {
+            state->cycle_since = i + 1 - kMaxCyclePeriod * kMinCycleRepeats;
+            state->cycle_period = CyclePeriodAt(functions, state->cycle_since);
+        }
+
+        p = state->cycle_period;
+        if (p && i + 1 - state->cycle_since >= p * kSkipCycleRepeats)
+        {
+            uint32_t valid = i;        // Last frame known to exist
+            uint32_t end = max_frames; // First frame known to be missing, or the budget
+            bool missing = false;
+            while (valid + 1 < end)
+            {
+                uint32_t probe = missing ? valid + (end - valid) / 2
+                                         : std::min(valid + kProbeStride, end - 1);
+                if (!missing && !progress.Increment(probe - valid))
+                {
+                    cancelled = true;
+                    break;
+                }
+                if (thread.GetFrameAtIndex(probe).IsValid())
+                {
+                    valid = probe;
+                }
+                else
+                {
+                    end = probe;
+                    missing = true;
+                }
+            }
+            if (cancelled)
+                break;
+            if (!missing)
+            {
+                past_budget = true;
+                break;
+            }
+
+            uint32_t total = end;
+            uint32_t from = std::max(i + 1, total > kBottomWindow ? total - kBottomWindow : 0);
+            if (from > i + 1)
+            {
+                state->skipped_from = i + 1;
+                state->skipped_to = from;
+            }
+            for (uint32_t k = from; k < total; k++)
+                functions.push_back(function_key(thread.GetFrameAtIndex(k)));
+            state->bottom = true;
+        }
+    }
+
+    // Frame numbers of functions[i] and of the end of a range ending before it
+    size_t skipped = state->skipped_to - state->skipped_from;
+    auto frame_at = [&](size_t i) { return i < state->skipped_from ? i : i + skipped; };
+    auto frame_end = [&](size_t end) { return end <= state->skipped_from ? end : end + skipped; };
+
+    std::string out = "thread #" + std::to_string(thread.GetIndexID()) + ": " +
+                      std::to_string(functions.size() + skipped) + " frames";
+    if (skipped)
+        out += " (complete; frames " + std::to_string(state->skipped_from) + ".." +
+               std::to_string(state->skipped_to - 1) +
+               " inside the recursion were counted but not symbolized)\n";
+    else if (state->bottom)
+        out += " unwound (complete)\n";
+    else if (cancelled)
+        out += " unwound (interrupted; call again with the same arguments to resume)\n";
+    else if (past_budget)
+        out += " unwound (a repeating cycle continues past max_frames=" +
+               std::to_string(max_frames) +
+               "; bottom frames not shown, raise max_frames to find them)\n";
+    else
+        out += state->cycle_period
+                   ? " unwound (budget reached inside a repeating cycle; bottom frames not "
+                     "shown, raise max_frames to unwind further)\n"
+                   : " unwound (budget reached; raise max_frames to unwind further)\n";
+
+    // Collapse runs of a repeating function cycle into a single line. A run
+    // that reaches the skipped frames continues below them if the outermost
+    // frames pick the cycle up in phase.
+    size_t i = 0;
+    bool gap_listed = false;
+    while (i < functions.size())
+    {
+        size_t first = frame_at(i);
+        std::string line;
+        size_t limit = i < state->skipped_from ? state->skipped_from : functions.size();
+        bool at_gap = skipped && i == state->skipped_from && !gap_listed;
+        uint32_t p = at_gap ? 0 : CyclePeriodAt(functions, i, limit);
+        if (at_gap)
+        {
+            first = state->skipped_from;
+            line = "[frames " + std::to_string(state->skipped_from) + ".." +
+                   std::to_string(state->skipped_to - 1) + ": not symbolized]";
+            gap_listed = true;
+        }
+        else if (p)
+        {
+            size_t end = i + p;
+            while (end < limit && functions[end] == functions[end - p])
+                end++;
+            if (skipped && end == state->skipped_from)
+            {
+                size_t j = end;
+                while (j < functions.size() &&
+                       functions[j] == functions[i + (j + skipped - i) % p])
+                    j++;
+                // Too short a match below the gap is not trusted as the same run
+                if (j - end >= p)
+                {
+                    end = j;
+                    gap_listed = true;
+                }
+            }
+            size_t repeats = (frame_end(end) - first) / p;
+            size_t last = first + repeats * p; // One past the run's last frame
+            end = last <= state->skipped_from ? last : last - skipped;
+
+            std::string cycle;
+            for (uint32_t k = 0; k < p; k++)
+            {
+                const char* fn = thread.GetFrameAtIndex(static_cast<uint32_t>(first + k))
+                                     .GetDisplayFunctionName();
+                cycle += (k ? " -> " : "") + std::string(fn ? fn : "??");
+            }
+            line = "[frames " + std::to_string(first) + ".." + std::to_string(last - 1) + ": " +
+                   cycle + " repeated " + std::to_string(repeats) + "x" +
+                   (end == functions.size() && !state->bottom ? "+" : "") + "]";
+            i = end;
+        }
+        else
+        {
+            line = FormatFrame(thread.GetFrameAtIndex(static_cast<uint32_t>(first)));
+            i++;
+        }
+
+        if (out.size() + line.size() + 1 > budget)
+        {
+            out += "(truncated: output budget reached at frame " + std::to_string(first) +
+                   ")\n";
+            break;
+        }
+        out += line + "\n";
+    }
+
+    if (!cancelled)
+        GetResumableOperations().Complete(key);
+    return out;
+}
+
+std::string CollectRegisters(lldb::SBDebugger& debugger, const std::string& set,
+                             const std::string& threads, size_t budget)
+{
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    lldb::SBProcess process = target.GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+
+    // Empty or "all" = no filter
+    std::set<uint32_t> wanted_threads;
+    if (!threads.empty() && threads != "all")
+        for (uint32_t id : ParseRanges(threads, kMaxThreadIndex))
+            wanted_threads.insert(id);
+    std::set<std::string> wanted_regs;
+    bool by_name = !set.empty() && set != "gpr" && set != "vector" && set != "fp" && set != "all";
+    if (by_name)
+    {
+        std::stringstream ss(set);
+        std::string name;
+        while (std::getline(ss, name, ','))
+            if (!name.empty())
+                wanted_regs.insert(name);
+    }
+
+    std::string key = StopKey(debugger) + "registers_all|" + set + "|" + threads;
+    auto state = GetResumableOperations().Acquire<RegistersState>(key);
+    auto& row_order = state->row_order;
+    auto& rows = state->rows;
+    auto& scalars = state->scalars;
+    auto& thread_ids = state->thread_ids;
+
+    uint32_t num_threads = process.GetNumThreads();
+    OperationProgress progress(debugger, "Reading registers", num_threads);
+    progress.Increment(state->next);
+    bool cancelled = false;
+    for (uint32_t t = state->next; t < num_threads; state->next = ++t)
+    {
+        if (!progress.Increment())
+        {
+            cancelled = true;
+            break;
+        }
+
+        lldb::SBThread thread = process.GetThreadAtIndex(t);
+        uint32_t id = thread.GetIndexID();
+        if (!wanted_threads.empty() && !wanted_threads.count(id))
+            continue;
+        thread_ids.push_back(id);
+
+        lldb::SBValueList sets = thread.GetFrameAtIndex(0).GetRegisters();
+        for (uint32_t s = 0; s < sets.GetSize(); s++)
+        {
+            lldb::SBValue reg_set = sets.GetValueAtIndex(s);
+            const char* set_name = reg_set.GetName();
+            if (!RegisterSetSelected(set, set_name ? set_name : "", s))
+                continue;
+
+            uint32_t n = reg_set.GetNumChildren();
+            for (uint32_t r = 0; r < n; r++)
+            {
+                lldb::SBValue reg = reg_set.GetChildAtIndex(r);
+                const char* reg_name = reg.GetName();
+                if (!reg_name || (by_name && !wanted_regs.count(reg_name)))
+                    continue;
+
+                uint64_t scalar = 0;
+                std::string hex = RegisterHex(reg, &scalar);
+                auto& row = rows[reg_name];
+                if (row.empty())
+                    row_order.push_back(reg_name);
+                row[hex].push_back(id);
+                if (scalar)
+                    scalars.emplace(hex, scalar);
+            }
+        }
+    }
+
+    if (thread_ids.empty())
+        return "Error: no matching threads";
+
+    AddressAnnotator annotator(target, process);
+    std::set<std::string> annotated;
+    std::string out = "threads " + FormatRanges(thread_ids) +
+                      " (index IDs); @all = same in every thread\n";
+    if (cancelled)
+        out += "(interrupted after " + std::to_string(state->next) + " of " +
+               std::to_string(num_threads) +
+               " threads; call again with the same arguments to resume)\n";
+
+    for (size_t i = 0; i < row_order.size(); i++)
+    {
+        const std::string& name = row_order[i];
+        auto& groups = rows[name];
+
+        // Most common value first
+        std::vector<std::pair<std::string, std::vector<uint32_t>>> sorted(groups.begin(),
+                                                                          groups.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b)
+                         { return a.second.size() > b.second.size(); });
+
+        std::string line = name;
+        line.resize(std::max<size_t>(line.size() + 1, 7), ' ');
+        for (size_t g = 0; g < sorted.size(); g++)
+        {
+            const auto& [hex, ids] = sorted[g];
+            if (g > 0)
+                line += " | ";
+            line += hex;
+            auto scalar = scalars.find(hex);
+            if (scalar != scalars.end() && annotated.insert(hex).second)
+            {
+                std::string note = annotator.Annotate(scalar->second);
+                if (!note.empty())
+                    line += " " + note;
+            }
+            line += ids.size() == thread_ids.size() ? " @all" : " @" + FormatRanges(ids);
+        }
+
+        if (out.size() + line.size() + 1 > budget)
+        {
+            out += "(truncated: " + std::to_string(row_order.size() - i) +
+                   " more registers; request fewer registers or threads)\n";
+            break;
+        }
+        out += line + "\n";
+    }
+
+    if (!cancelled)
+        GetResumableOperations().Complete(key);
+    return out;
+}
+
+std::string CollectMemoryMap(lldb::SBDebugger& debugger, const std::string& filter,
+                             size_t budget)
+{
+    constexpr size_t kTopCount = 8;
+
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+
+    RegionIndex index;
+    if (!index.Load(process) || index.regions().empty())
+        return "Error: memory regions unavailable";
+
+    struct Totals
+    {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+    std::map<std::string, Totals> kinds;
+    std::map<std::string, uint64_t> modules;
+    uint64_t mapped = 0;
+    for (const auto& region : index.regions())
+    {
+        uint64_t size = region.end - region.start;
+        const std::string& name = index.Name(region);
+        mapped += size;
+        Totals& kind = kinds[RegionKind(name, region)];
+        kind.count++;
+        kind.bytes += size;
+        if (!name.empty() && name[0] == '/')
+            modules[name] += size;
+    }
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "pid %" PRIu64 ": %zu regions, %s mapped (%s, %.1f ms)\n",
+                  process.GetProcessID(), index.regions().size(), FormatBytes(mapped).c_str(),
+                  index.from_procfs() ? "/proc maps" : "SB API", index.load_ms());
+    std::string out = line;
+
+    uint64_t pid = index.from_procfs() ? LocalProcfsPid(process) : 0;
+    MemoryRollup rollup;
+    if (pid && ReadMemoryRollup(pid, rollup))
+        out += "rss " + FormatBytes(rollup.rss) + ", pss " + FormatBytes(rollup.pss) + ", anon " +
+               FormatBytes(rollup.anonymous) + ", private dirty " +
+               FormatBytes(rollup.private_dirty) + ", swap " + FormatBytes(rollup.swap) + "\n";
+    std::vector<uint64_t> tids;
+    if (pid && ListTasks(pid, tids))
+        out += "threads: " + std::to_string(tids.size()) + "\n";
+    else
+        out += "threads: " + std::to_string(process.GetNumThreads()) + "\n";
+
+    out += "by kind:\n";
+    for (const auto& [kind, totals] : kinds)
+    {
+        std::snprintf(line, sizeof(line), "  %-18s %7" PRIu64 " regions %10s\n", kind.c_str(),
+                      totals.count, FormatBytes(totals.bytes).c_str());
+        out += line;
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> by_size;
+    for (const auto& [name, bytes] : modules)
+        by_size.emplace_back(bytes, name);
+    std::sort(by_size.rbegin(), by_size.rend());
+    out += "largest files:\n";
+    for (size_t i = 0; i < by_size.size() && i < kTopCount; i++)
+        out += "  " + FormatBytes(by_size[i].first) + " " + by_size[i].second + "\n";
+
+    std::vector<const RegionIndex::Region*> regions;
+    for (const auto& region : index.regions())
+        if (filter.empty() || index.Name(region).find(filter) != std::string::npos)
+            regions.push_back(&region);
+    if (filter.empty())
+    {
+        size_t top = std::min(regions.size(), kTopCount);
+        std::partial_sort(regions.begin(), regions.begin() + static_cast<long>(top), regions.end(),
+                          [](const auto* a, const auto* b)
+                          { return a->end - a->start > b->end - b->start; });
+        regions.resize(top);
+        out += "largest regions:\n";
+    }
+    else
+    {
+        out += std::to_string(regions.size()) + " regions matching '" + filter + "':\n";
+    }
+
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        std::string entry = "  " + FormatRegion(index, *regions[i]) + "\n";
+        if (out.size() + entry.size() > budget)
+        {
+            out += "(truncated: " + std::to_string(regions.size() - i) + " more regions)\n";
+            break;
+        }
+        out += entry;
+    }
+    return out;
+}
+
+} // namespace lldb_copilot
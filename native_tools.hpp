@@ -0,0 +1,50 @@
+#pragma once
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Native tools collect debugger state directly through the SB API and return
+// compact JSON, replacing sequences of dbg_exec round-trips. None of them
+// change the user-visible thread or frame selection.
+
+// Default byte budget for a single native tool result
+constexpr size_t kToolResultBudget = 32 * 1024;
+
+// Arguments and locals for a range of frames of one thread.
+// thread: thread index ID as shown by "thread list" (0 = selected thread)
+// frames: "0-7", "3", "0,2,5" or "all" (empty = "0-7")
+// depth:  levels of aggregate children to expand (0 = top-level values only)
+std::string CollectStackLocals(lldb::SBDebugger& debugger, uint32_t thread, const std::string& frames,
+                               int depth, size_t budget = kToolResultBudget);
+
+// Backtrace of one thread with repeating function cycles (recursion)
+// collapsed into one line each, e.g.
+// "[frames 12..98761: A -> B repeated 49375x]". Unwinding stops after
+// max_frames frames (0 = default budget); only the unique frames above,
+// between and below cycles are listed. A cycle that keeps repeating is not
+// symbolized to its end: the bottom is found by probing ahead within
+// max_frames, the outermost frames are listed and the frames in between are
+// reported as part of the run. If the cycle goes on past max_frames the
+// bottom frames are not shown.
+std::string CollectBacktrace(lldb::SBDebugger& debugger, uint32_t thread, uint32_t max_frames,
+                             size_t budget = kToolResultBudget);
+
+// Registers of many threads in one pass, as a table with one row per register
+// and identical values grouped across threads. Pointer-like values are
+// annotated once with their symbol or memory region.
+// set:     "gpr" (default), "vector", "all", or register names ("rip,rsp,rax")
+// threads: "all" (default) or index IDs ("1,4-6")
+std::string CollectRegisters(lldb::SBDebugger& debugger, const std::string& set,
+                             const std::string& threads, size_t budget = kToolResultBudget);
+
+// Address space summary: regions and sizes by kind, largest files and
+// regions, memory totals and thread count. Local Linux processes are read
+// from /proc (maps, smaps_rollup, task/); others through the SB API.
+// filter: name substring to list every matching region instead of the largest
+std::string CollectMemoryMap(lldb::SBDebugger& debugger, const std::string& filter,
+                             size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
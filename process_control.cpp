@@ -0,0 +1,297 @@
+#include "process_control.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr std::chrono::milliseconds kPollInterval{1};
+
+bool IsStopped(lldb::StateType state)
+{
+    return state == lldb::eStateStopped || state == lldb::eStateCrashed ||
+           state == lldb::eStateSuspended;
+}
+
+bool IsGone(lldb::StateType state)
+{
+    return state == lldb::eStateExited || state == lldb::eStateDetached ||
+           state == lldb::eStateInvalid;
+}
+
+// Wait until process reaches a stopped or final state
+lldb::StateType WaitForStop(lldb::SBProcess process, std::chrono::milliseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    lldb::StateType state = process.GetState();
+    while (!IsStopped(state) && !IsGone(state) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(kPollInterval);
+        state = process.GetState();
+    }
+    return state;
+}
+
+// Stop reason of a thread that the interrupt does not explain ("" if none)
+std::string OwnStopReason(lldb::SBProcess process, lldb::SBThread thread)
+{
+    switch (thread.GetStopReason())
+    {
+    case lldb::eStopReasonInvalid:
+    case lldb::eStopReasonNone:
+    case lldb::eStopReasonTrace:
+        return "";
+    case lldb::eStopReasonSignal:
+    {
+        // The interrupt itself arrives as SIGSTOP
+        const char* name = process.GetUnixSignals().GetSignalAsCString(
+            static_cast<int32_t>(thread.GetStopReasonDataAtIndex(0)));
+        if (name && std::strcmp(name, "SIGSTOP") == 0)
+            return "";
+        break;
+    }
+    default:
+        break;
+    }
+    char desc[128] = {};
+    thread.GetStopDescription(desc, sizeof(desc));
+    return "thread #" + std::to_string(thread.GetIndexID()) + ": " +
+           (desc[0] ? desc : "stopped");
+}
+
+std::atomic<bool> g_resume_allowed{false};
+} // namespace
+
+void SetResumeAllowed(bool allowed)
+{
+    g_resume_allowed = allowed;
+}
+
+bool ResumeAllowed()
+{
+    return g_resume_allowed;
+}
+
+double MsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+bool InterruptAndWait(lldb::SBProcess process, std::chrono::milliseconds timeout)
+{
+    lldb::StateType state = process.GetState();
+    if (IsStopped(state))
+        return true;
+    if (IsGone(state))
+        return false;
+    process.Stop();
+    return IsStopped(WaitForStop(process, timeout));
+}
+
+bool IsRunning(lldb::SBProcess process)
+{
+    lldb::StateType state = process.GetState();
+    return state == lldb::eStateRunning || state == lldb::eStateStepping;
+}
+
+void StopBudget::Begin(int cap_ms)
+{
+    *this = StopBudget();
+    cap_ms_ = cap_ms > 0 ? cap_ms : 0;
+}
+
+void StopBudget::Charge(double ms)
+{
+    used_ms_ += ms;
+    longest_ms_ = std::max(longest_ms_, ms);
+    bursts_++;
+}
+
+std::string StopBudget::Summary() const
+{
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+                  "stopped %u time%s for %.1f ms (longest %.1f ms) of a %.0f ms budget", bursts_,
+                  bursts_ == 1 ? "" : "s", used_ms_, longest_ms_, cap_ms_);
+    std::string out = buf;
+    if (refused_)
+        out += "; " + std::to_string(refused_) + " refused";
+    return out;
+}
+
+StopBudget& GetStopBudget()
+{
+    static StopBudget budget;
+    return budget;
+}
+
+StopBurst::StopBurst(lldb::SBDebugger debugger, lldb::SBProcess process, StopBudget& budget)
+    : debugger_(debugger), process_(process), budget_(budget)
+{
+    if (!budget_.active() || !process_.IsValid() || !IsRunning(process_))
+        return;
+    if (budget_.remaining_ms() <= 0)
+    {
+        budget_.Refuse();
+        error_ = "stop budget for this question used up (" + budget_.Summary() + ")";
+        return;
+    }
+
+    was_async_ = debugger_.GetAsync();
+    debugger_.SetAsync(true);
+    start_ = std::chrono::steady_clock::now();
+    auto remaining = std::chrono::milliseconds(static_cast<int64_t>(budget_.remaining_ms()));
+    deadline_ = start_ + remaining;
+    interrupted_ = true;
+    process_.Stop();
+    lldb::StateType state =
+        WaitForStop(process_, std::min<std::chrono::milliseconds>(remaining,
+                                                                  ResumeScope::kStopTimeout));
+    if (IsGone(state))
+    {
+        error_ = "process exited";
+    }
+    else if (!IsStopped(state))
+    {
+        error_ = "process did not stop within the remaining stop budget (" +
+                 std::to_string(remaining.count()) + " ms)";
+    }
+    else
+    {
+        stopped_ = true;
+        for (uint32_t i = 0; i < process_.GetNumThreads() && own_stop_.empty(); i++)
+            own_stop_ = OwnStopReason(process_, process_.GetThreadAtIndex(i));
+    }
+}
+
+StopBurst::~StopBurst()
+{
+    Resume();
+}
+
+double StopBurst::Resume()
+{
+    if (!interrupted_ || resumed_)
+        return stopped_ms_;
+    resumed_ = true;
+
+    // A stop requested too late still arrives: wait for it rather than leave
+    // the process stopped behind the tool's back. Running after the stop
+    // took effect means a command resumed it; there is nothing to wait for.
+    lldb::StateType state = process_.GetState();
+    if (!stopped_ && !IsStopped(state) && !IsGone(state))
+    {
+        state = WaitForStop(process_, ResumeScope::kStopTimeout);
+        for (uint32_t i = 0; IsStopped(state) && i < process_.GetNumThreads() && own_stop_.empty();
+             i++)
+            own_stop_ = OwnStopReason(process_, process_.GetThreadAtIndex(i));
+    }
+
+    // A stop of its own is left for the user to see
+    if (own_stop_.empty() && IsStopped(state))
+        process_.Continue();
+    stopped_ms_ = MsSince(start_);
+    budget_.Charge(stopped_ms_);
+    debugger_.SetAsync(was_async_);
+    return stopped_ms_;
+}
+
+ResumeScope::ResumeScope(lldb::SBDebugger debugger, lldb::SBProcess process)
+    : debugger_(debugger), process_(process), start_(std::chrono::steady_clock::now()),
+      end_(start_)
+{
+    if (!process_.IsValid() || !IsStopped(process_.GetState()))
+        return;
+
+    if (!ResumeAllowed())
+    {
+        error_ = "tools may not resume a stopped process (enable with 'agent resume on')";
+        return;
+    }
+    if (process_.GetState() == lldb::eStateCrashed)
+    {
+        error_ = "the process crashed; resuming would deliver the signal and kill it";
+        return;
+    }
+    for (uint32_t i = 0; i < process_.GetNumThreads(); i++)
+    {
+        lldb::SBThread thread = process_.GetThreadAtIndex(i);
+        if (thread.GetStopReason() == lldb::eStopReasonPlanComplete)
+            continue;
+        std::string reason = OwnStopReason(process_, thread);
+        if (!reason.empty())
+        {
+            error_ = "the process is stopped at " + reason +
+                     "; resuming would deliver a crash signal or run past this stop";
+            return;
+        }
+    }
+
+    was_async_ = debugger_.GetAsync();
+    debugger_.SetAsync(true);
+    lldb::SBError error = process_.Continue();
+    if (error.Fail())
+    {
+        error_ = error.GetCString() ? error.GetCString() : "continue failed";
+        debugger_.SetAsync(was_async_);
+        return;
+    }
+    resumed_ = true;
+    start_ = std::chrono::steady_clock::now();
+}
+
+ResumeScope::~ResumeScope()
+{
+    Stop();
+}
+
+bool ResumeScope::Stop(std::chrono::milliseconds timeout)
+{
+    if (!resumed_ || stopped_)
+        return stop_ok_;
+    stopped_ = true;
+    end_ = std::chrono::steady_clock::now();
+
+    bool ok = true;
+    lldb::StateType state = process_.GetState();
+    if (IsGone(state))
+    {
+        own_stop_ = "exited with status " + std::to_string(process_.GetExitStatus());
+        ok = false;
+    }
+    else if (IsStopped(state))
+    {
+        // Hit a breakpoint, signal or other stop of its own while running
+        char desc[128] = {};
+        process_.GetSelectedThread().GetStopDescription(desc, sizeof(desc));
+        own_stop_ = std::string("stopped by itself: ") + (desc[0] ? desc : "unknown reason");
+    }
+    else
+    {
+        process_.Stop();
+        state = WaitForStop(process_, timeout);
+        if (!IsStopped(state))
+        {
+            error_ = IsGone(state) ? "process exited" : "process did not stop in time";
+            ok = false;
+        }
+    }
+    debugger_.SetAsync(was_async_);
+    stop_ok_ = ok;
+    return ok;
+}
+
+double ResumeScope::ran_ms() const
+{
+    auto end = resumed_ && !stopped_ ? std::chrono::steady_clock::now() : end_;
+    return std::chrono::duration<double, std::milli>(end - start_).count();
+}
+
+} // namespace lldb_copilot
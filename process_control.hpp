@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Whether tools may resume a stopped process. Off unless the user opted in
+// ("agent resume on"); set from the settings at the start of each question.
+void SetResumeAllowed(bool allowed);
+bool ResumeAllowed();
+
+// Lets a stopped process run for a while (to sample it from /proc while it
+// makes progress) and stops it again. The debugger is switched to
+// asynchronous mode while the process runs and restored afterwards.
+class ResumeScope
+{
+  public:
+    static constexpr std::chrono::milliseconds kStopTimeout{2000};
+
+    // Resumes process if it is stopped; a running process is left alone.
+    // Refuses (error() set, nothing resumed) unless ResumeAllowed(), and
+    // whenever a thread stopped for a reason of its own: continuing would
+    // deliver a crash signal and kill the process, or run past a breakpoint.
+    // Only stops explained by an interrupt (SIGSTOP) or a finished step are
+    // resumed.
+    ResumeScope(lldb::SBDebugger debugger, lldb::SBProcess process);
+    ~ResumeScope();
+
+    ResumeScope(const ResumeScope&) = delete;
+    ResumeScope& operator=(const ResumeScope&) = delete;
+
+    // Interrupt the process and wait for it to stop. False if it exited or
+    // did not stop within timeout. No-op unless this scope resumed it.
+    bool Stop(std::chrono::milliseconds timeout = kStopTimeout);
+
+    bool resumed() const { return resumed_; }
+    const std::string& error() const { return error_; }
+
+    // Why the process stopped or exited by itself while resumed ("" if it
+    // ran until Stop())
+    const std::string& own_stop() const { return own_stop_; }
+
+    // Time the process ran under this scope
+    double ran_ms() const;
+
+  private:
+    lldb::SBDebugger debugger_;
+    lldb::SBProcess process_;
+    bool was_async_ = false;
+    bool resumed_ = false;
+    bool stopped_ = false;
+    bool stop_ok_ = true;
+    std::string error_;
+    std::string own_stop_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point end_;
+};
+
+// Milliseconds elapsed since start
+double MsSince(std::chrono::steady_clock::time_point start);
+
+// Stop a running process and wait for the stop; false on timeout or exit
+bool InterruptAndWait(lldb::SBProcess process,
+                      std::chrono::milliseconds timeout = ResumeScope::kStopTimeout);
+
+// Low-intrusion mode: tools leave a running process running and stop it only
+// in short, measured bursts. Each question gets a cap on the total stopped
+// time; bursts are refused once it is used up.
+class StopBudget
+{
+  public:
+    // Start accounting for a question; cap_ms <= 0 turns the mode off
+    void Begin(int cap_ms);
+
+    bool active() const { return cap_ms_ > 0; }
+    double cap_ms() const { return cap_ms_; }
+    double used_ms() const { return used_ms_; }
+    double remaining_ms() const { return used_ms_ < cap_ms_ ? cap_ms_ - used_ms_ : 0; }
+    unsigned bursts() const { return bursts_; }
+    unsigned refused() const { return refused_; }
+
+    void Charge(double ms);
+    void Refuse() { refused_++; }
+
+    // "stopped 3 times for 21.4 ms (longest 12.0 ms) of a 200 ms budget"
+    std::string Summary() const;
+
+  private:
+    double cap_ms_ = 0;
+    double used_ms_ = 0;
+    double longest_ms_ = 0;
+    unsigned bursts_ = 0;
+    unsigned refused_ = 0;
+};
+
+StopBudget& GetStopBudget();
+
+// Stops a running process for the lifetime of the scope (to unwind, read
+// variables, ...) and resumes it afterwards, charging the stopped time to
+// budget. Does nothing unless the budget is active; a process that is
+// already stopped is left alone and costs nothing.
+// The wait for the stop is bounded by the remaining budget; a stop that
+// arrives after that is still waited for and resumed. If the process stopped
+// for a reason of its own (breakpoint, signal) during the burst, it is left
+// stopped; if something resumed it meanwhile, it is left running.
+class StopBurst
+{
+  public:
+    StopBurst(lldb::SBDebugger debugger, lldb::SBProcess process, StopBudget& budget);
+    ~StopBurst();
+
+    StopBurst(const StopBurst&) = delete;
+    StopBurst& operator=(const StopBurst&) = delete;
+
+    // False if the budget is used up or the process did not stop
+    bool ok() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    // Whether this scope interrupted the process
+    bool interrupted() const { return interrupted_; }
+
+    // When the budget runs out; work done while stopped should end by then
+    std::chrono::steady_clock::time_point deadline() const { return deadline_; }
+    const std::string& own_stop() const { return own_stop_; }
+
+    // End the burst early; returns the time the process was stopped
+    double Resume();
+
+  private:
+    lldb::SBDebugger debugger_;
+    lldb::SBProcess process_;
+    StopBudget& budget_;
+    bool was_async_ = false;
+    bool interrupted_ = false;
+    bool stopped_ = false; // The interrupt took effect
+    bool resumed_ = false;
+    double stopped_ms_ = 0;
+    std::string error_;
+    std::string own_stop_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+// Whether a process is running (or stepping) rather than stopped or gone
+bool IsRunning(lldb::SBProcess process);
+
+} // namespace lldb_copilot
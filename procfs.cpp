@@ -0,0 +1,747 @@
+#include "procfs.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lldb_copilot
+{
+
+namespace
+{
+// Hex or decimal number at the front of s; advances s past it
+uint64_t TakeNumber(std::string_view& s, int base)
+{
+    uint64_t value = 0;
+    size_t i = 0;
+    for (; i < s.size(); i++)
+    {
+        char c = s[i];
+        int digit = c >= '0' && c <= '9'                 ? c - '0'
+                    : base == 16 && c >= 'a' && c <= 'f' ? c - 'a' + 10
+                    : base == 16 && c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                                         : -1;
+        if (digit < 0)
+            break;
+        value = value * base + static_cast<uint64_t>(digit);
+    }
+    s.remove_prefix(i);
+    return value;
+}
+
+void SkipSpaces(std::string_view& s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+}
+
+// Skip one whitespace-delimited field
+void SkipField(std::string_view& s)
+{
+    SkipSpaces(s);
+    while (!s.empty() && s.front() != ' ' && s.front() != '\t')
+        s.remove_prefix(1);
+}
+
+bool ProcfsDisabled()
+{
+    const char* value = std::getenv("LLDB_COPILOT_NO_PROCFS");
+    return value && *value && std::strcmp(value, "0") != 0;
+}
+} // namespace
+
+#ifdef __linux__
+
+ProcLineReader::ProcLineReader(const char* path) : fd_(open(path, O_RDONLY | O_CLOEXEC)) {}
+
+ProcLineReader::~ProcLineReader()
+{
+    if (fd_ >= 0)
+        close(fd_);
+}
+
+bool ProcLineReader::Next(std::string_view& line)
+{
+    if (fd_ < 0)
+        return false;
+    while (true)
+    {
+        const char* start = buffer_ + begin_;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', end_ - begin_));
+        if (newline)
+        {
+            line = std::string_view(start, static_cast<size_t>(newline - start));
+            begin_ += line.size() + 1;
+            return true;
+        }
+        if (eof_)
+        {
+            if (begin_ == end_)
+                return false;
+            line = std::string_view(start, end_ - begin_);
+            begin_ = end_;
+            return true;
+        }
+
+        // Keep the partial line and refill behind it
+        if (begin_ > 0)
+        {
+            std::memmove(buffer_, start, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (end_ == sizeof(buffer_))
+        {
+            // Longer than the buffer: return it truncated
+            line = std::string_view(buffer_, end_);
+            begin_ = end_;
+            return true;
+        }
+        ssize_t n = read(fd_, buffer_ + end_, sizeof(buffer_) - end_);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            eof_ = true;
+        else
+            end_ += static_cast<size_t>(n);
+    }
+}
+
+uint64_t LocalProcfsPid(lldb::SBProcess process)
+{
+    if (!process.IsValid() || ProcfsDisabled())
+        return 0;
+    lldb::StateType state = process.GetState();
+    if (state != lldb::eStateStopped && state != lldb::eStateRunning &&
+        state != lldb::eStateStepping && state != lldb::eStateCrashed &&
+        state != lldb::eStateSuspended)
+        return 0;
+
+    // Core files also report a PID; only processes debugged on this host count
+    const char* plugin = process.GetPluginName();
+    if (!plugin || std::strcmp(plugin, "gdb-remote") != 0)
+        return 0;
+    lldb::SBPlatform platform = process.GetTarget().GetPlatform();
+    const char* platform_name = platform.GetName();
+    if (!platform_name || std::strcmp(platform_name, "host") != 0)
+        return 0;
+
+    uint64_t pid = process.GetProcessID();
+    if (pid == 0 || pid == LLDB_INVALID_PROCESS_ID)
+        return 0;
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/maps", static_cast<unsigned long long>(pid));
+    if (access(path, R_OK) != 0)
+        return 0;
+
+    // A gdb-remote connection to host:port on another machine also runs on
+    // the host platform: the PID names a local process only if that process
+    // runs the target's executable
+    char exe[PATH_MAX];
+    if (!process.GetTarget().GetExecutable().GetPath(exe, sizeof(exe)))
+        return 0;
+    std::snprintf(path, sizeof(path), "/proc/%llu/exe", static_cast<unsigned long long>(pid));
+    struct stat running = {};
+    struct stat expected = {};
+    if (stat(path, &running) != 0 || stat(exe, &expected) != 0 ||
+        running.st_dev != expected.st_dev || running.st_ino != expected.st_ino)
+        return 0;
+    return pid;
+}
+
+bool ListTasks(uint64_t pid, std::vector<uint64_t>& tids)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/task", static_cast<unsigned long long>(pid));
+    DIR* dir = opendir(path);
+    if (!dir)
+        return false;
+    tids.clear();
+    while (dirent* entry = readdir(dir))
+    {
+        std::string_view name = entry->d_name;
+        if (name.empty() || name.front() < '0' || name.front() > '9')
+            continue;
+        tids.push_back(TakeNumber(name, 10));
+    }
+    closedir(dir);
+    std::sort(tids.begin(), tids.end());
+    return true;
+}
+
+
+namespace
+{
+// Whole small /proc file into buf (NUL-terminated); returns length or 0
+size_t ReadSmallFile(const char* path, char* buf, size_t size)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+    ssize_t n;
+    do
+        n = read(fd, buf, size - 1);
+    while (n < 0 && errno == EINTR);
+    close(fd);
+    size_t len = n > 0 ? static_cast<size_t>(n) : 0;
+    buf[len] = '\0';
+    return len;
+}
+
+void TaskPath(char* path, size_t size, uint64_t pid, uint64_t tid, const char* file)
+{
+    std::snprintf(path, size, "/proc/%llu/task/%llu/%s", static_cast<unsigned long long>(pid),
+                  static_cast<unsigned long long>(tid), file);
+}
+} // namespace
+
+bool ReadTaskStat(uint64_t pid, uint64_t tid, TaskStat& stat)
+{
+    char path[96];
+    char buf[1024];
+    TaskPath(path, sizeof(path), pid, tid, "stat");
+    size_t len = ReadSmallFile(path, buf, sizeof(buf));
+    if (!len)
+        return false;
+
+    // "tid (comm) state ppid ...": comm may contain spaces and parentheses
+    std::string_view line(buf, len);
+    size_t open_paren = line.find('(');
+    size_t close_paren = line.rfind(')');
+    if (open_paren == std::string_view::npos || close_paren == std::string_view::npos ||
+        close_paren < open_paren)
+        return false;
+    std::string_view comm = line.substr(open_paren + 1, close_paren - open_paren - 1);
+    size_t n = std::min(comm.size(), sizeof(stat.comm) - 1);
+    std::memcpy(stat.comm, comm.data(), n);
+    stat.comm[n] = '\0';
+
+    // Fields after comm, numbered as in proc(5): 3 state, 14 utime, 15 stime,
+    // 39 processor
+    std::string_view rest = line.substr(close_paren + 1);
+    SkipSpaces(rest);
+    stat.state = rest.empty() ? '?' : rest.front();
+    SkipField(rest);
+    for (int field = 4; field <= 39 && !rest.empty(); field++)
+    {
+        SkipSpaces(rest);
+        if (field == 14)
+            stat.utime = TakeNumber(rest, 10);
+        else if (field == 15)
+            stat.stime = TakeNumber(rest, 10);
+        else if (field == 39)
+            stat.processor = static_cast<int>(TakeNumber(rest, 10));
+        else
+            SkipField(rest);
+    }
+    return true;
+}
+
+bool ReadTaskSyscall(uint64_t pid, uint64_t tid, TaskSyscall& call)
+{
+    char path[96];
+    char buf[256];
+    TaskPath(path, sizeof(path), pid, tid, "syscall");
+    call = TaskSyscall();
+    size_t len = ReadSmallFile(path, buf, sizeof(buf));
+    if (!len)
+        return false;
+
+    // "running", "-1 sp pc", or "nr arg0..arg5 sp pc" (hex arguments)
+    std::string_view line(buf, len);
+    if (line.rfind("running", 0) == 0)
+    {
+        call.kind = TaskSyscall::Kind::Running;
+        return true;
+    }
+    bool negative = !line.empty() && line.front() == '-';
+    if (negative)
+        line.remove_prefix(1);
+    call.nr = static_cast<long>(TakeNumber(line, 10)) * (negative ? -1 : 1);
+    call.kind = call.nr < 0 ? TaskSyscall::Kind::NoSyscall : TaskSyscall::Kind::Syscall;
+    auto hex = [&line]()
+    {
+        SkipSpaces(line);
+        if (line.substr(0, 2) == "0x")
+            line.remove_prefix(2);
+        return TakeNumber(line, 16);
+    };
+    if (call.kind == TaskSyscall::Kind::Syscall)
+        for (uint64_t& arg : call.args)
+            arg = hex();
+    call.sp = hex();
+    call.pc = hex();
+    return true;
+}
+
+bool ListFds(uint64_t pid, std::vector<FdEntry>& fds)
+{
+    char path[96];
+    std::snprintf(path, sizeof(path), "/proc/%llu/fd", static_cast<unsigned long long>(pid));
+    DIR* dir = opendir(path);
+    if (!dir)
+        return false;
+    fds.clear();
+    while (dirent* entry = readdir(dir))
+    {
+        std::string_view name = entry->d_name;
+        if (name.empty() || name.front() < '0' || name.front() > '9')
+            continue;
+        FdEntry fd;
+        fd.fd = static_cast<int>(TakeNumber(name, 10));
+
+        char link[96];
+        char target[4096];
+        std::snprintf(link, sizeof(link), "/proc/%llu/fd/%d",
+                      static_cast<unsigned long long>(pid), fd.fd);
+        ssize_t n = readlink(link, target, sizeof(target) - 1);
+        if (n <= 0)
+            continue; // Closed meanwhile
+        fd.target.assign(target, static_cast<size_t>(n));
+
+        char info[512];
+        std::snprintf(link, sizeof(link), "/proc/%llu/fdinfo/%d",
+                      static_cast<unsigned long long>(pid), fd.fd);
+        std::string_view text(info, ReadSmallFile(link, info, sizeof(info)));
+        for (size_t at = 0; at < text.size();)
+        {
+            size_t end = text.find('\n', at);
+            std::string_view line = text.substr(at, end == std::string_view::npos ? end
+                                                                                   : end - at);
+            at = end == std::string_view::npos ? text.size() : end + 1;
+            if (line.rfind("pos:", 0) == 0)
+            {
+                line.remove_prefix(4);
+                SkipSpaces(line);
+                fd.pos = TakeNumber(line, 10);
+            }
+            else if (line.rfind("flags:", 0) == 0)
+            {
+                line.remove_prefix(6);
+                SkipSpaces(line);
+                fd.flags = TakeNumber(line, 8);
+            }
+        }
+        fds.push_back(std::move(fd));
+    }
+    closedir(dir);
+    std::sort(fds.begin(), fds.end(),
+              [](const FdEntry& a, const FdEntry& b) { return a.fd < b.fd; });
+    return true;
+}
+
+uint64_t OpenFileLimit(uint64_t pid)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/limits", static_cast<unsigned long long>(pid));
+    ProcLineReader reader(path);
+    std::string_view line;
+    while (reader.Next(line))
+    {
+        if (line.rfind("Max open files", 0) != 0)
+            continue;
+        line.remove_prefix(14);
+        SkipSpaces(line);
+        return TakeNumber(line, 10); // "unlimited" parses as 0
+    }
+    return 0;
+}
+
+uint64_t ClockTicksPerSecond()
+{
+    static const uint64_t ticks = static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+    return ticks ? ticks : 100;
+}
+
+#else
+
+ProcLineReader::ProcLineReader(const char*) {}
+
+ProcLineReader::~ProcLineReader() = default;
+
+bool ProcLineReader::Next(std::string_view&)
+{
+    return false;
+}
+
+uint64_t LocalProcfsPid(lldb::SBProcess)
+{
+    return 0;
+}
+
+bool ListTasks(uint64_t, std::vector<uint64_t>&)
+{
+    return false;
+}
+
+bool ReadTaskStat(uint64_t, uint64_t, TaskStat&)
+{
+    return false;
+}
+
+bool ReadTaskSyscall(uint64_t, uint64_t, TaskSyscall&)
+{
+    return false;
+}
+
+bool ListFds(uint64_t, std::vector<FdEntry>&)
+{
+    return false;
+}
+
+uint64_t OpenFileLimit(uint64_t)
+{
+    return 0;
+}
+
+uint64_t ClockTicksPerSecond()
+{
+    return 100;
+}
+
+#endif
+
+bool ParseMapsLine(std::string_view line, MapEntry& entry)
+{
+    // start-end perms offset dev inode [path]
+    entry.start = TakeNumber(line, 16);
+    if (line.empty() || line.front() != '-')
+        return false;
+    line.remove_prefix(1);
+    entry.end = TakeNumber(line, 16);
+    SkipSpaces(line);
+    if (line.size() < 4)
+        return false;
+    entry.read = line[0] == 'r';
+    entry.write = line[1] == 'w';
+    entry.exec = line[2] == 'x';
+    entry.shared = line[3] == 's';
+    line.remove_prefix(4);
+    SkipSpaces(line);
+    entry.offset = TakeNumber(line, 16);
+    SkipField(line); // dev
+    SkipSpaces(line);
+    entry.inode = TakeNumber(line, 10);
+    SkipSpaces(line);
+    entry.path = line;
+    return entry.end > entry.start;
+}
+
+const char* SyscallName(long nr)
+{
+    struct Entry
+    {
+        long nr;
+        const char* name;
+    };
+    // Calls threads commonly block or spin in
+#if defined(__x86_64__)
+    static constexpr Entry kNames[] = {
+        {0, "read"}, {1, "write"}, {3, "close"}, {7, "poll"}, {9, "mmap"}, {16, "ioctl"},
+        {17, "pread64"}, {18, "pwrite64"}, {19, "readv"}, {20, "writev"}, {23, "select"},
+        {24, "sched_yield"}, {34, "pause"}, {35, "nanosleep"}, {42, "connect"}, {43, "accept"},
+        {44, "sendto"}, {45, "recvfrom"}, {46, "sendmsg"}, {47, "recvmsg"}, {61, "wait4"},
+        {72, "fcntl"}, {74, "fsync"}, {128, "rt_sigtimedwait"}, {130, "rt_sigsuspend"},
+        {202, "futex"}, {230, "clock_nanosleep"}, {232, "epoll_wait"}, {247, "waitid"},
+        {257, "openat"}, {270, "pselect6"}, {271, "ppoll"}, {281, "epoll_pwait"}, {288, "accept4"},
+        {426, "io_uring_enter"}, {441, "epoll_pwait2"},
+    };
+#elif defined(__aarch64__) || defined(__riscv)
+    static constexpr Entry kNames[] = {
+        {22, "epoll_pwait"}, {25, "fcntl"}, {29, "ioctl"}, {56, "openat"}, {57, "close"},
+        {63, "read"}, {64, "write"}, {65, "readv"}, {66, "writev"}, {67, "pread64"},
+        {68, "pwrite64"}, {72, "pselect6"}, {73, "ppoll"}, {82, "fsync"}, {95, "waitid"},
+        {98, "futex"}, {101, "nanosleep"}, {115, "clock_nanosleep"}, {124, "sched_yield"},
+        {133, "rt_sigsuspend"}, {137, "rt_sigtimedwait"}, {202, "accept"}, {203, "connect"},
+        {206, "sendto"}, {207, "recvfrom"}, {211, "sendmsg"}, {212, "recvmsg"}, {222, "mmap"},
+        {242, "accept4"}, {260, "wait4"}, {426, "io_uring_enter"}, {441, "epoll_pwait2"},
+    };
+#else
+    static constexpr Entry kNames[] = {{-1, nullptr}};
+#endif
+    for (const Entry& entry : kNames)
+        if (entry.nr == nr)
+            return entry.name;
+    return nullptr;
+}
+
+namespace
+{
+const char* TcpState(uint64_t state)
+{
+    static const char* const kStates[] = {
+        "?",         "ESTABLISHED", "SYN_SENT",   "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2",
+        "TIME_WAIT", "CLOSE",       "CLOSE_WAIT", "LAST_ACK", "LISTEN",    "CLOSING",
+    };
+    return state < sizeof(kStates) / sizeof(kStates[0]) ? kStates[state] : "?";
+}
+
+// "0100007F:1F90" (IPv4) or 32 hex digits + port (IPv6), in kernel word order
+std::string FormatInetAddress(std::string_view text)
+{
+    size_t colon = text.find(':');
+    if (colon == std::string_view::npos)
+        return std::string(text);
+    std::string_view hex = text.substr(0, colon);
+    std::string_view port_text = text.substr(colon + 1);
+    uint64_t port = TakeNumber(port_text, 16);
+
+    // Each 32-bit word is printed in host order; bytes go out in memory order
+    unsigned char bytes[16] = {};
+    size_t words = hex.size() / 8;
+    for (size_t w = 0; w < words && w < 4; w++)
+    {
+        std::string_view word_text = hex.substr(w * 8, 8);
+        uint32_t word = static_cast<uint32_t>(TakeNumber(word_text, 16));
+        std::memcpy(bytes + w * 4, &word, 4);
+    }
+
+    static const unsigned char kMappedV4[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    char buf[64];
+    if (words == 1 || (words == 4 && std::memcmp(bytes, kMappedV4, 12) == 0))
+    {
+        const unsigned char* v4 = words == 1 ? bytes : bytes + 12;
+        std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u:%llu", v4[0], v4[1], v4[2], v4[3],
+                      static_cast<unsigned long long>(port));
+        return buf;
+    }
+    // Eight groups, longest run of zero groups written as "::"
+    unsigned groups[8];
+    size_t run_start = 8;
+    size_t run_length = 0;
+    for (size_t g = 0, zeros = 0; g < 8; g++)
+    {
+        groups[g] = (bytes[2 * g] << 8) | bytes[2 * g + 1];
+        zeros = groups[g] ? 0 : zeros + 1;
+        if (zeros > run_length && zeros > 1)
+        {
+            run_length = zeros;
+            run_start = g + 1 - zeros;
+        }
+    }
+    std::string out = "[";
+    for (size_t g = 0; g < 8; g++)
+    {
+        if (g == run_start)
+        {
+            out += "::";
+            g += run_length - 1;
+            continue;
+        }
+        std::snprintf(buf, sizeof(buf), "%x", groups[g]);
+        out += (out.size() > 1 && out.back() != ':' ? ":" : "") + std::string(buf);
+    }
+    return out + "]:" + std::to_string(port);
+}
+
+void ReadInetSockets(uint64_t pid, const char* proto, const std::vector<uint64_t>& wanted,
+                     std::vector<std::pair<uint64_t, SocketInfo>>& sockets)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/net/%s", static_cast<unsigned long long>(pid),
+                  proto);
+    ProcLineReader reader(path);
+    std::string_view line;
+    reader.Next(line); // Header
+    while (reader.Next(line))
+    {
+        // sl local remote st tx:rx tr:when retrnsmt uid timeout inode
+        SkipField(line);
+        SkipSpaces(line);
+        std::string_view local = line.substr(0, line.find(' '));
+        SkipField(line);
+        SkipSpaces(line);
+        std::string_view remote = line.substr(0, line.find(' '));
+        SkipField(line);
+        SkipSpaces(line);
+        uint64_t state = TakeNumber(line, 16);
+        SkipSpaces(line);
+        uint64_t tx = TakeNumber(line, 16);
+        if (!line.empty() && line.front() == ':')
+            line.remove_prefix(1);
+        uint64_t rx = TakeNumber(line, 16);
+        for (int i = 0; i < 4; i++)
+            SkipField(line);
+        SkipSpaces(line);
+        uint64_t inode = TakeNumber(line, 10);
+        if (!std::binary_search(wanted.begin(), wanted.end(), inode))
+            continue;
+
+        SocketInfo info;
+        info.proto = proto;
+        info.local = FormatInetAddress(local);
+        info.remote = FormatInetAddress(remote);
+        bool tcp = proto[0] == 't';
+        info.state = tcp ? TcpState(state) : (state == 1 ? "connected" : "unconnected");
+        info.tx_queue = tx;
+        info.rx_queue = rx;
+        sockets.emplace_back(inode, std::move(info));
+    }
+}
+
+void ReadUnixSockets(uint64_t pid, const std::vector<uint64_t>& wanted,
+                     std::vector<std::pair<uint64_t, SocketInfo>>& sockets)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/net/unix", static_cast<unsigned long long>(pid));
+    ProcLineReader reader(path);
+    std::string_view line;
+    reader.Next(line); // Header
+    while (reader.Next(line))
+    {
+        // Num RefCount Protocol Flags Type St Inode [Path]
+        for (int i = 0; i < 4; i++)
+            SkipField(line);
+        SkipSpaces(line);
+        uint64_t type = TakeNumber(line, 16);
+        SkipSpaces(line);
+        uint64_t state = TakeNumber(line, 16);
+        SkipSpaces(line);
+        uint64_t inode = TakeNumber(line, 10);
+        if (!std::binary_search(wanted.begin(), wanted.end(), inode))
+            continue;
+        SkipSpaces(line);
+
+        SocketInfo info;
+        info.proto = type == 2 ? "unix-dgram" : type == 5 ? "unix-seqpacket" : "unix";
+        info.local = std::string(line.empty() ? "(unnamed)" : line);
+        info.state = state == 3 ? "connected" : state == 1 ? "unconnected" : "connecting";
+        sockets.emplace_back(inode, std::move(info));
+    }
+}
+} // namespace
+
+bool ReadSockets(uint64_t pid, const std::vector<uint64_t>& wanted,
+                 std::vector<std::pair<uint64_t, SocketInfo>>& sockets)
+{
+    sockets.clear();
+    if (wanted.empty())
+        return true;
+    for (const char* proto : {"tcp", "tcp6", "udp", "udp6"})
+        ReadInetSockets(pid, proto, wanted, sockets);
+    ReadUnixSockets(pid, wanted, sockets);
+    std::sort(sockets.begin(), sockets.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    return true;
+}
+
+bool ReadMemoryRollup(uint64_t pid, MemoryRollup& rollup)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/smaps_rollup",
+                  static_cast<unsigned long long>(pid));
+    ProcLineReader reader(path);
+    if (!reader.IsOpen())
+        return false;
+
+    struct Field
+    {
+        std::string_view key;
+        uint64_t MemoryRollup::*value;
+    };
+    static constexpr Field kFields[] = {
+        {"Rss:", &MemoryRollup::rss},
+        {"Pss:", &MemoryRollup::pss},
+        {"Anonymous:", &MemoryRollup::anonymous},
+        {"Private_Dirty:", &MemoryRollup::private_dirty},
+        {"Swap:", &MemoryRollup::swap},
+    };
+
+    rollup = MemoryRollup();
+    bool any = false;
+    std::string_view line;
+    while (reader.Next(line))
+    {
+        for (const Field& field : kFields)
+        {
+            if (line.substr(0, field.key.size()) != field.key)
+                continue;
+            line.remove_prefix(field.key.size());
+            SkipSpaces(line);
+            rollup.*field.value = TakeNumber(line, 10) * 1024; // Reported in kB
+            any = true;
+            break;
+        }
+    }
+    return any;
+}
+
+uint32_t RegionIndex::Intern(std::string_view name)
+{
+    if (name.empty())
+        return 0;
+    // Mappings of one file are adjacent, so comparing with the last name
+    // de-duplicates nearly everything
+    if (names_.back() == name)
+        return static_cast<uint32_t>(names_.size() - 1);
+    names_.emplace_back(name);
+    return static_cast<uint32_t>(names_.size() - 1);
+}
+
+bool RegionIndex::Load(lldb::SBProcess process, bool sb_fallback)
+{
+    auto start = std::chrono::steady_clock::now();
+    regions_.clear();
+    names_.assign(1, "");
+    loaded_ = false;
+    from_procfs_ = false;
+
+    uint64_t pid = LocalProcfsPid(process);
+    if (pid)
+    {
+        from_procfs_ = ForEachMapping(pid,
+                                      [this](const MapEntry& entry)
+                                      {
+                                          regions_.push_back({entry.start, entry.end, entry.read,
+                                                              entry.write, entry.exec,
+                                                              Intern(entry.path)});
+                                          return true;
+                                      });
+        loaded_ = from_procfs_;
+    }
+
+    if (!loaded_ && sb_fallback && process.IsValid())
+    {
+        lldb::SBMemoryRegionInfoList list = process.GetMemoryRegions();
+        regions_.reserve(list.GetSize());
+        for (uint32_t i = 0; i < list.GetSize(); i++)
+        {
+            lldb::SBMemoryRegionInfo region;
+            if (!list.GetMemoryRegionAtIndex(i, region) || !region.IsMapped())
+                continue;
+            const char* name = region.GetName();
+            regions_.push_back({region.GetRegionBase(), region.GetRegionEnd(), region.IsReadable(),
+                                region.IsWritable(), region.IsExecutable(),
+                                Intern(name ? name : "")});
+        }
+        std::sort(regions_.begin(), regions_.end(),
+                  [](const Region& a, const Region& b) { return a.start < b.start; });
+        loaded_ = true;
+    }
+
+    load_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                   .count();
+    return loaded_;
+}
+
+const RegionIndex::Region* RegionIndex::Find(uint64_t address) const
+{
+    auto it = std::upper_bound(regions_.begin(), regions_.end(), address,
+                               [](uint64_t a, const Region& r) { return a < r.start; });
+    if (it == regions_.begin())
+        return nullptr;
+    --it;
+    return address < it->end ? &*it : nullptr;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <lldb/API/LLDB.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Fast paths for local Linux processes: memory maps, memory totals and thread
+// lists are read straight from /proc/<pid> instead of through lldb-server
+// (one packet per region). Every function returns false when /proc cannot be
+// used (remote target, core file, other OS) and callers fall back to the SB
+// API. Setting LLDB_COPILOT_NO_PROCFS=1 forces the fallback, for comparison.
+
+// One line of /proc/<pid>/maps. path points into the reader's buffer and is
+// only valid until the next line is read.
+struct MapEntry
+{
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t offset = 0;
+    uint64_t inode = 0;
+    bool read = false;
+    bool write = false;
+    bool exec = false;
+    bool shared = false;
+    std::string_view path;
+};
+
+// Totals from /proc/<pid>/smaps_rollup, in bytes
+struct MemoryRollup
+{
+    uint64_t rss = 0;
+    uint64_t pss = 0;
+    uint64_t anonymous = 0;
+    uint64_t private_dirty = 0;
+    uint64_t swap = 0;
+};
+
+// Line reader over a /proc file with a fixed buffer; lines are returned as
+// views into the buffer, valid until the next call to Next()
+class ProcLineReader
+{
+  public:
+    explicit ProcLineReader(const char* path);
+    ~ProcLineReader();
+    ProcLineReader(const ProcLineReader&) = delete;
+    ProcLineReader& operator=(const ProcLineReader&) = delete;
+
+    bool IsOpen() const { return fd_ >= 0; }
+    bool Next(std::string_view& line);
+
+  private:
+    int fd_ = -1;
+    bool eof_ = false;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    char buffer_[64 * 1024];
+};
+
+// Parse one maps line; false if malformed
+bool ParseMapsLine(std::string_view line, MapEntry& entry);
+
+// PID of process if it is a live process on this host whose /proc entry is
+// readable and whose /proc/<pid>/exe is the target's executable, else 0
+uint64_t LocalProcfsPid(lldb::SBProcess process);
+
+// Call fn(const MapEntry&) for every mapping, in address order, until it
+// returns false. Returns false if the maps file cannot be read.
+template <typename Fn> bool ForEachMapping(uint64_t pid, Fn&& fn)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/maps", static_cast<unsigned long long>(pid));
+    ProcLineReader reader(path);
+    if (!reader.IsOpen())
+        return false;
+    std::string_view line;
+    MapEntry entry;
+    while (reader.Next(line))
+        if (ParseMapsLine(line, entry) && !fn(static_cast<const MapEntry&>(entry)))
+            break;
+    return true;
+}
+
+// Calls fn(entry, rss_bytes) for each mapping in /proc/<pid>/smaps until fn
+// returns false; false if smaps cannot be read
+template <typename Fn> bool ForEachSmapsRss(uint64_t pid, Fn&& fn)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%llu/smaps", static_cast<unsigned long long>(pid));
+    ProcLineReader reader(path);
+    if (!reader.IsOpen())
+        return false;
+    std::string_view line;
+    MapEntry entry;
+    std::string name; // entry.path must outlive the header line
+    bool have_entry = false;
+    while (reader.Next(line))
+    {
+        if (line.empty())
+            continue;
+        if (line.rfind("Rss:", 0) == 0)
+        {
+            uint64_t kb = 0;
+            for (char c : line.substr(4))
+                if (c >= '0' && c <= '9')
+                    kb = kb * 10 + static_cast<uint64_t>(c - '0');
+                else if (c != ' ')
+                    break;
+            if (have_entry && !fn(static_cast<const MapEntry&>(entry), kb * 1024))
+                break;
+            have_entry = false;
+        }
+        else if ((line[0] >= '0' && line[0] <= '9') || (line[0] >= 'a' && line[0] <= 'f'))
+        {
+            // Mapping header; the other lines are "Key: value"
+            have_entry = ParseMapsLine(line, entry);
+            name.assign(entry.path);
+            entry.path = name;
+        }
+    }
+    return true;
+}
+
+bool ReadMemoryRollup(uint64_t pid, MemoryRollup& rollup);
+
+// Thread IDs from /proc/<pid>/task, sorted
+bool ListTasks(uint64_t pid, std::vector<uint64_t>& tids);
+
+// Scheduler state of one thread from /proc/<pid>/task/<tid>/stat
+struct TaskStat
+{
+    char state = '?'; // R running, S sleeping, D uninterruptible, t traced, ...
+    char comm[16] = {};
+    uint64_t utime = 0; // Clock ticks
+    uint64_t stime = 0;
+    int processor = -1; // CPU it last ran on
+};
+
+// What a thread is doing in the kernel, from /proc/<pid>/task/<tid>/syscall
+struct TaskSyscall
+{
+    enum class Kind
+    {
+        Unknown,   // Not readable
+        Running,   // On a CPU in user space
+        NoSyscall, // Blocked but not in a system call (e.g. page fault, stopped)
+        Syscall,   // Inside system call nr
+    };
+    Kind kind = Kind::Unknown;
+    long nr = -1;
+    uint64_t args[6] = {};
+    uint64_t sp = 0;
+    uint64_t pc = 0;
+};
+
+bool ReadTaskStat(uint64_t pid, uint64_t tid, TaskStat& stat);
+bool ReadTaskSyscall(uint64_t pid, uint64_t tid, TaskSyscall& call);
+
+// One open file descriptor from /proc/<pid>/fd and fdinfo
+struct FdEntry
+{
+    int fd = -1;
+    std::string target; // readlink: "/path", "socket:[inode]", "pipe:[inode]", "anon_inode:[x]"
+    uint64_t flags = 0; // open(2) flags from fdinfo
+    uint64_t pos = 0;
+};
+
+// A socket from /proc/<pid>/net/{tcp,tcp6,udp,udp6,unix}
+struct SocketInfo
+{
+    const char* proto = ""; // "tcp", "tcp6", "udp", "udp6", "unix"
+    std::string local;      // "addr:port", or the unix socket path
+    std::string remote;
+    const char* state = ""; // "ESTABLISHED", "LISTEN", "CLOSE_WAIT", "connected", ...
+    uint64_t tx_queue = 0;
+    uint64_t rx_queue = 0; // Unread bytes (accept backlog for LISTEN)
+};
+
+// Open descriptors, sorted by fd
+bool ListFds(uint64_t pid, std::vector<FdEntry>& fds);
+
+// Sockets visible in pid's network namespace, for the inodes in wanted
+// (sorted); found entries are stored by inode
+bool ReadSockets(uint64_t pid, const std::vector<uint64_t>& wanted,
+                 std::vector<std::pair<uint64_t, SocketInfo>>& sockets);
+
+// Soft RLIMIT_NOFILE of pid (0 if unknown or unlimited)
+uint64_t OpenFileLimit(uint64_t pid);
+
+// Clock ticks per second for TaskStat times
+uint64_t ClockTicksPerSecond();
+
+// Name of a system call number of this host's architecture, or nullptr
+const char* SyscallName(long nr);
+
+// Mapped regions of a process, sorted by address, loaded from /proc when the
+// process is local and from SBProcess::GetMemoryRegions otherwise
+class RegionIndex
+{
+  public:
+    struct Region
+    {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        bool read = false;
+        bool write = false;
+        bool exec = false;
+        uint32_t name = 0; // Index into names (0 = unnamed)
+    };
+
+    // sb_fallback = false loads nothing unless /proc is usable
+    bool Load(lldb::SBProcess process, bool sb_fallback = true);
+
+    const Region* Find(uint64_t address) const;
+    const std::string& Name(const Region& region) const { return names_[region.name]; }
+    const std::vector<Region>& regions() const { return regions_; }
+
+    bool loaded() const { return loaded_; }
+    bool from_procfs() const { return from_procfs_; }
+    double load_ms() const { return load_ms_; }
+
+  private:
+    uint32_t Intern(std::string_view name);
+
+    std::vector<Region> regions_;
+    std::vector<std::string> names_{""};
+    bool loaded_ = false;
+    bool from_procfs_ = false;
+    double load_ms_ = 0;
+};
+
+} // namespace lldb_copilot
@@ -0,0 +1,101 @@
+#include "progress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <lldb/API/SBCommandInterpreter.h>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr auto kPrintInterval = std::chrono::milliseconds(500);
+
+thread_local std::chrono::steady_clock::time_point t_deadline =
+    std::chrono::steady_clock::time_point::max();
+} // namespace
+
+OperationDeadline::OperationDeadline(std::chrono::steady_clock::time_point deadline)
+    : previous_(t_deadline)
+{
+    t_deadline = std::min(t_deadline, deadline);
+}
+
+OperationDeadline::~OperationDeadline()
+{
+    t_deadline = previous_;
+}
+
+bool OperationDeadline::Passed()
+{
+    return std::chrono::steady_clock::now() >= t_deadline;
+}
+
+OperationProgress::OperationProgress(lldb::SBDebugger& debugger, const std::string& title,
+                                     uint64_t total)
+    : debugger_(debugger), title_(title), total_(total),
+      last_print_(std::chrono::steady_clock::now())
+{
+#if LLDB_COPILOT_HAVE_SBPROGRESS
+    progress_ = std::make_unique<lldb::SBProgress>(title_.c_str(), nullptr, total_, debugger_);
+#endif
+}
+
+OperationProgress::~OperationProgress()
+{
+#if LLDB_COPILOT_HAVE_SBPROGRESS
+    progress_->Finalize();
+#else
+    if (printed_)
+    {
+        printf("\r\033[K");
+        fflush(stdout);
+    }
+#endif
+}
+
+bool OperationProgress::Cancelled()
+{
+    if (!cancelled_)
+        cancelled_ =
+            debugger_.GetCommandInterpreter().WasInterrupted() || OperationDeadline::Passed();
+    return cancelled_;
+}
+
+bool OperationProgress::Increment(uint64_t amount, const std::string& detail)
+{
+    completed_ += amount;
+#if LLDB_COPILOT_HAVE_SBPROGRESS
+    progress_->Increment(amount, detail.empty() ? nullptr : detail.c_str());
+#else
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_print_ >= kPrintInterval)
+    {
+        last_print_ = now;
+        printed_ = true;
+        printf("\r\033[K\033[2m%s: %llu/%llu%s%s\033[0m", title_.c_str(),
+               static_cast<unsigned long long>(completed_),
+               static_cast<unsigned long long>(total_), detail.empty() ? "" : " ",
+               detail.c_str());
+        fflush(stdout);
+    }
+#endif
+    return !Cancelled();
+}
+
+ResumableOperations& GetResumableOperations()
+{
+    static ResumableOperations operations;
+    return operations;
+}
+
+std::string StopKey(lldb::SBDebugger& debugger)
+{
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid())
+        return "noprocess|";
+    return std::to_string(process.GetProcessID()) + ":" + std::to_string(process.GetStopID()) +
+           "|";
+}
+
+} // namespace lldb_copilot
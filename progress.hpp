@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <lldb/API/LLDB.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#if LLDB_COPILOT_HAVE_SBPROGRESS
+#include <lldb/API/SBProgress.h>
+#endif
+
+namespace lldb_copilot
+{
+
+// Progress reporting and cooperative cancellation for long-running native
+// operations. Progress goes through SBProgress when the linked LLDB provides
+// it (LLDB 20+), otherwise a throttled status line is printed.
+class OperationProgress
+{
+  public:
+    OperationProgress(lldb::SBDebugger& debugger, const std::string& title, uint64_t total);
+    ~OperationProgress();
+
+    OperationProgress(const OperationProgress&) = delete;
+    OperationProgress& operator=(const OperationProgress&) = delete;
+
+    // Advance by amount units. Returns false once the operation should stop.
+    bool Increment(uint64_t amount = 1, const std::string& detail = "");
+
+    // True if the command interpreter saw an interrupt (Ctrl+C) or the
+    // thread's OperationDeadline passed. An agent abort is not seen here;
+    // callers that run under the agent check it themselves.
+    bool Cancelled();
+
+    uint64_t completed() const { return completed_; }
+
+  private:
+    lldb::SBDebugger debugger_;
+    std::string title_;
+    uint64_t total_ = 0;
+    uint64_t completed_ = 0;
+    bool cancelled_ = false;
+    bool printed_ = false;
+    std::chrono::steady_clock::time_point last_print_;
+#if LLDB_COPILOT_HAVE_SBPROGRESS
+    std::unique_ptr<lldb::SBProgress> progress_;
+#endif
+};
+
+// Deadline for native operations run on this thread while the scope lives
+// (the end of a low-intrusion stop budget): once it passes, OperationProgress
+// reports the operation as cancelled. Scopes nest; the earlier deadline wins.
+class OperationDeadline
+{
+  public:
+    explicit OperationDeadline(std::chrono::steady_clock::time_point deadline);
+    ~OperationDeadline();
+
+    OperationDeadline(const OperationDeadline&) = delete;
+    OperationDeadline& operator=(const OperationDeadline&) = delete;
+
+    static bool Passed();
+
+  private:
+    std::chrono::steady_clock::time_point previous_;
+};
+
+// Partial state of interrupted operations, so that calling the same operation
+// again with the same arguments at the same stop resumes where it left off.
+// Keys must identify the operation, its arguments and the stop ID.
+class ResumableOperations
+{
+  public:
+    // Existing state for key, or a freshly constructed one
+    template <class State> std::shared_ptr<State> Acquire(const std::string& key)
+    {
+        auto it = states_.find(key);
+        if (it != states_.end())
+            return std::static_pointer_cast<State>(it->second);
+        if (states_.size() >= kMaxStates)
+            states_.clear();
+        auto state = std::make_shared<State>();
+        states_.emplace(key, state);
+        return state;
+    }
+
+    // Drop state once an operation ran to completion
+    void Complete(const std::string& key) { states_.erase(key); }
+
+    void Clear() { states_.clear(); }
+
+  private:
+    static constexpr size_t kMaxStates = 16;
+    std::unordered_map<std::string, std::shared_ptr<void>> states_;
+};
+
+// Global store of interrupted operations
+ResumableOperations& GetResumableOperations();
+
+// Key prefix tying resumable state to the current process stop
+std::string StopKey(lldb::SBDebugger& debugger);
+
+} // namespace lldb_copilot
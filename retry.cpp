@@ -0,0 +1,130 @@
+#include "retry.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr auto kBaseDelay = std::chrono::milliseconds(1000);
+constexpr auto kMaxDelay = std::chrono::milliseconds(16000);
+} // namespace
+
+bool IsRetryableError(const std::string& message)
+{
+    // Match whole words, so that "500" in "1500 tokens" or "eof" inside a
+    // longer word does not count
+    std::vector<std::string> words(1);
+    for (unsigned char c : message)
+    {
+        if (std::isalnum(c))
+            words.back() += static_cast<char>(std::tolower(c));
+        else if (!words.back().empty())
+            words.emplace_back();
+    }
+    if (words.back().empty())
+        words.pop_back();
+
+    auto has = [&](std::initializer_list<const char*> phrase)
+    {
+        for (size_t i = 0; i + phrase.size() <= words.size(); i++)
+            if (std::equal(phrase.begin(), phrase.end(), words.begin() + i,
+                           [](const char* a, const std::string& b) { return b == a; }))
+                return true;
+        return false;
+    };
+    // A status code, as in "HTTP 503", "status: 429" or "500 Internal Server Error"
+    auto has_status = [&](std::initializer_list<const char*> codes)
+    {
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            if (std::none_of(codes.begin(), codes.end(),
+                             [&](const char* code) { return words[i] == code; }))
+                continue;
+            const std::string prev = i ? words[i - 1] : "";
+            const std::string next = i + 1 < words.size() ? words[i + 1] : "";
+            if (prev == "http" || prev == "status" || prev == "code" || prev == "error" ||
+                next == "internal" || next == "bad" || next == "service" || next == "gateway" ||
+                next == "too" || next == "unauthorized" || next == "forbidden" ||
+                next == "overloaded")
+                return true;
+        }
+        return false;
+    };
+
+    if (has_status({"401", "403"}) || has({"unauthorized"}) || has({"forbidden"}) ||
+        has({"invalid", "api", "key"}) || has({"authentication"}) || has({"not", "logged", "in"}))
+        return false;
+
+    if (has_status({"429", "500", "502", "503", "504", "529"}))
+        return true;
+    for (auto phrase : std::initializer_list<std::initializer_list<const char*>>{
+             {"timeout"}, {"timed", "out"}, {"etimedout"}, {"rate", "limit"},
+             {"rate", "limited"}, {"too", "many", "requests"}, {"overloaded"}, {"unavailable"},
+             {"connection"}, {"econnreset"}, {"econnrefused"}, {"refused"}, {"broken", "pipe"},
+             {"epipe"}, {"eof"}, {"network"}, {"temporarily"}, {"temporary"}, {"try", "again"},
+             {"exited"}, {"terminated"}})
+        if (has(phrase))
+            return true;
+    return false;
+}
+
+std::chrono::milliseconds BackoffDelay(unsigned attempt)
+{
+    static std::mt19937 rng{std::random_device{}()};
+    auto step = kBaseDelay * (1u << std::min(attempt > 0 ? attempt - 1 : 0u, 4u));
+    step = std::min<std::chrono::milliseconds>(step, kMaxDelay);
+    std::uniform_int_distribution<long long> jitter(step.count() / 2, step.count());
+    return std::chrono::milliseconds(jitter(rng));
+}
+
+const std::string* ToolReplayCache::Next(const std::string& key, const std::string& stop)
+{
+    size_t n = cursor_[key]++;
+    if (!replaying_)
+        return nullptr;
+    auto it = results_.find(key);
+    if (it == results_.end() || n >= it->second.size())
+        return nullptr;
+
+    const Entry& entry = it->second[n];
+    if (entry.after == stop)
+        return entry.result.get();
+    // A read at another stop is stale and runs again; a call that moved the
+    // process elsewhere means the recorded calls no longer match its state
+    if (entry.before != entry.after)
+        replaying_ = false;
+    return nullptr;
+}
+
+void ToolReplayCache::Record(const std::string& key, std::shared_ptr<const std::string> result,
+                             const std::string& before, const std::string& after)
+{
+    auto& results = results_[key];
+    size_t n = cursor_[key];
+    if (n == 0)
+        return; // Not passed to Next
+    if (results.size() < n)
+        results.push_back({std::move(result), before, after});
+    else
+        results[n - 1] = {std::move(result), before, after}; // Ran again: keep the fresh result
+}
+
+void ToolReplayCache::Rewind()
+{
+    cursor_.clear();
+    replaying_ = true;
+}
+
+void ToolReplayCache::Clear()
+{
+    results_.clear();
+    cursor_.clear();
+    replaying_ = false;
+}
+
+} // namespace lldb_copilot
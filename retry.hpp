@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// Counters for provider failures and recovery (shown by "agent stats")
+struct RetryStats
+{
+    unsigned failures = 0;   // Provider errors
+    unsigned retries = 0;    // Queries re-sent after an error
+    unsigned failovers = 0;  // Switches to the failover provider
+    unsigned recovered = 0;  // Questions answered after at least one error
+    unsigned gave_up = 0;    // Questions that failed for good
+    unsigned cache_hits = 0; // Tool calls answered from the replay cache
+    double recovery_ms = 0;  // Total time from first error to answer
+    double max_recovery_ms = 0;
+};
+
+// True for errors worth retrying: timeouts, rate limits, 5xx, overload and
+// connection failures. Authentication and request errors are not. Keywords
+// are matched as whole words and status codes only next to "HTTP", "status",
+// "error" or their reason phrase.
+bool IsRetryableError(const std::string& message);
+
+// Backoff before retry number attempt (1-based): exponential from 1 s,
+// capped at 16 s, with jitter between 50% and 100% of the step
+std::chrono::milliseconds BackoffDelay(unsigned attempt);
+
+// Tool results of the current question, so that a retried query replays
+// them instead of executing the same commands again. Calls are matched by
+// tool, arguments and occurrence, and each result carries the process stop
+// (StopKey) before and after the call. A result is replayed only while the
+// process is still at the stop it describes: after "bt; continue; bt" a
+// retry runs the first backtrace again, replays "continue" without resuming
+// and replays the second backtrace. A state-changing call that cannot be
+// replayed ends replay for the rest of the attempt.
+class ToolReplayCache
+{
+  public:
+    // Result of the n-th call with this key in the current attempt, or null
+    // when it has to be executed (not seen before, stale, or not replaying).
+    // stop is the StopKey of the process now.
+    const std::string* Next(const std::string& key, const std::string& stop);
+
+    // Record the result of the call last passed to Next, with the StopKey
+    // before and after it ran. The buffer is shared, not copied.
+    void Record(const std::string& key, std::shared_ptr<const std::string> result,
+                const std::string& before, const std::string& after);
+
+    // Start a retry: calls are matched from the beginning again
+    void Rewind();
+
+    // New question
+    void Clear();
+
+  private:
+    struct Entry
+    {
+        std::shared_ptr<const std::string> result;
+        std::string before; // StopKey when the call started
+        std::string after;  // and when it returned; differs if it ran the process
+    };
+
+    std::unordered_map<std::string, std::vector<Entry>> results_;
+    std::unordered_map<std::string, size_t> cursor_;
+    bool replaying_ = false;
+};
+
+} // namespace lldb_copilot
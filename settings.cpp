@@ -86,6 +86,30 @@ Settings LoadSettings()
                 if (j.contains("response_timeout_ms"))
                     settings.response_timeout_ms = j["response_timeout_ms"].get<int>();
 
+                if (j.contains("hedge_provider"))
+                    settings.hedge_provider = j["hedge_provider"].get<std::string>();
+
+                if (j.contains("hedge_delay_ms"))
+                    settings.hedge_delay_ms = j["hedge_delay_ms"].get<int>();
+
+                if (j.contains("retry_max"))
+                    settings.retry_max = j["retry_max"].get<int>();
+
+                if (j.contains("failover"))
+                    settings.failover = j["failover"].get<std::string>();
+
+                if (j.contains("failover_after"))
+                    settings.failover_after = j["failover_after"].get<int>();
+
+                if (j.contains("allow_resume"))
+                    settings.allow_resume = j["allow_resume"].get<bool>();
+
+                if (j.contains("low_intrusion"))
+                    settings.low_intrusion = j["low_intrusion"].get<bool>();
+
+                if (j.contains("stop_budget_ms"))
+                    settings.stop_budget_ms = j["stop_budget_ms"].get<int>();
+
                 if (j.contains("sessions"))
                     for (auto& [key, value] : j["sessions"].items())
                         settings.sessions[key] = value.get<std::string>();
@@ -140,6 +164,24 @@ void SaveSettings(const Settings& settings)
         j["custom_prompt"] = settings.custom_prompt;
     if (settings.response_timeout_ms > 0)
         j["response_timeout_ms"] = settings.response_timeout_ms;
+    if (!settings.hedge_provider.empty())
+    {
+        j["hedge_provider"] = settings.hedge_provider;
+        j["hedge_delay_ms"] = settings.hedge_delay_ms;
+    }
+    j["retry_max"] = settings.retry_max;
+    if (!settings.failover.empty())
+    {
+        j["failover"] = settings.failover;
+        j["failover_after"] = settings.failover_after;
+    }
+    if (settings.allow_resume)
+        j["allow_resume"] = true;
+    if (settings.low_intrusion)
+    {
+        j["low_intrusion"] = true;
+        j["stop_budget_ms"] = settings.stop_budget_ms;
+    }
     if (!settings.sessions.empty())
     {
         json sessions_json;
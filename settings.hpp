@@ -46,6 +46,29 @@ struct Settings
     // Response timeout in milliseconds (0 = use default 60s)
     int response_timeout_ms = 120000; // 2 minutes default
 
+    // Hedging: if the provider has produced nothing after hedge_delay_ms, the
+    // same question is also sent to hedge_provider (empty = disabled)
+    std::string hedge_provider;
+    int hedge_delay_ms = 20000;
+
+    // Provider errors: retryable errors are retried up to retry_max times with
+    // jittered backoff; after failover_after failures (or at once for errors
+    // that are not retryable) the query moves to failover, a provider name or
+    // "byok" for the current provider's BYOK endpoint (empty = disabled)
+    int retry_max = 3;
+    std::string failover;
+    int failover_after = 2;
+
+    // Whether tools that sample a live process over time (dbg_thread_states,
+    // dbg_detect_hang, dbg_lock_contention) may resume it when it is stopped
+    bool allow_resume = false;
+
+    // Low-intrusion mode for live processes: tools leave a running process
+    // running and stop it only in short bursts, at most stop_budget_ms in
+    // total per question
+    bool low_intrusion = false;
+    int stop_budget_ms = 200;
+
     // Session ID mappings (target_path|provider -> session_id)
     std::unordered_map<std::string, std::string> sessions;
 
@@ -0,0 +1,176 @@
+#include "stack_sampler.hpp"
+#include "process_control.hpp"
+#include "progress.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr std::chrono::milliseconds kSleepSlice{20}; // Cancellation check interval
+
+struct KernelState
+{
+    TaskStat stat;
+    TaskSyscall call;
+};
+
+// Sleep for ms unless cancelled first
+bool Wait(int ms, OperationProgress& progress)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    for (auto now = std::chrono::steady_clock::now(); now < deadline;
+         now = std::chrono::steady_clock::now())
+    {
+        if (progress.Cancelled())
+            return false;
+        std::chrono::steady_clock::duration left = deadline - now;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(kSleepSlice,
+                                                                                  left));
+    }
+    return !progress.Cancelled();
+}
+
+SampledFrame ReadFrame(lldb::SBFrame frame)
+{
+    SampledFrame out;
+    out.pc = frame.GetPC();
+    const char* fn = frame.GetFunctionName();
+    out.function = fn ? fn : "??";
+    const char* module = frame.GetModule().GetFileSpec().GetFilename();
+    if (module)
+        out.module = module;
+    lldb::SBLineEntry line = frame.GetLineEntry();
+    const char* file = line.IsValid() ? line.GetFileSpec().GetFilename() : nullptr;
+    if (file && line.GetLine())
+        out.location = std::string(file) + ":" + std::to_string(line.GetLine());
+    return out;
+}
+} // namespace
+
+bool SampleStacks(lldb::SBDebugger& debugger, int samples, int interval_ms, uint32_t max_frames,
+                  SampleRun& run, std::string& error, const SampleHook& hook)
+{
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid())
+    {
+        error = "no process";
+        return false;
+    }
+    const char* plugin = process.GetPluginName();
+    if (plugin && std::string(plugin) == "elf-core")
+    {
+        error = "sampling needs a live process (a core file cannot run)";
+        return false;
+    }
+    if (process.GetState() != lldb::eStateStopped && !IsRunning(process))
+    {
+        error = "process is neither stopped nor running";
+        return false;
+    }
+
+    uint64_t pid = LocalProcfsPid(process);
+    run.local = pid != 0;
+
+    // Outside low-intrusion mode bursts are measured but not capped
+    StopBudget unlimited;
+    unlimited.Begin(std::numeric_limits<int>::max());
+    StopBudget& stops = GetStopBudget().active() ? GetStopBudget() : unlimited;
+
+    ResumeScope scope(debugger, process);
+    if (!scope.error().empty())
+    {
+        error = "cannot resume process: " + scope.error();
+        return false;
+    }
+
+    OperationProgress progress(debugger, "Sampling stacks", samples);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++)
+    {
+        if (!Wait(interval_ms, progress))
+        {
+            run.note = "interrupted after " + std::to_string(i) + " samples";
+            break;
+        }
+        if (!IsRunning(process))
+        {
+            run.note = "process stopped or exited by itself after " + std::to_string(i) +
+                       " samples";
+            break;
+        }
+
+        StackSample sample;
+        sample.ms = MsSince(start);
+
+        // Kernel view while the threads still run: a stop would interrupt
+        // their system calls
+        std::unordered_map<uint64_t, KernelState> kernel;
+        std::vector<uint64_t> tids;
+        if (pid && ListTasks(pid, tids))
+            for (uint64_t tid : tids)
+            {
+                KernelState& k = kernel[tid];
+                ReadTaskStat(pid, tid, k.stat);
+                ReadTaskSyscall(pid, tid, k.call);
+            }
+
+        StopBurst burst(debugger, process, stops);
+        if (!burst.ok())
+        {
+            run.note = burst.error();
+            break;
+        }
+        for (uint32_t t = 0; t < process.GetNumThreads(); t++)
+        {
+            lldb::SBThread thread = process.GetThreadAtIndex(t);
+            ThreadSample ts;
+            ts.tid = thread.GetThreadID();
+            ts.index_id = thread.GetIndexID();
+            auto k = kernel.find(ts.tid);
+            if (k != kernel.end())
+            {
+                ts.kernel_known = true;
+                ts.state = k->second.stat.state;
+                ts.cpu_ticks = k->second.stat.utime + k->second.stat.stime;
+                ts.call = k->second.call;
+            }
+            uint32_t n = std::min(thread.GetNumFrames(), max_frames);
+            for (uint32_t f = 0; f < n; f++)
+                ts.frames.push_back(ReadFrame(thread.GetFrameAtIndex(f)));
+            sample.threads.push_back(std::move(ts));
+        }
+        if (hook)
+            hook(process, sample);
+
+        double ms = burst.Resume();
+        run.stopped_ms += ms;
+        run.longest_stop_ms = std::max(run.longest_stop_ms, ms);
+        run.samples.push_back(std::move(sample));
+        if (!burst.own_stop().empty())
+        {
+            run.note = "process stopped by itself and was left stopped: " + burst.own_stop();
+            break;
+        }
+        progress.Increment();
+    }
+    run.elapsed_ms = MsSince(start);
+
+    scope.Stop();
+    if (!scope.own_stop().empty() && run.note.empty())
+        run.note = "process " + scope.own_stop();
+    if (run.samples.empty())
+    {
+        error = run.note.empty() ? "no samples taken" : run.note;
+        return false;
+    }
+    return true;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "procfs.hpp"
+
+#include <functional>
+#include <lldb/API/LLDB.h>
+#include <string>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+struct SampledFrame
+{
+    uint64_t pc = 0;
+    std::string function; // "??" when unknown
+    std::string module;   // File name of the module, "" when unknown
+    std::string location; // "file.cpp:12" when there is line information
+};
+
+// One thread at one sample
+struct ThreadSample
+{
+    uint64_t tid = 0;
+    uint32_t index_id = 0;
+    bool kernel_known = false; // state, cpu_ticks and call were read from /proc
+    char state = '?';
+    uint64_t cpu_ticks = 0; // utime + stime
+    TaskSyscall call;       // Read just before the process was stopped
+    std::vector<SampledFrame> frames; // Innermost first
+};
+
+struct StackSample
+{
+    double ms = 0; // Since sampling started
+    std::vector<ThreadSample> threads;
+};
+
+struct SampleRun
+{
+    std::vector<StackSample> samples;
+    bool local = false;     // Kernel state was available
+    double elapsed_ms = 0;
+    double stopped_ms = 0;  // Total time the process was stopped for unwinding
+    double longest_stop_ms = 0;
+    std::string note;       // Why sampling ended early, if it did
+};
+
+// Called for each sample while the process is stopped (e.g. to read memory)
+using SampleHook = std::function<void(lldb::SBProcess& process, StackSample& sample)>;
+
+// Samples every thread's stack: the process runs for interval_ms between
+// samples and is stopped only to unwind. A stopped process is resumed for the
+// duration and interrupted again at the end, if ResumeScope allows it (else
+// error is set); a running one is left running.
+// In low-intrusion mode the stops count against the question's stop budget.
+// On a local Linux process each thread's scheduler state and system call are
+// read from /proc just before every stop. False (with error) if no sample
+// could be taken.
+bool SampleStacks(lldb::SBDebugger& debugger, int samples, int interval_ms, uint32_t max_frames,
+                  SampleRun& run, std::string& error, const SampleHook& hook = {});
+
+} // namespace lldb_copilot
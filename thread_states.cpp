@@ -0,0 +1,289 @@
+#include "thread_states.hpp"
+#include "process_control.hpp"
+#include "procfs.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr int kMaxIntervalMs = 5000;
+constexpr uint32_t kShownFrames = 3;
+constexpr double kSpinningPercent = 50.0;
+constexpr size_t kShownGroupTids = 6;
+
+using Sample = std::unordered_map<uint64_t, TaskStat>;
+
+Sample TakeSample(uint64_t pid)
+{
+    Sample sample;
+    std::vector<uint64_t> tids;
+    ListTasks(pid, tids);
+    for (uint64_t tid : tids)
+    {
+        TaskStat stat;
+        if (ReadTaskStat(pid, tid, stat))
+            sample.emplace(tid, stat);
+    }
+    return sample;
+}
+
+std::string DescribeCall(const TaskSyscall& call)
+{
+    switch (call.kind)
+    {
+    case TaskSyscall::Kind::Unknown:
+        return "?";
+    case TaskSyscall::Kind::Running:
+        return "(on cpu)";
+    case TaskSyscall::Kind::NoSyscall:
+        return "-";
+    case TaskSyscall::Kind::Syscall:
+        break;
+    }
+    const char* name = SyscallName(call.nr);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%s(0x%" PRIx64 ")",
+                  name ? name : ("syscall " + std::to_string(call.nr)).c_str(), call.args[0]);
+    return buf;
+}
+
+// Innermost function names, "a <- b <- c"
+std::string TopFrames(lldb::SBThread thread)
+{
+    std::string out;
+    uint32_t n = std::min(thread.GetNumFrames(), kShownFrames);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const char* fn = thread.GetFrameAtIndex(i).GetFunctionName();
+        out += (i ? " <- " : "") + std::string(fn ? fn : "??");
+    }
+    return out;
+}
+
+struct Row
+{
+    std::vector<uint64_t> tids;
+    std::string index_ids;
+    char state = '?';
+    double cpu = 0; // Percent of one CPU over the interval
+    double user_ms = 0;
+    double sys_ms = 0;
+    std::string call;
+    std::string frames;
+};
+} // namespace
+
+std::string CollectThreadStates(lldb::SBDebugger& debugger, int interval_ms, size_t budget)
+{
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (!process.IsValid())
+        return "Error: no process";
+
+    uint64_t pid = LocalProcfsPid(process);
+    if (!pid)
+        return "Error: thread states need a live process on this Linux host (not a core or "
+               "remote target); use dbg_backtrace or 'thread list' instead";
+
+    int interval = std::min(interval_ms, kMaxIntervalMs);
+    std::string note;
+    Sample first;
+    Sample last;
+    std::unordered_map<uint64_t, TaskSyscall> calls;
+    double elapsed_ms = 0;
+
+    auto read_calls = [&]()
+    {
+        for (const auto& [tid, stat] : last)
+            ReadTaskSyscall(pid, tid, calls[tid]);
+    };
+
+    bool sampled = false;
+    std::unique_ptr<ResumeScope> scope;
+    if (interval > 0)
+    {
+        // Let a stopped process run so CPU use and blocking calls are real;
+        // ResumeScope refuses at crash and breakpoint stops
+        scope = std::make_unique<ResumeScope>(debugger, process);
+        if (!scope->error().empty())
+            note = "CPU not sampled, process not resumed: " + scope->error() + "\n";
+    }
+    if (scope && scope->error().empty())
+    {
+        sampled = true;
+        auto start = std::chrono::steady_clock::now();
+        first = TakeSample(pid);
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+        last = TakeSample(pid);
+        elapsed_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+        read_calls();
+        if (scope->resumed())
+        {
+            bool stopped = scope->Stop();
+            char buf[160];
+            std::snprintf(buf, sizeof(buf),
+                          "process resumed for %.0f ms to sample, then interrupted (stop id "
+                          "%u)\n",
+                          scope->ran_ms(), process.GetStopID());
+            note = buf;
+            if (!scope->own_stop().empty())
+                note += "note: while resumed the process " + scope->own_stop() + "\n";
+            if (!stopped && !scope->error().empty())
+                note += "warning: " + scope->error() + "\n";
+        }
+    }
+    if (!sampled)
+    {
+        last = TakeSample(pid);
+        read_calls();
+    }
+
+    // LLDB thread index IDs and top frames, when stopped. In low-intrusion
+    // mode a running process is stopped just for the unwind.
+    std::unordered_map<uint64_t, std::pair<uint32_t, std::string>> sb_threads;
+    bool stopped = false;
+    {
+        StopBurst burst(debugger, process, GetStopBudget());
+        stopped = burst.ok() && process.GetState() == lldb::eStateStopped;
+        for (uint32_t i = 0; stopped && i < process.GetNumThreads(); i++)
+        {
+            lldb::SBThread thread = process.GetThreadAtIndex(i);
+            sb_threads.emplace(thread.GetThreadID(),
+                               std::make_pair(thread.GetIndexID(), TopFrames(thread)));
+        }
+        if (burst.interrupted())
+        {
+            char buf[96];
+            std::snprintf(buf, sizeof(buf), "process stopped %.1f ms to unwind, then resumed\n",
+                          burst.Resume());
+            if (!burst.own_stop().empty())
+                note += "note: the process stopped by itself and was left stopped: " +
+                        burst.own_stop() + "\n";
+            else if (burst.ok())
+                note += buf;
+        }
+        if (!burst.ok())
+            note += "frames not read: " + burst.error() + "\n";
+    }
+
+    double ticks = static_cast<double>(ClockTicksPerSecond());
+    std::vector<Row> rows;
+    std::map<std::string, size_t> groups; // Idle rows by state|call|frames
+    std::map<std::string, unsigned> blocked_in;
+    unsigned spinning = 0;
+    unsigned runnable = 0;
+    for (const auto& [tid, stat] : last)
+    {
+        Row row;
+        row.tids.push_back(tid);
+        row.state = stat.state;
+        auto before = first.find(tid);
+        if (before != first.end())
+        {
+            row.user_ms = (stat.utime - before->second.utime) * 1000.0 / ticks;
+            row.sys_ms = (stat.stime - before->second.stime) * 1000.0 / ticks;
+            row.cpu = elapsed_ms > 0 ? 100.0 * (row.user_ms + row.sys_ms) / elapsed_ms : 0;
+        }
+        const TaskSyscall& call = calls[tid];
+        row.call = DescribeCall(call);
+        auto sb = sb_threads.find(tid);
+        if (sb != sb_threads.end())
+        {
+            row.index_ids = "#" + std::to_string(sb->second.first);
+            row.frames = sb->second.second;
+        }
+        else
+        {
+            row.frames = stopped ? "(not known to LLDB)" : "(running)";
+        }
+
+        if (row.cpu >= kSpinningPercent)
+            spinning++;
+        if (call.kind == TaskSyscall::Kind::Running || stat.state == 'R')
+            runnable++;
+        else if (call.kind == TaskSyscall::Kind::Syscall)
+            blocked_in[SyscallName(call.nr) ? SyscallName(call.nr)
+                                            : "syscall " + std::to_string(call.nr)]++;
+
+        // Threads without CPU use that look alike are one row
+        if (row.user_ms + row.sys_ms == 0)
+        {
+            std::string call_name = row.call.substr(0, row.call.find('('));
+            std::string key = std::string(1, row.state) + "|" + call_name + "|" + row.frames;
+            auto it = groups.find(key);
+            if (it != groups.end())
+            {
+                Row& group = rows[it->second];
+                group.tids.push_back(tid);
+                if (group.tids.size() <= kShownGroupTids && !row.index_ids.empty())
+                    group.index_ids += "," + row.index_ids;
+                continue;
+            }
+            groups.emplace(key, rows.size());
+        }
+        rows.push_back(std::move(row));
+    }
+
+    std::sort(rows.begin(), rows.end(),
+              [](const Row& a, const Row& b)
+              {
+                  if (a.cpu != b.cpu)
+                      return a.cpu > b.cpu;
+                  return a.tids.size() > b.tids.size();
+              });
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "pid %" PRIu64 ": %zu threads", pid, last.size());
+    std::string out = note + line;
+    if (elapsed_ms > 0)
+    {
+        std::snprintf(line, sizeof(line), "; CPU over %.0f ms", elapsed_ms);
+        out += line;
+    }
+    out += "\n";
+    out += "spinning (>=50% CPU): " + std::to_string(spinning) +
+           ", runnable: " + std::to_string(runnable) + ", blocked in:";
+    if (blocked_in.empty())
+        out += " none";
+    for (const auto& [name, count] : blocked_in)
+        out += " " + name + " x" + std::to_string(count);
+    out += "\n";
+    if (interval <= 0)
+        out += "(CPU not sampled: interval_ms 0)\n";
+    out += "tid (#idx) state cpu% user/sys ms | syscall(arg0) | top frames\n";
+
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        const Row& row = rows[i];
+        std::string tids;
+        for (size_t t = 0; t < row.tids.size() && t < kShownGroupTids; t++)
+            tids += (t ? "," : "") + std::to_string(row.tids[t]);
+        if (row.tids.size() > kShownGroupTids)
+            tids += ",... x" + std::to_string(row.tids.size());
+        std::snprintf(line, sizeof(line), "%s%s%s %c %5.1f %.0f/%.0f | ", tids.c_str(),
+                      row.index_ids.empty() ? "" : " ", row.index_ids.c_str(), row.state, row.cpu,
+                      row.user_ms, row.sys_ms);
+        std::string entry = line + row.call + " | " + row.frames + "\n";
+        if (out.size() + entry.size() > budget)
+        {
+            out += "(truncated: " + std::to_string(rows.size() - i) + " more rows)\n";
+            break;
+        }
+        out += entry;
+    }
+    return out;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "native_tools.hpp"
+
+#include <lldb/API/LLDB.h>
+#include <string>
+
+namespace lldb_copilot
+{
+
+// Per-thread scheduler state, CPU use and in-flight system call of a local
+// Linux process, joined with LLDB thread index IDs and top frames, for telling
+// spinning threads from blocked ones. With interval_ms > 0 a stopped
+// process is resumed for interval_ms to measure CPU and then interrupted
+// again (only if ResumeScope allows it; otherwise states are read as they
+// are), and a running one is sampled as it runs. interval_ms <= 0 reads
+// states without resuming.
+// Threads in the same state, call and frames are grouped into one row.
+std::string CollectThreadStates(lldb::SBDebugger& debugger, int interval_ms,
+                                size_t budget = kToolResultBudget);
+
+} // namespace lldb_copilot
@@ -0,0 +1,31 @@
+// lldb_copilot_triage: print the first facts about a crash (signal, fault
+// address, threads, mapped files) from the ELF notes of core files, without
+// loading LLDB or symbols.
+#include "core_triage.hpp"
+
+#include <cstdio>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s <core>...\n", argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string report = lldb_copilot::TriageCoreFile(argv[i]);
+        if (argc > 2)
+            std::printf("== %s\n", argv[i]);
+        std::fputs(report.c_str(), report.rfind("Error:", 0) == 0 ? stderr : stdout);
+        if (report.rfind("Error:", 0) == 0)
+        {
+            std::fputc('\n', stderr);
+            status = 1;
+        }
+    }
+    return status;
+}
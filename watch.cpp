@@ -0,0 +1,588 @@
+#include "watch.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <lldb/API/SBCommandInterpreter.h>
+#include <lldb/API/SBCommandReturnObject.h>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace lldb_copilot
+{
+
+namespace
+{
+constexpr double kJumpFactor = 10.0; // Anomalous step vs. median recent step
+constexpr size_t kMinSteps = 4;      // Steps needed before "jump" can trip
+constexpr size_t kStepWindow = 16;
+constexpr size_t kReportHistory = 16;
+
+// New breakpoint resolving to the same locations as bp, with its condition,
+// made through a serialized copy. Auto-continue and one-shot are cleared;
+// the caller's callback replaces any commands copied along.
+lldb::SBBreakpoint CopyBreakpoint(lldb::SBTarget& target, lldb::SBBreakpoint& bp)
+{
+    char path[] = "/tmp/lldb-copilot-bp-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return lldb::SBBreakpoint();
+    close(fd);
+
+    lldb::SBFileSpec file(path);
+    lldb::SBBreakpointList original(target);
+    original.Append(bp);
+    lldb::SBBreakpointList copies(target);
+    lldb::SBBreakpoint copy;
+    if (target.BreakpointsWriteToFile(file, original).Success() &&
+        target.BreakpointsCreateFromFile(file, copies).Success() && copies.GetSize() == 1)
+    {
+        copy = copies.GetBreakpointAtIndex(0);
+        copy.SetAutoContinue(false);
+        copy.SetOneShot(false);
+    }
+    std::remove(path);
+    return copy;
+}
+
+std::string Trim(const std::string& s)
+{
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string FormatNumber(double v)
+{
+    std::ostringstream ss;
+    ss << v;
+    return ss.str();
+}
+
+bool Compare(const std::string& op, double lhs, double rhs)
+{
+    if (op == ">")
+        return lhs > rhs;
+    if (op == ">=")
+        return lhs >= rhs;
+    if (op == "<")
+        return lhs < rhs;
+    if (op == "<=")
+        return lhs <= rhs;
+    if (op == "==")
+        return lhs == rhs;
+    return lhs != rhs;
+}
+
+// Sample expr in frame. Breakpoint callbacks must not run code in the
+// inferior, so they only resolve variable paths.
+WatchSample Sample(lldb::SBFrame frame, const std::string& expr, bool allow_expression,
+                   uint32_t stop_id)
+{
+    WatchSample sample;
+    sample.stop_id = stop_id;
+
+    lldb::SBValue value = frame.GetValueForVariablePath(expr.c_str());
+    if ((!value.IsValid() || value.GetError().Fail()) && allow_expression)
+        value = frame.EvaluateExpression(expr.c_str());
+    if (!value.IsValid() || value.GetError().Fail())
+    {
+        const char* error = value.IsValid() ? value.GetError().GetCString() : nullptr;
+        sample.value = std::string("<") + (error ? error : "unavailable") + ">";
+        return sample;
+    }
+
+    const char* text = value.GetValue();
+    const char* summary = value.GetSummary();
+    sample.value = text ? text : (summary ? summary : "?");
+
+    lldb::SBError error;
+    if (value.GetType().IsPointerType())
+    {
+        sample.number = static_cast<double>(value.GetValueAsUnsigned(error));
+        sample.numeric = error.Success();
+    }
+    else if (text)
+    {
+        char* end = nullptr;
+        double number = std::strtod(text, &end);
+        if (end != text && *end == '\0')
+        {
+            sample.number = number;
+            sample.numeric = true;
+        }
+        else
+        {
+            int64_t integer = value.GetValueAsSigned(error);
+            sample.number = static_cast<double>(integer);
+            sample.numeric = error.Success();
+        }
+    }
+    return sample;
+}
+} // namespace
+
+WatchPredicate WatchPredicate::Parse(const std::string& input)
+{
+    WatchPredicate p;
+    p.text = Trim(input);
+    std::string t = p.text;
+    t.erase(std::remove_if(t.begin(), t.end(), [](unsigned char c) { return std::isspace(c); }),
+            t.end());
+
+    auto operand = [&](const std::string& s)
+    {
+        char* end = nullptr;
+        double v = std::strtod(s.c_str(), &end);
+        if (s.empty() || *end != '\0')
+            throw std::runtime_error("Invalid number in predicate: " + input);
+        return v;
+    };
+
+    if (t.empty() || t == "anomaly")
+    {
+        p.kind = Kind::Anomaly;
+        p.text = "anomaly";
+    }
+    else if (t == "changed")
+        p.kind = Kind::Changed;
+    else if (t == "null")
+        p.kind = Kind::Null;
+    else if (t == "nonnull")
+        p.kind = Kind::NonNull;
+    else if (t.rfind("jump", 0) == 0)
+    {
+        p.kind = Kind::Jump;
+        if (t.size() > 4)
+        {
+            if (t[4] != '>')
+                throw std::runtime_error("Expected jump>N, got: " + input);
+            p.operand = operand(t.substr(5));
+            p.has_operand = true;
+        }
+    }
+    else
+    {
+        for (const char* op : {">=", "<=", "==", "!=", ">", "<"})
+        {
+            if (t.rfind(op, 0) == 0)
+            {
+                p.kind = Kind::Compare;
+                p.op = op;
+                p.operand = operand(t.substr(p.op.size()));
+                p.has_operand = true;
+                return p;
+            }
+        }
+        throw std::runtime_error("Unknown predicate: " + input +
+                                 " (use anomaly, changed, null, nonnull, jump[>N] or <op> N)");
+    }
+    return p;
+}
+
+Watch::Watch(int id, std::string expr, WatchPredicate predicate)
+    : id_(id), expr_(std::move(expr)), predicate_(std::move(predicate)), ring_(kHistorySize)
+{
+}
+
+const WatchSample& Watch::At(size_t age) const
+{
+    return ring_[(head_ + kHistorySize - 1 - age) % kHistorySize];
+}
+
+std::string Watch::History(size_t n) const
+{
+    std::string text;
+    for (size_t age = std::min(n, count_); age-- > 0;)
+    {
+        const WatchSample& s = At(age);
+        if (!text.empty())
+            text += " ";
+        text += s.value + "@" + std::to_string(s.stop_id);
+    }
+    return text;
+}
+
+std::string Watch::Record(const WatchSample& sample)
+{
+    std::string reason;
+    bool have_prev = count_ > 0;
+    WatchSample prev = have_prev ? At(0) : WatchSample{};
+
+    // Jump detection against the median step of the recent numeric history
+    auto jump = [&]() -> bool
+    {
+        if (!have_prev || !prev.numeric || !sample.numeric)
+            return false;
+        double delta = std::fabs(sample.number - prev.number);
+        double threshold = predicate_.operand;
+        if (!predicate_.has_operand)
+        {
+            std::vector<double> steps;
+            for (size_t age = 0; age + 1 < count_ && steps.size() < kStepWindow; age++)
+            {
+                const WatchSample& a = At(age);
+                const WatchSample& b = At(age + 1);
+                if (a.numeric && b.numeric)
+                    steps.push_back(std::fabs(a.number - b.number));
+            }
+            if (steps.size() < kMinSteps)
+                return false;
+            std::nth_element(steps.begin(), steps.begin() + steps.size() / 2, steps.end());
+            threshold = std::max(steps[steps.size() / 2], 1.0) * kJumpFactor;
+        }
+        if (delta <= threshold)
+            return false;
+        reason = prev.value + " -> " + sample.value + " (jump " + FormatNumber(delta) + " > " +
+                 FormatNumber(threshold) + ")";
+        return true;
+    };
+
+    bool tripped = false;
+    bool is_null = sample.numeric && sample.number == 0;
+    switch (predicate_.kind)
+    {
+    case WatchPredicate::Kind::Changed:
+        tripped = have_prev && prev.value != sample.value;
+        if (tripped)
+            reason = prev.value + " -> " + sample.value;
+        break;
+    case WatchPredicate::Kind::Jump:
+        tripped = jump();
+        break;
+    case WatchPredicate::Kind::Anomaly:
+        if (is_null && !active_ && have_prev)
+        {
+            tripped = true;
+            reason = prev.value + " -> " + sample.value + " (became null)";
+        }
+        else
+        {
+            tripped = jump();
+        }
+        active_ = is_null;
+        break;
+    default:
+    {
+        bool now = false;
+        if (predicate_.kind == WatchPredicate::Kind::Null)
+            now = is_null;
+        else if (predicate_.kind == WatchPredicate::Kind::NonNull)
+            now = sample.numeric && sample.number != 0;
+        else
+            now = sample.numeric && Compare(predicate_.op, sample.number, predicate_.operand);
+        tripped = now && !active_;
+        active_ = now;
+        if (tripped)
+            reason = (have_prev ? prev.value + " -> " : std::string()) + sample.value + " (" +
+                     predicate_.text + ")";
+        break;
+    }
+    }
+
+    ring_[head_] = sample;
+    head_ = (head_ + 1) % kHistorySize;
+    count_ = std::min(count_ + 1, kHistorySize);
+    if (tripped)
+        trips_++;
+    return tripped ? reason : "";
+}
+
+int WatchManager::Add(lldb::SBDebugger& debugger, const std::string& expr,
+                      const std::string& when, const std::string& at, std::string* error)
+{
+    WatchPredicate predicate;
+    try
+    {
+        predicate = WatchPredicate::Parse(when);
+    }
+    catch (const std::exception& e)
+    {
+        if (error)
+            *error = e.what();
+        return 0;
+    }
+
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    if (!target.IsValid())
+    {
+        if (error)
+            *error = "No target selected";
+        return 0;
+    }
+
+    // A stop-driven watch has to evaluate where the process is stopped now;
+    // one at a breakpoint may use names only in scope there
+    lldb::SBProcess process = target.GetProcess();
+    if (at.empty() && process.IsValid() && process.GetState() == lldb::eStateStopped)
+    {
+        lldb::SBFrame frame = process.GetSelectedThread().GetSelectedFrame();
+        lldb::SBValue value = frame.GetValueForVariablePath(expr.c_str());
+        if (!value.IsValid() || value.GetError().Fail())
+            value = frame.EvaluateExpression(expr.c_str());
+        if (!value.IsValid() || value.GetError().Fail())
+        {
+            const char* reason = value.IsValid() ? value.GetError().GetCString() : nullptr;
+            if (error)
+                *error = "Cannot evaluate '" + expr + "' in the selected frame: " +
+                         (reason ? reason : "unavailable");
+            return 0;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto watch = std::make_unique<Watch>(next_id_, expr, predicate);
+
+    if (!at.empty())
+    {
+        lldb::SBBreakpoint bp;
+        bool numeric = std::all_of(at.begin(), at.end(), [](unsigned char c)
+                                   { return std::isdigit(c); });
+        if (numeric)
+        {
+            // The user's breakpoint keeps its own callback, commands and stops
+            errno = 0;
+            unsigned long bp_id = std::strtoul(at.c_str(), nullptr, 10);
+            bool in_range = errno != ERANGE &&
+                            bp_id <= static_cast<unsigned long>(
+                                         std::numeric_limits<lldb::break_id_t>::max());
+            lldb::SBBreakpoint user;
+            if (in_range)
+                user = target.FindBreakpointByID(static_cast<lldb::break_id_t>(bp_id));
+            if (!user.IsValid())
+            {
+                if (error)
+                    *error = "No breakpoint " + at;
+                return 0;
+            }
+            bp = CopyBreakpoint(target, user);
+            if (!bp.IsValid())
+            {
+                if (error)
+                    *error = "Could not set a breakpoint at the locations of breakpoint " + at;
+                return 0;
+            }
+        }
+        else
+        {
+            bp = target.BreakpointCreateByName(at.c_str());
+        }
+        if (!bp.IsValid() || bp.GetNumLocations() == 0)
+        {
+            if (bp.IsValid())
+                target.BreakpointDelete(bp.GetID());
+            if (error)
+                *error = "No breakpoint locations for '" + at + "'";
+            return 0;
+        }
+        watch->breakpoint = bp.GetID();
+        watch->at = at;
+        bp.SetCallback(&WatchManager::BreakpointHit, this);
+    }
+
+    int id = next_id_++;
+    watches_.emplace(id, std::move(watch));
+    EnsureStopHook(debugger);
+    return id;
+}
+
+void WatchManager::Detach(lldb::SBTarget target, Watch& watch)
+{
+    if (watch.breakpoint == LLDB_INVALID_BREAK_ID)
+        return;
+
+    bool shared = std::any_of(watches_.begin(), watches_.end(), [&](const auto& entry)
+                              { return entry.second.get() != &watch &&
+                                       entry.second->breakpoint == watch.breakpoint; });
+    if (shared)
+        return;
+
+    if (target.FindBreakpointByID(watch.breakpoint).IsValid())
+        target.BreakpointDelete(watch.breakpoint);
+}
+
+bool WatchManager::Remove(lldb::SBDebugger& debugger, int id)
+{
+    bool now_empty = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = watches_.find(id);
+        if (it == watches_.end())
+            return false;
+        Detach(debugger.GetSelectedTarget(), *it->second);
+        watches_.erase(it);
+        now_empty = watches_.empty();
+    }
+    if (now_empty)
+        RemoveStopHook(debugger);
+    return true;
+}
+
+void WatchManager::Clear(lldb::SBDebugger& debugger)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lldb::SBTarget target = debugger.GetSelectedTarget();
+        for (auto it = watches_.begin(); it != watches_.end();)
+        {
+            Detach(target, *it->second);
+            it = watches_.erase(it);
+        }
+        pending_.clear();
+    }
+    RemoveStopHook(debugger);
+}
+
+bool WatchManager::Empty()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watches_.empty();
+}
+
+std::string WatchManager::List()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (watches_.empty())
+        return "No watches.\n";
+
+    std::string text;
+    for (const auto& [id, watch] : watches_)
+    {
+        text += "#" + std::to_string(id) + "  " + watch->expr() + "  when " +
+                watch->predicate().text;
+        text += watch->breakpoint == LLDB_INVALID_BREAK_ID
+                    ? "  (every stop)"
+                    : "  (at " + watch->at + ", breakpoint " +
+                          std::to_string(watch->breakpoint) + ")";
+        text += "  samples=" + std::to_string(watch->samples()) +
+                " trips=" + std::to_string(watch->trips()) + "\n";
+        if (watch->samples() > 0)
+            text += "    " + watch->History(8) + "\n";
+    }
+    return text;
+}
+
+std::vector<std::string> WatchManager::OnStop(lldb::SBDebugger& debugger)
+{
+    std::vector<std::string> reports;
+    std::vector<Watch*> stop_watches;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reports.swap(pending_);
+        for (auto& [id, watch] : watches_)
+            if (watch->breakpoint == LLDB_INVALID_BREAK_ID)
+                stop_watches.push_back(watch.get());
+    }
+
+    lldb::SBProcess process = debugger.GetSelectedTarget().GetProcess();
+    if (stop_watches.empty() || !process.IsValid() || process.GetState() != lldb::eStateStopped)
+        return reports;
+
+    lldb::SBThread thread = process.GetSelectedThread();
+    lldb::SBFrame frame = thread.GetSelectedFrame();
+    uint32_t stop_id = process.GetStopID();
+
+    // Watches are only removed from the command thread, which is this one.
+    // Sample without the lock: expression evaluation may run the inferior
+    // and re-enter BreakpointHit.
+    for (Watch* watch : stop_watches)
+    {
+        WatchSample sample = Sample(frame, watch->expr(), true, stop_id);
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string reason = watch->Record(sample);
+        if (reason.empty())
+            continue;
+
+        const char* fn = frame.GetDisplayFunctionName();
+        reports.push_back("watch #" + std::to_string(watch->id()) + " `" + watch->expr() +
+                          "` (when " + watch->predicate().text + ") at stop " +
+                          std::to_string(stop_id) + ", thread " +
+                          std::to_string(thread.GetIndexID()) + " in " + (fn ? fn : "??") +
+                          ": " + reason + "\n  history: " + watch->History(kReportHistory));
+    }
+    return reports;
+}
+
+bool WatchManager::BreakpointHit(void* baton, lldb::SBProcess& process, lldb::SBThread& thread,
+                                 lldb::SBBreakpointLocation& location)
+{
+    auto* self = static_cast<WatchManager*>(baton);
+    std::lock_guard<std::mutex> lock(self->mutex_);
+
+    lldb::break_id_t bp_id = location.GetBreakpoint().GetID();
+    lldb::SBFrame frame = thread.GetFrameAtIndex(0);
+    uint32_t stop_id = process.GetStopID();
+    bool stop = false;
+
+    for (auto& [id, watch] : self->watches_)
+    {
+        if (watch->breakpoint != bp_id)
+            continue;
+        std::string reason = watch->Record(Sample(frame, watch->expr(), false, stop_id));
+        if (reason.empty())
+            continue;
+
+        const char* fn = frame.GetDisplayFunctionName();
+        self->pending_.push_back("watch #" + std::to_string(id) + " `" + watch->expr() +
+                                 "` (when " + watch->predicate().text + ") at breakpoint " +
+                                 std::to_string(bp_id) + ", thread " +
+                                 std::to_string(thread.GetIndexID()) + " in " +
+                                 (fn ? fn : "??") + ": " + reason +
+                                 "\n  history: " + watch->History(kReportHistory));
+        stop = true;
+    }
+
+    // Keep running while values are normal; stop only to report a trip
+    return stop;
+}
+
+void WatchManager::EnsureStopHook(lldb::SBDebugger& debugger)
+{
+    lldb::SBTarget target = debugger.GetSelectedTarget();
+    if (stop_hook_id_ != 0 && stop_hook_target_ == target)
+        return;
+
+    lldb::SBCommandReturnObject result;
+    debugger.GetCommandInterpreter().HandleCommand(
+        "target stop-hook add --one-liner \"agent watch-tick\"", result);
+
+    // "Stop hook #<id> added."
+    stop_hook_id_ = 0;
+    if (result.Succeeded() && result.GetOutput())
+    {
+        std::string out = result.GetOutput();
+        size_t hash = out.find('#');
+        if (hash != std::string::npos)
+            stop_hook_id_ = std::atoi(out.c_str() + hash + 1);
+    }
+    stop_hook_target_ = target;
+}
+
+void WatchManager::RemoveStopHook(lldb::SBDebugger& debugger)
+{
+    if (stop_hook_id_ == 0)
+        return;
+    if (stop_hook_target_ == debugger.GetSelectedTarget())
+    {
+        lldb::SBCommandReturnObject result;
+        std::string command = "target stop-hook delete " + std::to_string(stop_hook_id_);
+        debugger.GetCommandInterpreter().HandleCommand(command.c_str(), result);
+    }
+    stop_hook_id_ = 0;
+    stop_hook_target_.Clear();
+}
+
+WatchManager& GetWatchManager()
+{
+    static WatchManager manager;
+    return manager;
+}
+
+} // namespace lldb_copilot
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <lldb/API/LLDB.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lldb_copilot
+{
+
+// When a watched value counts as anomalous. Predicates trip on transitions
+// (the condition becomes true), so a value that stays bad is reported once.
+//   anomaly (default)  becomes null, or jumps far beyond its usual step
+//   changed            differs from the previous sample
+//   null / nonnull     becomes zero / non-zero
+//   jump[>N]           |delta| > N (default: 10x the median recent step)
+//   <op> N             comparison, op one of > >= < <= == !=
+struct WatchPredicate
+{
+    enum class Kind
+    {
+        Anomaly,
+        Changed,
+        Null,
+        NonNull,
+        Jump,
+        Compare,
+    };
+
+    Kind kind = Kind::Anomaly;
+    std::string op;      // Comparison operator for Kind::Compare
+    double operand = 0;  // Comparison operand or explicit jump threshold
+    bool has_operand = false;
+    std::string text;    // As typed, for display
+
+    // Throws std::runtime_error on malformed input
+    static WatchPredicate Parse(const std::string& text);
+};
+
+struct WatchSample
+{
+    uint32_t stop_id = 0;
+    std::string value;
+    bool numeric = false;
+    double number = 0;
+};
+
+// One watched expression and its bounded sample history
+class Watch
+{
+  public:
+    static constexpr size_t kHistorySize = 256;
+
+    Watch(int id, std::string expr, WatchPredicate predicate);
+
+    // Record a sample; returns a trip description if the predicate tripped
+    std::string Record(const WatchSample& sample);
+
+    // Last n samples, oldest first, as "value@stop ..."
+    std::string History(size_t n) const;
+
+    int id() const { return id_; }
+    const std::string& expr() const { return expr_; }
+    const WatchPredicate& predicate() const { return predicate_; }
+    size_t samples() const { return count_; }
+    unsigned trips() const { return trips_; }
+
+    // Sampled only at this breakpoint, created by the watch: by name, or as
+    // a copy of the user's breakpoint at, which is left untouched
+    lldb::break_id_t breakpoint = LLDB_INVALID_BREAK_ID;
+    std::string at;
+
+  private:
+    const WatchSample& At(size_t age) const; // 0 = newest
+
+    int id_;
+    std::string expr_;
+    WatchPredicate predicate_;
+    std::vector<WatchSample> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    unsigned trips_ = 0;
+    bool active_ = false; // Predicate currently true (for transition detection)
+};
+
+// Value watches evaluated natively at every stop (through a stop-hook running
+// "agent watch-tick") or at a breakpoint (through an auto-continuing
+// breakpoint callback). The model is only involved when a predicate trips.
+class WatchManager
+{
+  public:
+    // Returns the new watch ID, or 0 with *error set. Without at, expr must
+    // evaluate in the selected frame if the process is stopped.
+    int Add(lldb::SBDebugger& debugger, const std::string& expr, const std::string& when,
+            const std::string& at, std::string* error);
+
+    bool Remove(lldb::SBDebugger& debugger, int id);
+    void Clear(lldb::SBDebugger& debugger);
+    std::string List();
+    bool Empty();
+
+    // Sample stop-driven watches at the current stop and collect trip reports,
+    // including trips recorded by breakpoint callbacks since the last stop
+    std::vector<std::string> OnStop(lldb::SBDebugger& debugger);
+
+  private:
+    static bool BreakpointHit(void* baton, lldb::SBProcess& process, lldb::SBThread& thread,
+                              lldb::SBBreakpointLocation& location);
+
+    void EnsureStopHook(lldb::SBDebugger& debugger);
+    void RemoveStopHook(lldb::SBDebugger& debugger);
+    void Detach(lldb::SBTarget target, Watch& watch);
+
+    std::mutex mutex_; // Breakpoint callbacks run on LLDB's private state thread
+    std::map<int, std::unique_ptr<Watch>> watches_;
+    std::vector<std::string> pending_;
+    int next_id_ = 1;
+    int stop_hook_id_ = 0;
+    lldb::SBTarget stop_hook_target_;
+};
+
+// Global watch manager
+WatchManager& GetWatchManager();
+
+} // namespace lldb_copilot